@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MM_HAS_TSC 1
+#else
+#define MM_HAS_TSC 0
+#endif
+
+namespace mm
+{
+
+    /**
+     * Source of engine time
+     */
+    enum class ClockMode : uint8_t
+    {
+        REPLAY = 0, // Advanced from feed message timestamps
+        LIVE = 1    // Read from the hardware timestamp counter
+    };
+
+    /**
+     * Engine-wide time source.
+     *
+     * In replay mode the feed handler advances the clock from message
+     * timestamps, so every book and position update of a replay is stamped
+     * deterministically. In live mode now() reads the TSC and scales it to
+     * nanoseconds with a ratio calibrated once per process.
+     */
+    class EngineClock
+    {
+    public:
+        explicit EngineClock(ClockMode mode = ClockMode::LIVE);
+        ~EngineClock() = default;
+
+        // Non-copyable, non-movable
+        EngineClock(const EngineClock &) = delete;
+        EngineClock &operator=(const EngineClock &) = delete;
+        EngineClock(EngineClock &&) = delete;
+        EngineClock &operator=(EngineClock &&) = delete;
+
+        /**
+         * Current engine time in nanoseconds
+         */
+        Timestamp now() const
+        {
+            if (mode_ == ClockMode::REPLAY)
+            {
+                return replay_now_.load(std::memory_order_relaxed);
+            }
+#if MM_HAS_TSC
+            return ns_base_ + static_cast<Timestamp>(static_cast<double>(__rdtsc() - tsc_base_) * ns_per_tick_);
+#else
+            return get_timestamp();
+#endif
+        }
+
+        /**
+         * Advance replay time to a feed timestamp; never moves backwards
+         */
+        void advance(Timestamp feed_time)
+        {
+            if (feed_time > replay_now_.load(std::memory_order_relaxed))
+            {
+                replay_now_.store(feed_time, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Reset replay time (e.g. at the start of a new day file)
+         */
+        void reset(Timestamp start = 0) { replay_now_.store(start, std::memory_order_relaxed); }
+
+        ClockMode mode() const { return mode_; }
+
+    private:
+        ClockMode mode_;
+        std::atomic<Timestamp> replay_now_;
+        uint64_t tsc_base_;
+        Timestamp ns_base_;
+        double ns_per_tick_;
+    };
+
+} // namespace mm
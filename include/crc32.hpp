@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace mm
+{
+
+    namespace detail
+    {
+        // Reflected CRC-32C (Castagnoli) table, matching the SSE4.2 instruction
+        constexpr std::array<uint32_t, 256> make_crc32c_table()
+        {
+            std::array<uint32_t, 256> table{};
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0u);
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        inline constexpr std::array<uint32_t, 256> crc32c_table = make_crc32c_table();
+    }
+
+    /**
+     * CRC-32C of a byte range, using the SSE4.2 instruction when available
+     */
+    inline uint32_t crc32c(const void *data, size_t length, uint32_t crc = 0)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        crc = ~crc;
+#if defined(__SSE4_2__)
+        for (; length >= 8; length -= 8, bytes += 8)
+        {
+            uint64_t word;
+            __builtin_memcpy(&word, bytes, 8);
+            crc = static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+        }
+        for (; length > 0; --length, ++bytes)
+        {
+            crc = _mm_crc32_u8(crc, *bytes);
+        }
+#else
+        for (; length > 0; --length, ++bytes)
+        {
+            crc = (crc >> 8) ^ detail::crc32c_table[(crc ^ *bytes) & 0xFF];
+        }
+#endif
+        return ~crc;
+    }
+
+} // namespace mm
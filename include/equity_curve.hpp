@@ -0,0 +1,115 @@
+#pragma once
+
+#include "types.hpp"
+#include "seqlock.hpp"
+#include <atomic>
+#include <memory>
+
+namespace mm
+{
+
+    /**
+     * Total P&L over one time bucket
+     */
+    struct EquityBucket
+    {
+        Timestamp start; // Bucket start, a multiple of the bucket width
+        PnL open;
+        PnL high;
+        PnL low;
+        PnL close;
+        PnL max_drawdown; // Deepest drawdown from the running peak inside the bucket
+        uint64_t samples;
+    };
+
+    /**
+     * Running high-water mark and drawdown
+     */
+    struct DrawdownStats
+    {
+        PnL equity;       // Last sampled total P&L
+        PnL peak;         // Highest sampled total P&L, starting from 0
+        PnL drawdown;     // peak - equity
+        PnL max_drawdown; // Largest drawdown seen
+        Timestamp peak_time;
+        Timestamp max_drawdown_time;
+        uint64_t samples;
+    };
+
+    /**
+     * Equity curve of total P&L in two preallocated rings of time buckets,
+     * per second and per minute, with peak and drawdown kept as it goes.
+     *
+     * sample() is O(1): it updates the drawdown and the newest bucket of each
+     * ring, opening a new bucket when time crosses a boundary. Seconds with
+     * no samples get no bucket, so a ring holds the most recent active
+     * buckets. One writer at a time (callers serialise sample() and reset());
+     * readers copy through seqlocks and never block it.
+     */
+    class EquityCurve
+    {
+    public:
+        struct Config
+        {
+            size_t second_buckets; // One hour by default
+            size_t minute_buckets; // One day by default
+
+            Config() : second_buckets(3600), minute_buckets(1440) {}
+        };
+
+        explicit EquityCurve(const Config &config = Config());
+
+        // Non-copyable, non-movable
+        EquityCurve(const EquityCurve &) = delete;
+        EquityCurve &operator=(const EquityCurve &) = delete;
+        EquityCurve(EquityCurve &&) = delete;
+        EquityCurve &operator=(EquityCurve &&) = delete;
+
+        /**
+         * Add one sample of total P&L; now must not go backwards
+         */
+        void sample(PnL equity, Timestamp now);
+
+        DrawdownStats get_drawdown() const { return drawdown_.load(); }
+
+        /**
+         * Highest sampled P&L; a single atomic load for risk checks
+         */
+        PnL peak() const { return peak_.load(std::memory_order_relaxed); }
+
+        /**
+         * Copy up to max of the newest buckets into out, oldest first;
+         * returns the number copied
+         */
+        size_t copy_seconds(EquityBucket *out, size_t max) const { return seconds_.copy_to(out, max); }
+        size_t copy_minutes(EquityBucket *out, size_t max) const { return minutes_.copy_to(out, max); }
+
+        /**
+         * Forget every sample and start again from a peak of 0
+         */
+        void reset();
+
+    private:
+        class Ring
+        {
+        public:
+            Ring(size_t capacity, Timestamp width);
+
+            void sample(PnL equity, PnL drawdown, Timestamp now);
+            size_t copy_to(EquityBucket *out, size_t max) const;
+            void reset();
+
+        private:
+            std::unique_ptr<Seqlock<EquityBucket>[]> buckets_;
+            size_t capacity_;
+            Timestamp width_;
+            std::atomic<uint64_t> opened_; // Buckets ever opened; the newest is (opened_ - 1) % capacity_
+        };
+
+        Ring seconds_;
+        Ring minutes_;
+        Seqlock<DrawdownStats> drawdown_;
+        std::atomic<PnL> peak_;
+    };
+
+} // namespace mm
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "types.hpp"
+#include "order_book.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace mm
+{
+
+    /**
+     * One fill of a simulated order
+     */
+    struct SimulatedFill
+    {
+        OrderId order_id;
+        SymbolId symbol;
+        OrderSide side;
+        Price price;
+        Quantity quantity;
+        Timestamp timestamp;
+    };
+
+    /**
+     * Fills our orders in a backtest by their place in the market's queue.
+     *
+     * The market feed is applied through the simulator to an order book
+     * that holds only market orders; our orders are kept beside it. Each of
+     * ours remembers the market volume ahead of it at its price, taken from
+     * the book when it joined the level. From then on, at its price and side:
+     *
+     *   - executions and cancels of orders that were there first reduce it;
+     *   - an execution of an order that arrived after ours, or at a worse
+     *     price, means the aggressor reached us, so we fill;
+     *   - an incoming order on the other side that crosses our price fills
+     *     us as it would have traded against us, best price first and up
+     *     to its quantity.
+     *
+     * Priority is by feed timestamp; a market order stamped the same instant
+     * we joined counts as ahead, so fills are never early. Each feed event
+     * costs one order lookup and a pass over our orders in its symbol, and
+     * nothing for symbols we do not quote.
+     */
+    class QueueFillSimulator
+    {
+    public:
+        explicit QueueFillSimulator(OrderBookManager &market);
+        ~QueueFillSimulator() = default;
+
+        // Non-copyable, non-movable
+        QueueFillSimulator(const QueueFillSimulator &) = delete;
+        QueueFillSimulator &operator=(const QueueFillSimulator &) = delete;
+        QueueFillSimulator(QueueFillSimulator &&) = delete;
+        QueueFillSimulator &operator=(QueueFillSimulator &&) = delete;
+
+        /**
+         * Our orders; same contract as OrderBookManager. quantity is the
+         * order's total including any part already filled.
+         */
+        bool add_order(SymbolId symbol, OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now);
+        bool cancel_order(SymbolId symbol, OrderId order_id, Timestamp now);
+
+        /**
+         * Keeps the order's place for a size cut at the same price; any other
+         * change goes to the back of the new level. False if the order is no
+         * longer working.
+         */
+        bool modify_order(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity, Timestamp now);
+
+        /**
+         * Apply market feed updates to the market book, filling our orders
+         * as the queue ahead of them clears. Returns the number applied cleanly.
+         */
+        size_t apply(const BookUpdate *updates, size_t count);
+
+        /**
+         * Fills since the last clear_fills(), in feed order. A fully filled
+         * order stops working.
+         */
+        const std::vector<SimulatedFill> &get_fills() const { return fills_; }
+        void clear_fills() { fills_.clear(); }
+
+        /**
+         * Market volume still ahead of one of our orders; 0 if unknown
+         */
+        Quantity get_queue_ahead(OrderId order_id) const;
+
+        OrderBookManager &get_market() { return market_; }
+
+        struct Stats
+        {
+            uint64_t feed_events;
+            uint64_t tracked_events; // Feed events in a symbol we had orders in
+            uint64_t fills;
+            uint64_t filled_quantity;
+            size_t working_orders;
+        };
+
+        const Stats &get_stats() const { return stats_; }
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct SimOrder
+        {
+            OrderId order_id;
+            Price price;
+            Quantity quantity;
+            Quantity filled;
+            Quantity ahead; // Market volume in front of us at price
+            Timestamp joined;
+            SymbolId symbol;
+            OrderSide side;
+            uint32_t prev; // Our other orders in the same symbol
+            uint32_t next;
+
+            Quantity remaining() const { return quantity - filled; }
+        };
+
+        OrderBookManager &market_;
+        std::vector<SimOrder> orders_;
+        std::vector<uint32_t> free_;
+        std::unordered_map<OrderId, uint32_t> index_;
+        std::unique_ptr<uint32_t[]> first_order_; // By SymbolId
+        std::vector<SimulatedFill> fills_;
+        std::vector<uint32_t> crossing_; // Scratch for crossing adds
+        Stats stats_;
+
+        void join_queue(SimOrder &order, Timestamp now);
+        void fill(uint32_t index, Quantity quantity, Timestamp now);
+        void remove(uint32_t index);
+        void on_market_event(const BookUpdate &update);
+    };
+
+} // namespace mm
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace mm
+{
+
+    /**
+     * One fill as written to the write-ahead journal
+     */
+    struct FillRecord
+    {
+        uint64_t sequence; // Starts at 1, continues across restarts
+        Timestamp timestamp;
+        OrderId order_id;
+        Price price;
+        Quantity quantity;
+        SymbolId symbol;
+        OrderSide side;
+        uint8_t reserved;
+        uint32_t crc; // CRC-32C of the bytes before this field
+        uint32_t padding;
+    };
+
+    static_assert(sizeof(FillRecord) == 48, "Fill records are written as fixed 48-byte blocks");
+
+    /**
+     * Write-ahead journal of fills with group commit.
+     *
+     * append() reserves a sequence number and copies the record into a
+     * bounded ring; a dedicated writer thread drains the ring, writes each
+     * batch with one write() and makes it durable with one fdatasync(). With
+     * a commit window the writer waits that long after the first record of a
+     * batch, trading latency to durability for fewer syncs. On open, a torn
+     * or corrupt tail left by a crash is detected by CRC and truncated.
+     */
+    class FillWal
+    {
+    public:
+        struct Config
+        {
+            size_t ring_capacity;                          // Power of two
+            size_t max_batch_records;                      // Records per write/fdatasync
+            std::chrono::microseconds group_commit_window; // 0 = sync as soon as records arrive
+
+            Config() : ring_capacity(1 << 16), max_batch_records(4096), group_commit_window(200) {}
+        };
+
+        explicit FillWal(const std::string &path, const Config &config = Config());
+        ~FillWal();
+
+        // Non-copyable, non-movable
+        FillWal(const FillWal &) = delete;
+        FillWal &operator=(const FillWal &) = delete;
+        FillWal(FillWal &&) = delete;
+        FillWal &operator=(FillWal &&) = delete;
+
+        /**
+         * Queue a fill and return its sequence number. Safe from any thread;
+         * spins only if the ring is full.
+         */
+        uint64_t append(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id, Timestamp now)
+        {
+            uint64_t position = head_.fetch_add(1, std::memory_order_relaxed);
+            Cell &cell = ring_[position & mask_];
+            while (cell.turn.load(std::memory_order_acquire) != position)
+            {
+                std::this_thread::yield(); // Writer is behind by a full ring
+            }
+
+            FillRecord &record = cell.record;
+            record.sequence = base_sequence_ + position;
+            record.timestamp = now;
+            record.order_id = order_id;
+            record.price = price;
+            record.quantity = quantity;
+            record.symbol = symbol;
+            record.side = side;
+            record.reserved = 0;
+            record.padding = 0;
+            cell.turn.store(position + 1, std::memory_order_release);
+            return record.sequence;
+        }
+
+        /**
+         * Highest sequence number known to be on disk (0 = none)
+         */
+        uint64_t durable_sequence() const { return durable_.load(std::memory_order_acquire); }
+
+        /**
+         * Block until sequence is on disk
+         */
+        void wait_durable(uint64_t sequence) const;
+
+        /**
+         * Sequence number of the last record recovered when the file was opened
+         */
+        uint64_t recovered_sequence() const { return base_sequence_ - 1; }
+
+        /**
+         * Feed every valid record in the file to fn, oldest first; returns the count
+         */
+        size_t replay(const std::function<void(const FillRecord &)> &fn) const;
+
+        struct Stats
+        {
+            uint64_t records;
+            uint64_t batches; // One write + fdatasync each
+            uint64_t bytes;
+            uint64_t sync_time_ns;
+            uint64_t truncated_bytes; // Torn tail dropped on open
+        };
+
+        Stats get_stats() const;
+
+        /**
+         * CRC a record the way the writer does before it goes to disk
+         */
+        static uint32_t checksum(const FillRecord &record);
+
+    private:
+        struct alignas(CACHE_LINE_SIZE) Cell
+        {
+            std::atomic<uint64_t> turn; // == position when free, position + 1 when filled
+            FillRecord record;
+        };
+
+        std::string path_;
+        Config config_;
+        int fd_;
+        uint64_t base_sequence_;
+        size_t mask_;
+        std::unique_ptr<Cell[]> ring_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_; // Producers
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> durable_;
+        std::atomic<bool> stop_;
+
+        std::atomic<uint64_t> records_;
+        std::atomic<uint64_t> batches_;
+        std::atomic<uint64_t> sync_time_ns_;
+        uint64_t truncated_bytes_;
+
+        std::thread writer_;
+
+        /**
+         * Scan the file, drop any invalid tail and return the last good sequence
+         */
+        uint64_t recover_tail();
+
+        void writer_loop();
+    };
+
+} // namespace mm
@@ -3,9 +3,12 @@
 #include "types.hpp"
 #include "order_book.hpp"
 #include "position_tracker.hpp"
+#include "clock.hpp"
 #include <fstream>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <array>
 
 namespace mm
 {
@@ -40,12 +43,14 @@ namespace mm
     };
 
     /**
-     * ITCH message base class
+     * ITCH message base class (common ITCH 5.0 header)
      */
     struct ITCHMessage
     {
         ITCHMessageType type;
         uint16_t length;
+        uint16_t stock_locate;
+        uint16_t tracking_number;
         uint64_t timestamp;
 
         virtual ~ITCHMessage() = default;
@@ -59,7 +64,7 @@ namespace mm
         uint64_t order_reference_number;
         uint8_t buy_sell_indicator;
         uint32_t shares;
-        uint8_t stock_locate;
+        char stock[8];
         uint32_t price;
         uint8_t mpid[4];
         bool has_mpid;
@@ -111,7 +116,7 @@ namespace mm
         uint64_t order_reference_number;
         uint8_t buy_sell_indicator;
         uint32_t shares;
-        uint8_t stock_locate;
+        char stock[8];
         uint32_t price;
         uint64_t match_number;
     };
@@ -121,9 +126,6 @@ namespace mm
      */
     struct StockDirectoryMessage : public ITCHMessage
     {
-        uint8_t stock_locate;
-        uint8_t tracking_number;
-        uint8_t timestamp[6];
         char stock[8];
         char market_category;
         char financial_status_indicator;
@@ -146,7 +148,7 @@ namespace mm
     class ITCHParser
     {
     public:
-        explicit ITCHParser(OrderBookManager &order_books, PositionTracker &position_tracker);
+        explicit ITCHParser(OrderBookManager &order_books, PositionTracker &position_tracker, EngineClock &clock);
         ~ITCHParser() = default;
 
         // Non-copyable, non-movable
@@ -161,10 +163,15 @@ namespace mm
         bool parse_file(const std::string &filename);
 
         /**
-         * Process a single ITCH message
+         * Process a single length-prefixed ITCH message; length covers the prefix
          */
         bool process_message(const uint8_t *data, size_t length);
 
+        /**
+         * Apply book updates still queued by process_message
+         */
+        void flush();
+
         /**
          * Get parsing statistics
          */
@@ -188,17 +195,50 @@ namespace mm
          */
         void reset_stats() { stats_ = Stats{}; }
 
+        /**
+         * Stop parse_file once the order books reserve more than this many bytes (0 = no cap)
+         */
+        void set_memory_cap(size_t bytes) { memory_cap_bytes_ = bytes; }
+
+        /**
+         * Whether the last parse_file stopped on the memory cap
+         */
+        bool memory_cap_exceeded() const { return memory_cap_exceeded_; }
+
+        /**
+         * Hand each flushed batch of decoded book updates to sink instead of
+         * applying them to the order books; an empty sink (the default)
+         * applies them. The memory cap still checks the order books, so a
+         * sink that applies the updates itself keeps the cap meaningful.
+         */
+        using UpdateSink = std::function<void(const BookUpdate *, size_t)>;
+        void set_update_sink(UpdateSink sink) { update_sink_ = std::move(sink); }
+
     private:
         OrderBookManager &order_books_;
         PositionTracker &position_tracker_;
+        EngineClock &clock_;
         Stats stats_;
 
         // Symbol mapping (stock_locate -> symbol_id)
-        std::map<uint8_t, SymbolId> symbol_mapping_;
+        std::map<uint16_t, SymbolId> symbol_mapping_;
         SymbolId next_symbol_id_;
 
+        // Header of the message currently being processed
+        ITCHMessage header_;
+
+        // Book updates are applied in prefetching batches
+        std::array<BookUpdate, APPLY_BATCH_SIZE> pending_;
+        size_t pending_count_;
+
+        size_t memory_cap_bytes_;
+        bool memory_cap_exceeded_;
+        UpdateSink update_sink_;
+
+        void enqueue(const BookUpdate &update);
+
         /**
-         * Parse specific message types
+         * Parse specific message types; data points at the message type byte
          */
         bool parse_add_order(const uint8_t *data, size_t length);
         bool parse_order_executed(const uint8_t *data, size_t length);
@@ -211,7 +251,7 @@ namespace mm
         /**
          * Get or create symbol mapping
          */
-        SymbolId get_symbol_id(uint8_t stock_locate);
+        SymbolId get_symbol_id(uint16_t stock_locate);
 
         /**
          * Convert ITCH price to internal price format
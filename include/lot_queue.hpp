@@ -0,0 +1,253 @@
+#pragma once
+
+#include "types.hpp"
+#include "memory_pool.hpp"
+#include "seqlock.hpp"
+#include <algorithm>
+
+namespace mm
+{
+
+    /**
+     * Which open lots a closing fill consumes first
+     */
+    enum class LotMethod : uint8_t
+    {
+        FIFO = 0,
+        LIFO = 1
+    };
+
+    /**
+     * Quantity still open from one opening fill
+     */
+    struct Lot
+    {
+        Price price;
+        Quantity quantity;
+        OrderId order_id;
+        Timestamp timestamp;
+    };
+
+    // Lots per pooled segment; a queue is a chain of segments
+    constexpr size_t LOTS_PER_SEGMENT = 16;
+
+    struct LotSegment
+    {
+        Lot lots[LOTS_PER_SEGMENT];
+        LotSegment *prev;
+        LotSegment *next;
+        uint32_t begin; // Live lots are [begin, end)
+        uint32_t end;
+    };
+
+    /**
+     * Segment allocator shared by every symbol's lot queue. Segments come
+     * from a MemoryPool and are recycled through an intrusive free list, so
+     * the lock is taken at most once per LOTS_PER_SEGMENT lots and the heap
+     * is only touched when the pool grows.
+     */
+    class LotSegmentPool
+    {
+    public:
+        explicit LotSegmentPool(size_t initial_segments = 1024)
+            : pool_(initial_segments), free_(nullptr), in_use_(0) {}
+
+        // Non-copyable, non-movable
+        LotSegmentPool(const LotSegmentPool &) = delete;
+        LotSegmentPool &operator=(const LotSegmentPool &) = delete;
+        LotSegmentPool(LotSegmentPool &&) = delete;
+        LotSegmentPool &operator=(LotSegmentPool &&) = delete;
+
+        LotSegment *acquire()
+        {
+            LotSegment *segment;
+            {
+                std::lock_guard<SpinLock> lock(lock_);
+                segment = free_;
+                if (segment)
+                {
+                    free_ = segment->next;
+                }
+                ++in_use_;
+            }
+            if (!segment)
+            {
+                segment = pool_.allocate();
+            }
+            segment->prev = nullptr;
+            segment->next = nullptr;
+            segment->begin = 0;
+            segment->end = 0;
+            return segment;
+        }
+
+        void release(LotSegment *segment)
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            segment->next = free_;
+            free_ = segment;
+            --in_use_;
+        }
+
+        size_t in_use() const
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            return in_use_;
+        }
+
+        size_t capacity() const { return pool_.capacity(); }
+
+    private:
+        MemoryPool<LotSegment> pool_;
+        mutable SpinLock lock_;
+        LotSegment *free_;
+        size_t in_use_;
+    };
+
+    /**
+     * Open lots for one symbol, all on the same side. An opening fill appends
+     * a lot; a closing fill consumes lots from the front (FIFO) or the back
+     * (LIFO) and realizes P&L lot by lot, so each fill is O(1) amortized. An
+     * emptied queue keeps its last segment for the next opening fill. Not
+     * synchronised: the owning slot's write lock guards it.
+     */
+    class LotQueue
+    {
+    public:
+        LotQueue() : head_(nullptr), tail_(nullptr), quantity_(0), cost_(0), lot_count_(0), side_(OrderSide::BUY) {}
+
+        /**
+         * Close opposite-side lots with a fill, open a lot with whatever is
+         * left, and return the realized P&L of the closed quantity
+         */
+        PnL fill(LotSegmentPool &pool, LotMethod method, Price price, Quantity quantity, OrderSide side,
+                 OrderId order_id, Timestamp now)
+        {
+            PnL realized = 0;
+            while (quantity > 0 && quantity_ > 0 && side != side_)
+            {
+                Lot &lot = method == LotMethod::FIFO ? front() : back();
+                Quantity matched = std::min(quantity, lot.quantity);
+                realized += (side_ == OrderSide::BUY ? price - lot.price : lot.price - price) * matched;
+                cost_ -= lot.price * matched;
+                lot.quantity -= matched;
+                quantity_ -= matched;
+                quantity -= matched;
+                if (lot.quantity == 0)
+                {
+                    method == LotMethod::FIFO ? pop_front(pool) : pop_back(pool);
+                }
+            }
+
+            if (quantity > 0)
+            {
+                side_ = side;
+                push_back(pool, Lot{price, quantity, order_id, now});
+                quantity_ += quantity;
+                cost_ += price * quantity;
+            }
+            return realized;
+        }
+
+        Quantity quantity() const { return quantity_; }
+        OrderSide side() const { return side_; }
+        size_t lot_count() const { return lot_count_; }
+
+        /**
+         * Quantity-weighted cost of the open lots (0 when flat)
+         */
+        Price average_price() const { return quantity_ ? cost_ / static_cast<PnL>(quantity_) : 0; }
+
+        /**
+         * Copy up to max open lots, oldest first; returns the number copied
+         */
+        size_t copy_to(Lot *out, size_t max) const
+        {
+            size_t copied = 0;
+            for (const LotSegment *segment = head_; segment && copied < max; segment = segment->next)
+            {
+                for (uint32_t i = segment->begin; i < segment->end && copied < max; ++i)
+                {
+                    out[copied++] = segment->lots[i];
+                }
+            }
+            return copied;
+        }
+
+        /**
+         * Return every segment to the pool
+         */
+        void clear(LotSegmentPool &pool)
+        {
+            while (head_)
+            {
+                LotSegment *next = head_->next;
+                pool.release(head_);
+                head_ = next;
+            }
+            tail_ = nullptr;
+            quantity_ = 0;
+            cost_ = 0;
+            lot_count_ = 0;
+        }
+
+    private:
+        LotSegment *head_;
+        LotSegment *tail_;
+        Quantity quantity_;
+        PnL cost_; // Sum of price * open quantity
+        size_t lot_count_;
+        OrderSide side_;
+
+        Lot &front() { return head_->lots[head_->begin]; }
+        Lot &back() { return tail_->lots[tail_->end - 1]; }
+
+        void push_back(LotSegmentPool &pool, const Lot &lot)
+        {
+            if (!tail_ || tail_->end == LOTS_PER_SEGMENT)
+            {
+                LotSegment *segment = pool.acquire();
+                segment->prev = tail_;
+                (tail_ ? tail_->next : head_) = segment;
+                tail_ = segment;
+            }
+            tail_->lots[tail_->end++] = lot;
+            ++lot_count_;
+        }
+
+        void pop_front(LotSegmentPool &pool)
+        {
+            ++head_->begin;
+            --lot_count_;
+            if (head_->begin == head_->end)
+            {
+                drop_empty(pool, head_);
+            }
+        }
+
+        void pop_back(LotSegmentPool &pool)
+        {
+            --tail_->end;
+            --lot_count_;
+            if (tail_->begin == tail_->end)
+            {
+                drop_empty(pool, tail_);
+            }
+        }
+
+        // Unlink an empty segment, or rewind it if it is the only one
+        void drop_empty(LotSegmentPool &pool, LotSegment *segment)
+        {
+            if (head_ == tail_)
+            {
+                segment->begin = 0;
+                segment->end = 0;
+                return;
+            }
+            (segment->prev ? segment->prev->next : head_) = segment->next;
+            (segment->next ? segment->next->prev : tail_) = segment->prev;
+            pool.release(segment);
+        }
+    };
+
+} // namespace mm
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace mm
+{
+
+    /**
+     * Inputs for one mark-to-market pass, all indexed by SymbolId
+     */
+    struct MarkToMarketInput
+    {
+        const int64_t *long_quantity;
+        const int64_t *short_quantity;
+        const Price *avg_long_price;
+        const Price *avg_short_price;
+        const PnL *unrealized_pnl; // Current values, for change detection
+        const Price *best_bid;     // 0 = no quote
+        const Price *best_ask;
+    };
+
+    /**
+     * Mark count positions to their BBO mid in one pass over the arrays.
+     * Lanes with a two-sided quote get marks[i] = mid and pnl[i] = unrealized
+     * P&L at that mid; other lanes keep pnl[i] = unrealized_pnl[i]. Bit i of
+     * changed ((count + 63) / 64 words) is set where pnl[i] differs from the
+     * current value. Uses AVX2 when the build targets it.
+     */
+    void mark_to_market_kernel(const MarkToMarketInput &input, size_t count, Price *marks, PnL *pnl, uint64_t *changed);
+
+} // namespace mm
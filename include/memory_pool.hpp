@@ -15,7 +15,7 @@ namespace mm
     {
     public:
         explicit MemoryPool(size_t initial_capacity = 1000)
-            : capacity_(initial_capacity), allocated_count_(0), peak_usage_(0)
+            : capacity_(0), allocated_count_(0), peak_usage_(0), current_chunk_(0), chunk_used_(0)
         {
             allocate_chunk(initial_capacity);
         }
@@ -39,13 +39,19 @@ namespace mm
                 return ptr;
             }
 
-            if (allocated_count_ >= capacity_)
+            if (chunk_used_ >= chunk_sizes_[current_chunk_])
             {
-                size_t new_capacity = capacity_ * 2;
-                allocate_chunk(new_capacity);
+                // Reuse chunks kept across reset() before growing; each new chunk doubles capacity
+                if (current_chunk_ + 1 == chunks_.size())
+                {
+                    allocate_chunk(capacity_);
+                }
+                ++current_chunk_;
+                chunk_used_ = 0;
             }
 
-            T *ptr = &chunks_.back()[allocated_count_++];
+            T *ptr = &chunks_[current_chunk_][chunk_used_++];
+            ++allocated_count_;
             peak_usage_ = std::max(peak_usage_, allocated_count_);
             return ptr;
         }
@@ -77,6 +83,8 @@ namespace mm
                 free_list_.pop();
             }
             allocated_count_ = 0;
+            current_chunk_ = 0;
+            chunk_used_ = 0;
         }
 
         size_t capacity() const
@@ -94,15 +102,19 @@ namespace mm
         void allocate_chunk(size_t size)
         {
             chunks_.emplace_back(std::make_unique<T[]>(size));
+            chunk_sizes_.push_back(size);
             capacity_ += size;
         }
 
         std::vector<std::unique_ptr<T[]>> chunks_;
+        std::vector<size_t> chunk_sizes_;
         std::stack<T *> free_list_;
         mutable std::mutex mutex_;
         size_t capacity_;
         size_t allocated_count_;
         size_t peak_usage_;
+        size_t current_chunk_;
+        size_t chunk_used_;
     };
 
     template <typename T>
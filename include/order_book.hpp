@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 #include "memory_pool.hpp"
+#include "order_table.hpp"
 #include <vector>
 #include <map>
 #include <memory>
@@ -17,34 +18,74 @@ namespace mm
         Quantity total_quantity;
         uint32_t order_count;
         Timestamp last_update;
+        Order *head; // Resting orders in time priority, oldest first
+        Order *tail;
 
-        PriceLevel() : price(0), total_quantity(0), order_count(0), last_update(0) {}
-        PriceLevel(Price p, Quantity q) : price(p), total_quantity(q), order_count(1), last_update(get_timestamp()) {}
+        PriceLevel() : price(0), total_quantity(0), order_count(0), last_update(0), head(nullptr), tail(nullptr) {}
+        PriceLevel(Price p, Quantity q, Timestamp ts) : price(p), total_quantity(q), order_count(1), last_update(ts), head(nullptr), tail(nullptr) {}
     };
 
+    // Wide fields first so the queue links still fit in one cache line
     struct alignas(ALIGNMENT) Order
     {
         OrderId id;
-        SymbolId symbol;
         Price price;
+        Timestamp timestamp;
+        PriceLevel *level;
+        Order *prev; // Neighbours in level's queue
+        Order *next;
         Quantity quantity;
         Quantity filled_quantity;
+        SymbolId symbol;
         OrderSide side;
         OrderType type;
         OrderStatus status;
+
+        Order() : id(0), price(0), timestamp(0), level(nullptr), prev(nullptr), next(nullptr), quantity(0), filled_quantity(0),
+                  symbol(0), side(OrderSide::BUY), type(OrderType::LIMIT), status(OrderStatus::PENDING) {}
+    };
+
+    static_assert(sizeof(Order) == CACHE_LINE_SIZE, "Orders must fit one cache line");
+
+    // Number of feed updates resolved together by the prefetching apply path
+    constexpr size_t APPLY_BATCH_SIZE = 16;
+
+    enum class BookUpdateType : uint8_t
+    {
+        ADD = 0,
+        EXECUTE = 1,
+        CANCEL = 2,
+        DELETE = 3,
+        REPLACE = 4
+    };
+
+    // Decoded feed event against a resting order
+    struct BookUpdate
+    {
+        BookUpdateType type;
+        OrderSide side;
+        SymbolId symbol;
+        Quantity quantity;
+        OrderId order_id;
+        OrderId new_order_id; // REPLACE only
+        Price price;          // ADD and REPLACE
         Timestamp timestamp;
-        PriceLevel *level;
+    };
+
+    // Best bid and ask prices of one symbol (0 = empty side)
+    struct BestBidOffer
+    {
+        Price bid;
+        Price ask;
 
-        Order() : id(0), symbol(0), price(0), quantity(0), filled_quantity(0),
-                  side(OrderSide::BUY), type(OrderType::LIMIT), status(OrderStatus::PENDING),
-                  timestamp(0), level(nullptr) {}
+        bool operator==(const BestBidOffer &) const = default;
     };
 
     // Supports microsecond quote updates with no heap allocations
     class OrderBook
     {
     public:
-        explicit OrderBook(SymbolId symbol);
+        explicit OrderBook(SymbolId symbol, size_t order_capacity = 10000, size_t level_capacity = 1000);
         ~OrderBook() = default;
 
         OrderBook(const OrderBook &) = delete;
@@ -52,12 +93,26 @@ namespace mm
         OrderBook(OrderBook &&) = delete;
         OrderBook &operator=(OrderBook &&) = delete;
 
-        bool add_order(OrderId order_id, Price price, Quantity quantity, OrderSide side, OrderType type = OrderType::LIMIT);
-        bool cancel_order(OrderId order_id, Quantity quantity = 0);
-        bool modify_order(OrderId order_id, Price new_price, Quantity new_quantity);
-        bool execute_trade(Price price, Quantity quantity, OrderSide side);
+        // Mutators take the engine time explicitly (see EngineClock)
+        bool add_order(OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now, OrderType type = OrderType::LIMIT);
+        bool cancel_order(OrderId order_id, Timestamp now, Quantity quantity = 0);
+        bool modify_order(OrderId order_id, Price new_price, Quantity new_quantity, Timestamp now);
+        bool execute_trade(Price price, Quantity quantity, OrderSide side, Timestamp now);
+        bool apply(const BookUpdate &update);
+
+        // Publish best bid/ask prices (0 = empty side) into these slots after
+        // every mutation; used by OrderBookManager's dense BBO arrays
+        void publish_bbo_to(std::atomic<Price> *best_bid, std::atomic<Price> *best_ask);
+
+        // Prefetch stages of the batched apply path; the caller holds the book's
+        // lock, since they read the order table and the orders it points to
+        void prefetch_order_slot(OrderId order_id) const { orders_.prefetch(order_id); }
+        const Order *prefetch_order(OrderId order_id) const;
+        static void prefetch_level(const Order *order);
+
         std::pair<Price, Quantity> get_best_bid() const;
         std::pair<Price, Quantity> get_best_ask() const;
+        Quantity get_level_quantity(Price price, OrderSide side) const; // 0 if no level at price
         Price get_mid_price() const;
         Price get_spread() const;
         std::vector<std::pair<Price, Quantity>> get_bids(size_t depth = MAX_ORDER_BOOK_DEPTH) const;
@@ -67,6 +122,7 @@ namespace mm
         bool empty() const { return bids_.empty() && asks_.empty(); }
         size_t order_count() const { return orders_.size(); }
         size_t level_count() const { return bids_.size() + asks_.size(); }
+        size_t memory_usage() const;
         struct Stats
         {
             size_t total_orders;
@@ -86,16 +142,27 @@ namespace mm
 
         std::map<Price, PriceLevel *, std::greater<Price>> bids_; // Descending for bids
         std::map<Price, PriceLevel *, std::less<Price>> asks_; // Ascending for asks
-        std::map<OrderId, Order *> orders_;
+        OrderTable orders_;
         MemoryPool<Order> order_pool_;
         MemoryPool<PriceLevel> level_pool_;
         mutable std::mutex mutex_;
+        std::atomic<Price> *bbo_bid_ = nullptr;
+        std::atomic<Price> *bbo_ask_ = nullptr;
 
-        PriceLevel *get_or_create_level(Price price, OrderSide side);
+        PriceLevel *get_or_create_level(Price price, OrderSide side, Timestamp now);
         void remove_empty_level(Price price, OrderSide side);
-        void update_level_stats(PriceLevel *level, Quantity delta, bool add_order);
+        void update_level_stats(PriceLevel *level, Quantity delta, bool add_order, Timestamp now);
+        void link_order(PriceLevel *level, Order *order);
+        void unlink_order(Order *order);
         Order *find_order(OrderId order_id);
-        void remove_order_from_level(Order *order);
+        bool add_order_internal(OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now, OrderType type);
+        bool reduce_order_internal(Order *order, Quantity quantity, Timestamp now);
+        bool apply_internal(const BookUpdate &update);
+        void publish_bbo();
+        void fill_level(PriceLevel *level, Quantity quantity, Timestamp now);
+
+        // apply_batch() locks books and applies updates through the internals
+        friend class OrderBookManager;
 
         // Non-locking versions for internal use
         std::pair<Price, Quantity> get_best_bid_internal() const;
@@ -107,7 +174,8 @@ namespace mm
     class OrderBookManager
     {
     public:
-        OrderBookManager();
+        // Pools of new books start at these capacities and grow on demand
+        explicit OrderBookManager(size_t orders_per_book = 10000, size_t levels_per_book = 1000);
         ~OrderBookManager() = default;
 
         OrderBookManager(const OrderBookManager &) = delete;
@@ -116,17 +184,53 @@ namespace mm
         OrderBookManager &operator=(OrderBookManager &&) = delete;
 
         OrderBook *get_order_book(SymbolId symbol);
-        bool add_order(SymbolId symbol, OrderId order_id, Price price, Quantity quantity, OrderSide side, OrderType type = OrderType::LIMIT);
-        bool cancel_order(SymbolId symbol, OrderId order_id, Quantity quantity = 0);
-        bool modify_order(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity);
-        bool execute_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side);
+        bool add_order(SymbolId symbol, OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now, OrderType type = OrderType::LIMIT);
+        bool cancel_order(SymbolId symbol, OrderId order_id, Timestamp now, Quantity quantity = 0);
+        bool modify_order(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity, Timestamp now);
+        bool execute_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, Timestamp now);
+
+        // Applies feed updates one at a time
+        size_t apply(const BookUpdate *updates, size_t count);
+
+        // Applies feed updates in groups of APPLY_BATCH_SIZE, prefetching order slots,
+        // then orders, then levels for the whole group before mutating any book.
+        // Each book in a group is locked once for all of it. prefetch = false
+        // runs the same path without the prefetch stages, as a baseline.
+        // Returns the number of updates that applied cleanly.
+        size_t apply_batch(const BookUpdate *updates, size_t count, bool prefetch = true);
+
         const OrderBook *get_order_book(SymbolId symbol) const;
         std::vector<SymbolId> get_active_symbols() const;
+
+        // Best bid and ask price per SymbolId (0 = no quote), kept current by
+        // the books; MAX_SYMBOLS entries each, for mark-to-market passes.
+        // Read them with relaxed loads; a bid and ask may come from
+        // different moments of a book that is being updated.
+        const std::atomic<Price> *best_bids() const { return best_bids_.get(); }
+        const std::atomic<Price> *best_asks() const { return best_asks_.get(); }
+        // No quote for a symbol past the dense arrays, which never gets one
+        BestBidOffer get_bbo(SymbolId symbol) const
+        {
+            if (symbol >= MAX_SYMBOLS)
+            {
+                return BestBidOffer{0, 0};
+            }
+            return BestBidOffer{best_bids_[symbol].load(std::memory_order_relaxed), best_asks_[symbol].load(std::memory_order_relaxed)};
+        }
         size_t order_book_count() const { return order_books_.size(); }
 
+        // Bytes reserved by all books' pools and order indexes
+        size_t memory_usage() const;
+
     private:
         std::map<SymbolId, std::unique_ptr<OrderBook>> order_books_;
+        std::unique_ptr<std::atomic<Price>[]> best_bids_; // Written by book threads under each book's lock
+        std::unique_ptr<std::atomic<Price>[]> best_asks_;
         mutable std::mutex mutex_;
+        size_t orders_per_book_;
+        size_t levels_per_book_;
+
+        OrderBook *get_order_book_internal(SymbolId symbol);
     };
 
 } // namespace mm
\ No newline at end of file
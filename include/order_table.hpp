@@ -0,0 +1,158 @@
+#pragma once
+
+#include "types.hpp"
+#include <vector>
+#include <utility>
+
+namespace mm
+{
+
+    struct Order;
+
+    // Flat OrderId -> Order* map so lookups can be prefetched by slot
+    class OrderTable
+    {
+    public:
+        explicit OrderTable(size_t initial_capacity = 1024)
+            : size_(0)
+        {
+            size_t capacity = 16;
+            while (capacity < initial_capacity)
+            {
+                capacity <<= 1;
+            }
+            rehash(capacity);
+        }
+
+        OrderTable(const OrderTable &) = delete;
+        OrderTable &operator=(const OrderTable &) = delete;
+
+        // Fibonacci hashing: the top bits of the product pick the home slot
+        size_t slot_of(OrderId order_id) const
+        {
+            return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ull) >> shift_);
+        }
+
+        void prefetch(OrderId order_id) const
+        {
+            __builtin_prefetch(&slots_[slot_of(order_id)]);
+        }
+
+        Order *find(OrderId order_id) const
+        {
+            for (size_t i = slot_of(order_id);; i = (i + 1) & mask_)
+            {
+                const Slot &slot = slots_[i];
+                if (slot.order == nullptr)
+                {
+                    return nullptr;
+                }
+                if (slot.id == order_id)
+                {
+                    return slot.order;
+                }
+            }
+        }
+
+        bool insert(OrderId order_id, Order *order)
+        {
+            if ((size_ + 1) * 2 > slots_.size())
+            {
+                rehash(slots_.size() * 2);
+            }
+
+            size_t i = slot_of(order_id);
+            while (slots_[i].order != nullptr)
+            {
+                if (slots_[i].id == order_id)
+                {
+                    return false;
+                }
+                i = (i + 1) & mask_;
+            }
+
+            slots_[i] = Slot{order_id, order};
+            ++size_;
+            return true;
+        }
+
+        // Backward-shift deletion keeps probe chains intact without tombstones
+        bool erase(OrderId order_id)
+        {
+            size_t i = slot_of(order_id);
+            while (slots_[i].order != nullptr && slots_[i].id != order_id)
+            {
+                i = (i + 1) & mask_;
+            }
+            if (slots_[i].order == nullptr)
+            {
+                return false;
+            }
+
+            size_t hole = i;
+            for (size_t j = (hole + 1) & mask_; slots_[j].order != nullptr; j = (j + 1) & mask_)
+            {
+                size_t home = slot_of(slots_[j].id);
+                if (((j - home) & mask_) >= ((j - hole) & mask_))
+                {
+                    slots_[hole] = slots_[j];
+                    hole = j;
+                }
+            }
+            slots_[hole] = Slot{0, nullptr};
+            --size_;
+            return true;
+        }
+
+        // Visits live entries until fn returns false
+        template <typename Fn>
+        void for_each(Fn &&fn) const
+        {
+            for (const Slot &slot : slots_)
+            {
+                if (slot.order != nullptr && !fn(slot.id, slot.order))
+                {
+                    return;
+                }
+            }
+        }
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        size_t memory_usage() const { return slots_.size() * sizeof(Slot); }
+
+    private:
+        struct Slot
+        {
+            OrderId id;
+            Order *order;
+        };
+
+        std::vector<Slot> slots_;
+        size_t mask_;
+        unsigned shift_;
+        size_t size_;
+
+        void rehash(size_t capacity)
+        {
+            std::vector<Slot> old = std::move(slots_);
+            slots_.assign(capacity, Slot{0, nullptr});
+            mask_ = capacity - 1;
+            shift_ = 64 - static_cast<unsigned>(__builtin_ctzll(capacity));
+
+            for (const Slot &slot : old)
+            {
+                if (slot.order != nullptr)
+                {
+                    size_t i = slot_of(slot.id);
+                    while (slots_[i].order != nullptr)
+                    {
+                        i = (i + 1) & mask_;
+                    }
+                    slots_[i] = slot;
+                }
+            }
+        }
+    };
+
+} // namespace mm
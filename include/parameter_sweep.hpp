@@ -0,0 +1,164 @@
+#pragma once
+
+#include "types.hpp"
+#include "order_book.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mm
+{
+
+    /**
+     * One market event a sweep reacts to: an execution against a resting
+     * order, a change of best bid/ask, or both
+     */
+    struct TapeEvent
+    {
+        Timestamp timestamp;
+        Price trade_price;       // Price of the resting order executed, 0 if none
+        BestBidOffer bbo;        // Market best bid/ask after the event
+        Quantity trade_quantity; // 0 if the event only moved the BBO
+        uint32_t slot;           // Dense index of the symbol, < FeedTape::symbol_count()
+        SymbolId symbol;
+        OrderSide trade_side;    // Side of the resting order that traded
+    };
+
+    /**
+     * A day of market data decoded once into a read-only event buffer.
+     *
+     * Book updates are applied in order to a private reference book, and
+     * only those that traded or moved a symbol's BBO are kept, with the
+     * execution price resolved from the resting order. Any number of
+     * sweeps can then read the tape concurrently.
+     */
+    class FeedTape
+    {
+    public:
+        explicit FeedTape(size_t orders_per_book = 1024, size_t levels_per_book = 256);
+        ~FeedTape() = default;
+
+        // Non-copyable, non-movable
+        FeedTape(const FeedTape &) = delete;
+        FeedTape &operator=(const FeedTape &) = delete;
+        FeedTape(FeedTape &&) = delete;
+        FeedTape &operator=(FeedTape &&) = delete;
+
+        /**
+         * Decode an ITCH file and append its events batch by batch; false if
+         * the file could not be read or the reference book grew past
+         * memory_cap_bytes (0 = no cap), keeping the events read until then
+         */
+        bool load_itch_file(const std::string &filename, size_t memory_cap_bytes = 0);
+
+        /**
+         * Apply decoded book updates to the reference book and append the
+         * events they produce
+         */
+        void append(const BookUpdate *updates, size_t count);
+
+        const TapeEvent *data() const { return events_.data(); }
+        size_t size() const { return events_.size(); }
+        const TapeEvent &operator[](size_t i) const { return events_[i]; }
+
+        /**
+         * Distinct symbols on the tape; slot i of a TapeEvent is symbol_at(i)
+         */
+        size_t symbol_count() const { return symbols_.size(); }
+        SymbolId symbol_at(size_t slot) const { return symbols_[slot]; }
+
+        /**
+         * Book updates seen, including those that produced no event
+         */
+        uint64_t updates_applied() const { return updates_applied_; }
+
+    private:
+        static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+        OrderBookManager books_;
+        std::vector<TapeEvent> events_;
+        std::vector<SymbolId> symbols_;
+        std::vector<BestBidOffer> last_bbo_;  // By slot
+        std::unique_ptr<uint32_t[]> slot_of_; // By SymbolId
+        uint64_t updates_applied_;
+    };
+
+    /**
+     * One point of the grid: the InventorySkewedStrategy settings being tuned
+     */
+    struct SweepParams
+    {
+        Price min_spread;
+        Price max_spread;
+        Quantity max_inventory;
+        Quantity quote_size;
+    };
+
+    /**
+     * Outcome of running one SweepParams over a tape
+     */
+    struct SweepResult
+    {
+        SweepParams params;
+        PnL pnl;          // Fills marked to each symbol's last mid
+        PnL peak_pnl;
+        PnL max_drawdown; // Largest fall of pnl from its running peak
+        uint64_t fills;
+        uint64_t filled_quantity;
+        uint64_t quote_updates; // Events that changed a resting quote
+        int64_t max_position;   // Largest |net position| held in any symbol
+    };
+
+    struct SweepReport
+    {
+        std::vector<SweepResult> results; // In params order
+        size_t threads;
+        double makespan_ms;
+    };
+
+    /**
+     * Runs many InventorySkewedStrategy parameter sets over one FeedTape in
+     * parallel.
+     *
+     * Each parameter set keeps only a private overlay: its own resting bid
+     * and ask and net position per symbol, on top of the shared market BBO.
+     * It quotes around the market mid with skewed_quote(), pulls a side that
+     * would cross the market, and is filled whenever an execution on the
+     * tape reaches its quote (queue position is not modelled). P&L is marked
+     * to mid on every event, so drawdown is exact at event granularity.
+     *
+     * Workers claim configs_per_pass parameter sets at a time and run them
+     * together in one pass over the tape, so each tape line is read once per
+     * group; nothing is shared between workers but the read-only tape.
+     */
+    class ParameterSweep
+    {
+    public:
+        struct Config
+        {
+            size_t num_threads;      // 0 = hardware concurrency
+            size_t configs_per_pass; // Parameter sets sharing one pass over the tape
+
+            Config() : num_threads(0), configs_per_pass(8) {}
+        };
+
+        explicit ParameterSweep(const Config &config = Config());
+        ~ParameterSweep() = default;
+
+        // Non-copyable, non-movable
+        ParameterSweep(const ParameterSweep &) = delete;
+        ParameterSweep &operator=(const ParameterSweep &) = delete;
+        ParameterSweep(ParameterSweep &&) = delete;
+        ParameterSweep &operator=(ParameterSweep &&) = delete;
+
+        /**
+         * Run every parameter set over the tape. Throws std::invalid_argument,
+         * before any work starts, if a parameter set is invalid.
+         */
+        SweepReport run(const FeedTape &tape, const std::vector<SweepParams> &params) const;
+
+    private:
+        Config config_;
+    };
+
+} // namespace mm
@@ -0,0 +1,284 @@
+#pragma once
+
+#include "types.hpp"
+#include "order_book.hpp"
+#include "position_tracker.hpp"
+#include "quote_manager.hpp"
+#include "quote_kernel.hpp"
+#include "strategy.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace mm
+{
+
+    /**
+     * Policies for PolicyStrategy. Each has a Config it is built from and
+     * one inline hook:
+     *
+     *   fair value: Price fair_value(size_t slot, const BestBidOffer &bbo) const
+     *   spread:     void quote_prices(Price fair_value, int64_t inventory, Price &bid, Price &ask) const
+     *   sizing:     void sizes(int64_t inventory, Quantity &bid_size, Quantity &ask_size) const
+     */
+
+    // Quotes around a configured price, ignoring the book
+    class FixedFairValue
+    {
+    public:
+        struct Config
+        {
+            Price base_price;
+        };
+
+        explicit FixedFairValue(const Config &cfg) : base_price_(cfg.base_price) {}
+
+        Price fair_value(size_t, const BestBidOffer &) const { return base_price_; }
+
+    private:
+        Price base_price_;
+    };
+
+    // Quotes around the book's mid, or fallback_price while either side is empty
+    class MidFairValue
+    {
+    public:
+        struct Config
+        {
+            Price fallback_price;
+        };
+
+        explicit MidFairValue(const Config &cfg) : fallback_price_(cfg.fallback_price) {}
+
+        Price fair_value(size_t, const BestBidOffer &bbo) const
+        {
+            return bbo.bid > 0 && bbo.ask > 0 ? (bbo.bid + bbo.ask) / 2 : fallback_price_;
+        }
+
+    private:
+        Price fallback_price_;
+    };
+
+    // Symmetric spread, whatever the inventory
+    class FixedSpread
+    {
+    public:
+        struct Config
+        {
+            Price spread;
+        };
+
+        explicit FixedSpread(const Config &cfg) : half_spread_(cfg.spread / 2) {}
+
+        void quote_prices(Price fair_value, int64_t, Price &bid, Price &ask) const
+        {
+            bid = fair_value - half_spread_;
+            ask = fair_value + half_spread_;
+        }
+
+    private:
+        Price half_spread_;
+    };
+
+    // Shifts the mid against inventory and widens with it, as skewed_quote()
+    class InventorySkewSpread
+    {
+    public:
+        struct Config
+        {
+            Price min_spread;
+            Price max_spread;
+            Quantity max_inventory;
+        };
+
+        // Throws std::invalid_argument as make_skewed_quote_params()
+        explicit InventorySkewSpread(const Config &cfg)
+            : params_(make_skewed_quote_params(cfg.min_spread, cfg.max_spread, cfg.max_inventory)) {}
+
+        void quote_prices(Price fair_value, int64_t inventory, Price &bid, Price &ask) const
+        {
+            skewed_quote(fair_value, inventory, params_, bid, ask);
+        }
+
+    private:
+        SkewedQuoteParams params_;
+    };
+
+    // Same size on both sides
+    class FixedSize
+    {
+    public:
+        struct Config
+        {
+            Quantity quote_size;
+        };
+
+        explicit FixedSize(const Config &cfg) : quote_size_(cfg.quote_size) {}
+
+        void sizes(int64_t, Quantity &bid_size, Quantity &ask_size) const
+        {
+            bid_size = quote_size_;
+            ask_size = quote_size_;
+        }
+
+    private:
+        Quantity quote_size_;
+    };
+
+    // quote_size per side, cut so a full fill cannot take |inventory| past max_inventory
+    class InventoryLimitedSize
+    {
+    public:
+        struct Config
+        {
+            Quantity quote_size;
+            Quantity max_inventory;
+        };
+
+        explicit InventoryLimitedSize(const Config &cfg)
+            : quote_size_(cfg.quote_size), max_inventory_(cfg.max_inventory) {}
+
+        void sizes(int64_t inventory, Quantity &bid_size, Quantity &ask_size) const
+        {
+            bid_size = room(max_inventory_ - inventory);
+            ask_size = room(max_inventory_ + inventory);
+        }
+
+    private:
+        int64_t quote_size_;
+        int64_t max_inventory_;
+
+        Quantity room(int64_t headroom) const
+        {
+            return static_cast<Quantity>(headroom <= 0 ? 0 : (headroom < quote_size_ ? headroom : quote_size_));
+        }
+    };
+
+    /**
+     * Market-making strategy composed at compile time from a fair-value, a
+     * spread and a sizing policy. Nothing on the quote path is virtual, so
+     * compute_quote() and the policies inline into on_book_update(); the
+     * working orders are left to a QuoteManager the caller owns.
+     *
+     * Has the same callbacks as MarketMakingStrategy without deriving from
+     * it; wrap it in StrategyAdapter to select it at runtime or to register
+     * it with a StrategyDispatcher.
+     */
+    template <typename FairValuePolicy, typename SpreadPolicy, typename SizePolicy>
+    class PolicyStrategy
+    {
+    public:
+        struct Config
+        {
+            typename FairValuePolicy::Config fair_value;
+            typename SpreadPolicy::Config spread;
+            typename SizePolicy::Config size;
+            std::vector<SymbolId> symbols;
+        };
+
+        // Throws std::invalid_argument as validate_strategy_symbols()
+        PolicyStrategy(const Config &cfg, QuoteManager &quotes)
+            : fair_value_(cfg.fair_value), spread_(cfg.spread), size_(cfg.size), symbols_(cfg.symbols), quotes_(quotes)
+        {
+            validate_strategy_symbols(symbols_);
+        }
+
+        // Non-copyable, non-movable
+        PolicyStrategy(const PolicyStrategy &) = delete;
+        PolicyStrategy &operator=(const PolicyStrategy &) = delete;
+        PolicyStrategy(PolicyStrategy &&) = delete;
+        PolicyStrategy &operator=(PolicyStrategy &&) = delete;
+
+        /**
+         * Quotes for the symbol in slot given its book and our inventory
+         */
+        QuoteTarget compute_quote(size_t slot, const BestBidOffer &bbo, int64_t inventory) const
+        {
+            QuoteTarget target;
+            spread_.quote_prices(fair_value_.fair_value(slot, bbo), inventory, target.bid_price, target.ask_price);
+            size_.sizes(inventory, target.bid_size, target.ask_size);
+            return target;
+        }
+
+        void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now)
+        {
+            for (size_t slot = 0; slot < symbols_.size(); ++slot)
+            {
+                SymbolId symbol = symbols_[slot];
+                on_book_update(symbol, slot, order_books.get_bbo(symbol), order_books, positions, now);
+            }
+        }
+
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now)
+        {
+            Position position;
+            positions.get_position(symbol, position);
+            quotes_.update(order_books, symbol, compute_quote(slot, bbo, position.get_net_position()), now);
+        }
+
+        void on_trade(SymbolId symbol, Price, Quantity qty, OrderSide side, Timestamp)
+        {
+            quotes_.on_fill(symbol, side, qty);
+        }
+
+        void on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp) {}
+
+        size_t symbol_count() const { return symbols_.size(); }
+        SymbolId symbol_at(size_t slot) const { return symbols_[slot]; }
+
+    private:
+        FairValuePolicy fair_value_;
+        SpreadPolicy spread_;
+        SizePolicy size_;
+        std::vector<SymbolId> symbols_;
+        QuoteManager &quotes_;
+    };
+
+    using FixedSpreadPolicyStrategy = PolicyStrategy<FixedFairValue, FixedSpread, FixedSize>;
+    using InventorySkewedPolicyStrategy = PolicyStrategy<FixedFairValue, InventorySkewSpread, FixedSize>;
+
+    /**
+     * Puts a PolicyStrategy (or anything with its callbacks) behind the
+     * MarketMakingStrategy interface; the wrapped strategy quotes through
+     * the base's QuoteManager and risk gate. One virtual call per callback,
+     * after which the policies inline as in the bare strategy.
+     */
+    template <typename Strategy>
+    class StrategyAdapter : public MarketMakingStrategy
+    {
+    public:
+        StrategyAdapter(const typename Strategy::Config &cfg, OrderId first_order_id,
+                        const QuoteManagerConfig &quoting = QuoteManagerConfig())
+            : MarketMakingStrategy(first_order_id, quoting), strategy_(cfg, quotes_) {}
+
+        void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override
+        {
+            strategy_.update_quotes(order_books, positions, now);
+        }
+
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now) override
+        {
+            strategy_.on_book_update(symbol, slot, bbo, order_books, positions, now);
+        }
+
+        size_t symbol_count() const override { return strategy_.symbol_count(); }
+        SymbolId symbol_at(size_t slot) const override { return strategy_.symbol_at(slot); }
+
+        void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) override
+        {
+            strategy_.on_trade(symbol, price, qty, side, now);
+        }
+
+        void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) override
+        {
+            strategy_.on_position_update(symbol, pos, stats, now);
+        }
+
+        Strategy &get_strategy() { return strategy_; }
+
+    private:
+        Strategy strategy_;
+    };
+
+} // namespace mm
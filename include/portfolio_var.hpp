@@ -0,0 +1,154 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <memory>
+
+namespace mm
+{
+
+    /**
+     * Settings for the parametric VaR model
+     */
+    struct PortfolioVaRConfig
+    {
+        size_t capacity; // Most symbols in the universe
+        double decay;    // EWMA lambda per observation
+        double z_score;  // One-sided normal quantile; 2.326 = 99%
+        PnL max_var;     // Limit checked by within_limit()
+
+        PortfolioVaRConfig() : capacity(1024), decay(0.94), z_score(2.326), max_var(price_from_dollars(1000000.0)) {}
+    };
+
+    /**
+     * Incremental parametric VaR over a universe of correlated symbols.
+     *
+     * Keeps an EWMA covariance of per-share mid-price changes, the positions
+     * q, w = Cq and the portfolio variance q'Cq. Because the covariance is of
+     * price changes rather than returns, moving marks does not restate every
+     * exposure. A fill of d shares in symbol i is a rank-1 change to q, so
+     *
+     *   q'Cq += 2d w[i] + d^2 C[i][i]   and   w += d C[:, i]
+     *
+     * costs O(n), and the variance after a hypothetical fill costs O(1). Only
+     * observe(), the periodic covariance update, is O(n^2); it also rebuilds
+     * w exactly, so rounding from fills never accumulates.
+     *
+     * The covariance is a full symmetric n x n matrix of doubles with rows
+     * padded to whole cache lines, so a column is a contiguous row and every
+     * update is an aligned AVX2 FMA loop when the build targets it.
+     *
+     * Owned by one thread, like PreTradeRiskGate: no locks or atomics.
+     */
+    class PortfolioVaR
+    {
+    public:
+        explicit PortfolioVaR(const PortfolioVaRConfig &config = PortfolioVaRConfig());
+        ~PortfolioVaR() = default;
+
+        // Non-copyable, non-movable
+        PortfolioVaR(const PortfolioVaR &) = delete;
+        PortfolioVaR &operator=(const PortfolioVaR &) = delete;
+        PortfolioVaR(PortfolioVaR &&) = delete;
+        PortfolioVaR &operator=(PortfolioVaR &&) = delete;
+
+        /**
+         * Add a symbol to the universe so its covariance builds up before it
+         * trades; fills add symbols on their own. False once full.
+         */
+        bool add_symbol(SymbolId symbol);
+
+        /**
+         * A fill moved a position; O(n)
+         */
+        void on_fill(SymbolId symbol, OrderSide side, Quantity quantity);
+
+        /**
+         * Resynchronise a net position, e.g. from a tracker snapshot; O(n)
+         */
+        void set_position(SymbolId symbol, int64_t net_position);
+
+        /**
+         * One EWMA observation from dense BBO arrays indexed by SymbolId, as
+         * kept by OrderBookManager; call on a fixed cadence. Symbols without
+         * a two-sided quote, or without a previous mid, count as unchanged.
+         */
+        void observe(const Price *best_bids, const Price *best_asks);
+        void observe(const std::atomic<Price> *best_bids, const std::atomic<Price> *best_asks);
+
+        /**
+         * Variance of one-observation portfolio P&L, in Price units squared
+         */
+        double variance() const { return variance_ > 0 ? variance_ : 0; }
+
+        /**
+         * q'Cq recomputed from scratch, one row dot product per symbol;
+         * O(n^2). For checking the incremental variance for drift.
+         */
+        double full_variance() const;
+
+        /**
+         * z_score * sqrt(variance), in Price units
+         */
+        PnL value_at_risk() const;
+
+        /**
+         * VaR if net_delta more shares of symbol filled now; O(1)
+         */
+        PnL value_at_risk_after(SymbolId symbol, int64_t net_delta) const;
+
+        bool within_limit() const { return value_at_risk() <= config_.max_var; }
+
+        double covariance(SymbolId a, SymbolId b) const;
+        int64_t get_position(SymbolId symbol) const;
+        size_t symbol_count() const { return count_; }
+
+        struct Stats
+        {
+            uint64_t fills;
+            uint64_t observations;
+        };
+
+        const Stats &get_stats() const { return stats_; }
+
+    private:
+        // Unit of allocation, so rows start on cache-line boundaries
+        struct alignas(CACHE_LINE_SIZE) DoubleBlock
+        {
+            double values[CACHE_LINE_SIZE / sizeof(double)];
+        };
+
+        static constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+        PortfolioVaRConfig config_;
+        size_t stride_; // Doubles per row
+        size_t count_;
+        Stats stats_;
+        double variance_;
+
+        std::unique_ptr<uint32_t[]> index_; // SymbolId -> row, NO_INDEX if absent
+        std::unique_ptr<SymbolId[]> symbols_;
+        std::unique_ptr<DoubleBlock[]> covariance_storage_;
+        std::unique_ptr<DoubleBlock[]> vector_storage_; // q, w, changes, last mids
+        double *covariance_;
+        double *position_;
+        double *weighted_; // w = C q
+        double *change_;
+        double *last_mid_;
+
+        uint32_t index_of(SymbolId symbol);
+        void apply_delta(uint32_t index, double delta);
+
+        // Halves of observe(): one row's price change, then the EWMA step
+        void record_mid(size_t index, Price bid, Price ask)
+        {
+            double mid = bid > 0 && ask > 0 ? static_cast<double>(bid + ask) / 2 : 0;
+            change_[index] = mid > 0 && last_mid_[index] > 0 ? mid - last_mid_[index] : 0;
+            last_mid_[index] = mid > 0 ? mid : last_mid_[index];
+        }
+        void update_covariance();
+        double *row(size_t index) { return covariance_ + index * stride_; }
+        const double *row(size_t index) const { return covariance_ + index * stride_; }
+    };
+
+} // namespace mm
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstddef>
+#include <string>
+
+namespace mm
+{
+
+    struct Position;
+
+    // "MMPOSITN" read as a little-endian word
+    constexpr uint64_t POSITION_FILE_MAGIC = 0x4E5449534F504D4Dull;
+
+    // Bump whenever PositionRecord or PositionFileHeader changes
+    constexpr uint32_t POSITION_FILE_VERSION = 1;
+
+    // Reads back as this value only on a machine with the writer's byte order
+    constexpr uint32_t POSITION_FILE_BYTE_ORDER = 0x01020304;
+
+    // One page, so records start page-aligned and never straddle a page
+    constexpr size_t POSITION_FILE_HEADER_SIZE = 4096;
+
+    /**
+     * Start of a position file. Records follow at POSITION_FILE_HEADER_SIZE,
+     * one per SymbolId, so a symbol's record never moves.
+     */
+    struct PositionFileHeader
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t header_size;
+        uint32_t record_size;
+        uint64_t record_count;
+        uint64_t layout; // Fingerprint of PositionRecord field offsets and sizes
+        uint32_t crc;    // CRC-32C of the fields above
+        uint32_t reserved;
+    };
+
+    /**
+     * On-disk form of a Position with explicit field widths and offsets.
+     * symbol == 0 marks an empty slot. crc covers every other byte, so a
+     * torn or stale record is caught on load.
+     */
+    struct alignas(CACHE_LINE_SIZE) PositionRecord
+    {
+        uint16_t symbol;
+        uint16_t reserved;
+        uint32_t long_quantity;
+        uint32_t short_quantity;
+        uint32_t crc;
+        int64_t avg_long_price;
+        int64_t avg_short_price;
+        int64_t realized_pnl;
+        int64_t unrealized_pnl;
+        uint64_t last_update;
+        uint64_t fill_sequence;
+    };
+
+    static_assert(sizeof(PositionRecord) == CACHE_LINE_SIZE, "Position records are one cache line");
+    static_assert(POSITION_FILE_HEADER_SIZE % sizeof(PositionRecord) == 0, "Records must stay aligned");
+
+    /**
+     * Fingerprint of the compiled PositionRecord layout; a file written by a
+     * build with a different layout is rejected instead of misread
+     */
+    uint64_t position_record_layout();
+
+    PositionFileHeader make_position_file_header(size_t record_count);
+
+    /**
+     * Throw std::runtime_error unless header describes a file this build can
+     * map, holding record_count records within file_size bytes
+     */
+    void validate_position_file_header(const PositionFileHeader &header, size_t file_size, const std::string &path);
+
+    /**
+     * True if the bytes start with the position file magic; older files are
+     * bare Position arrays
+     */
+    bool is_position_file(const void *data, size_t size);
+
+    uint32_t position_record_checksum(const PositionRecord &record);
+
+    /**
+     * Encode a position, checksum included
+     */
+    PositionRecord to_position_record(const Position &position);
+
+    Position from_position_record(const PositionRecord &record);
+
+    /**
+     * Read-only mapping of a position file. Records are served straight
+     * from the mapping and checked on access, so opening costs one header
+     * check regardless of how many symbols the file holds.
+     */
+    class PositionFileView
+    {
+    public:
+        explicit PositionFileView(const std::string &path);
+        ~PositionFileView();
+
+        // Non-copyable, non-movable
+        PositionFileView(const PositionFileView &) = delete;
+        PositionFileView &operator=(const PositionFileView &) = delete;
+        PositionFileView(PositionFileView &&) = delete;
+        PositionFileView &operator=(PositionFileView &&) = delete;
+
+        size_t record_count() const { return record_count_; }
+
+        /**
+         * The mapped record for a symbol, or nullptr if the slot is empty.
+         * Throws std::runtime_error if the record fails its checksum.
+         */
+        const PositionRecord *record(SymbolId symbol) const;
+
+        /**
+         * Decode a symbol's position into out; false if the slot is empty
+         */
+        bool get_position(SymbolId symbol, Position &out) const;
+
+    private:
+        std::string path_;
+        int fd_;
+        void *mmap_ptr_;
+        size_t mmap_size_;
+        const PositionRecord *records_;
+        size_t record_count_;
+    };
+
+} // namespace mm
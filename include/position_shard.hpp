@@ -0,0 +1,80 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <memory>
+
+namespace mm
+{
+
+    class PositionTracker;
+
+    /**
+     * A fill waiting in a shard for consolidation
+     */
+    struct ShardFill
+    {
+        Price price;
+        OrderId order_id;
+        Timestamp timestamp;
+        Quantity quantity;
+        SymbolId symbol;
+        OrderSide side;
+    };
+
+    /**
+     * Fill accumulator owned by one writer thread.
+     *
+     * record_trade() touches only memory this thread owns: a per-symbol net
+     * quantity delta and a single-producer ring of fills. Nothing is shared
+     * with other writers, so fill sources never contend. The tracker's
+     * consolidation replays the ring through the normal lot and journal path;
+     * readers merge the still-pending deltas with the base positions. If the
+     * ring fills up, the writer consolidates its own shard.
+     */
+    class PositionShard
+    {
+    public:
+        static constexpr size_t RING_CAPACITY = 1 << 14;
+
+        // Non-copyable, non-movable
+        PositionShard(const PositionShard &) = delete;
+        PositionShard &operator=(const PositionShard &) = delete;
+        PositionShard(PositionShard &&) = delete;
+        PositionShard &operator=(PositionShard &&) = delete;
+
+        /**
+         * Record a fill; call only from the thread that owns this shard
+         */
+        bool record_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id, Timestamp now);
+
+        /**
+         * Fills recorded but not yet folded into the base positions
+         */
+        uint64_t pending() const
+        {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        uint64_t fills() const { return head_.load(std::memory_order_relaxed); }
+
+    private:
+        friend class PositionTracker;
+
+        explicit PositionShard(PositionTracker &owner);
+
+        PositionTracker &owner_;
+        std::unique_ptr<ShardFill[]> ring_;
+
+        // Owner-written: cumulative signed quantity per SymbolId
+        std::unique_ptr<std::atomic<int64_t>[]> net_;
+
+        // Consolidator-written: the part of net_ already in the base positions
+        std::unique_ptr<std::atomic<int64_t>[]> applied_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_; // Owner
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_; // Consolidator
+        std::atomic<uint64_t> drain_sequence_;                // Odd while a batch is being folded in
+    };
+
+} // namespace mm
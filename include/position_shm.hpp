@@ -0,0 +1,184 @@
+#pragma once
+
+#include "types.hpp"
+#include "seqlock.hpp"
+#include "position_file.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mm
+{
+
+    class PositionTracker;
+    struct Position;
+
+    // "MMSHMPOS" read as a little-endian word
+    constexpr uint64_t POSITION_SHM_MAGIC = 0x534F504D48534D4Dull;
+
+    // Bump whenever SharedPositionHeader, SharedTotals or the slot layout changes
+    constexpr uint32_t POSITION_SHM_VERSION = 1;
+
+    constexpr const char *DEFAULT_POSITION_SHM_NAME = "/mm_positions";
+
+    /**
+     * Portfolio totals as of one publish cycle
+     */
+    struct SharedTotals
+    {
+        PnL realized_pnl;
+        PnL unrealized_pnl;
+        PnL total_pnl;
+        PnL gross_exposure;
+        PnL net_exposure;
+        PnL peak_pnl;
+        PnL drawdown;
+        PnL max_drawdown;
+        uint64_t trades;
+        uint64_t active_symbols;
+    };
+
+    /**
+     * Start of the shared segment. Slots follow at slot_offset, one
+     * Seqlock<PositionRecord> per SymbolId. magic is stored last, so a
+     * reader that sees it sees the rest of the header.
+     */
+    struct SharedPositionHeader
+    {
+        std::atomic<uint64_t> magic;
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t slot_size;
+        uint32_t slot_count;
+        uint64_t slot_offset;
+        uint64_t layout; // position_record_layout() of the publisher
+        int64_t publisher_pid;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> publish_version; // Bumped by every cycle that changed something
+        std::atomic<uint64_t> heartbeat_ns;                             // System clock at the last cycle
+        std::atomic<uint32_t> symbol_bound;                             // Slots at and above are empty
+
+        alignas(CACHE_LINE_SIZE) Seqlock<SharedTotals> totals;
+    };
+
+    using SharedPositionSlot = Seqlock<PositionRecord>;
+
+    /**
+     * Mirrors a tracker's positions and totals into a POSIX shared-memory
+     * segment for out-of-process monitors.
+     *
+     * A background thread polls get_positions_changed_since() and copies
+     * only changed positions into per-slot seqlocks, so trading threads do
+     * no extra work and readers in other processes never block anything.
+     * The segment is unlinked when the publisher is destroyed.
+     */
+    class SharedPositionPublisher
+    {
+    public:
+        /**
+         * Create (or replace) the segment and publish once. Zero interval =
+         * only explicit publish() calls. Throws std::runtime_error if the
+         * segment cannot be created.
+         */
+        explicit SharedPositionPublisher(const PositionTracker &tracker,
+                                         const std::string &name = DEFAULT_POSITION_SHM_NAME,
+                                         std::chrono::microseconds interval = std::chrono::microseconds(1000));
+        ~SharedPositionPublisher();
+
+        // Non-copyable, non-movable
+        SharedPositionPublisher(const SharedPositionPublisher &) = delete;
+        SharedPositionPublisher &operator=(const SharedPositionPublisher &) = delete;
+        SharedPositionPublisher(SharedPositionPublisher &&) = delete;
+        SharedPositionPublisher &operator=(SharedPositionPublisher &&) = delete;
+
+        /**
+         * Copy positions changed since the last cycle and the totals into the
+         * segment; returns the number of positions written
+         */
+        size_t publish();
+
+        const std::string &name() const { return name_; }
+
+    private:
+        const PositionTracker &tracker_;
+        std::string name_;
+        void *mmap_ptr_;
+        size_t mmap_size_;
+        SharedPositionHeader *header_;
+        SharedPositionSlot *slots_;
+
+        std::mutex publish_mutex_;
+        uint64_t since_;
+        uint64_t reset_count_;
+        std::vector<Position> changed_;
+
+        std::chrono::microseconds interval_;
+        std::mutex thread_mutex_;
+        std::condition_variable cv_;
+        bool stop_;
+        std::thread thread_;
+
+        void publish_loop();
+    };
+
+    /**
+     * Read-only view of a published segment, for monitors in other
+     * processes. Every read is a seqlock copy, so it never blocks the
+     * publisher; reads that keep colliding with writes give up and report
+     * false rather than spin.
+     */
+    class SharedPositionReader
+    {
+    public:
+        /**
+         * Map the segment; throws std::runtime_error if it does not exist or
+         * was published by an incompatible build
+         */
+        explicit SharedPositionReader(const std::string &name = DEFAULT_POSITION_SHM_NAME);
+        ~SharedPositionReader();
+
+        // Non-copyable, non-movable
+        SharedPositionReader(const SharedPositionReader &) = delete;
+        SharedPositionReader &operator=(const SharedPositionReader &) = delete;
+        SharedPositionReader(SharedPositionReader &&) = delete;
+        SharedPositionReader &operator=(SharedPositionReader &&) = delete;
+
+        /**
+         * Copy one position; false if the symbol has no position or the read
+         * kept racing the publisher
+         */
+        bool get_position(SymbolId symbol, Position &out) const;
+
+        /**
+         * Replace out with every published position; returns the count
+         */
+        size_t get_positions(std::vector<Position> &out) const;
+
+        bool get_totals(SharedTotals &out) const;
+
+        /**
+         * Advances whenever a publish cycle changed something; poll it to
+         * skip rereading an unchanged segment
+         */
+        uint64_t version() const { return header_->publish_version.load(std::memory_order_acquire); }
+
+        /**
+         * System-clock nanoseconds of the publisher's last cycle; a stale
+         * heartbeat means the publisher stopped
+         */
+        uint64_t heartbeat_ns() const { return header_->heartbeat_ns.load(std::memory_order_acquire); }
+
+        int64_t publisher_pid() const { return header_->publisher_pid; }
+
+    private:
+        void *mmap_ptr_;
+        size_t mmap_size_;
+        const SharedPositionHeader *header_;
+        const SharedPositionSlot *slots_;
+    };
+
+} // namespace mm
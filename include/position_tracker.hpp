@@ -1,9 +1,24 @@
 #pragma once
 
 #include "types.hpp"
+#include "seqlock.hpp"
+#include "trade_journal.hpp"
+#include "fill_wal.hpp"
+#include "mark_to_market.hpp"
+#include "equity_curve.hpp"
+#include "position_file.hpp"
+#include "lot_queue.hpp"
+#include "position_shard.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <thread>
+#include <vector>
 
 namespace mm
 {
@@ -21,10 +36,11 @@ namespace mm
         PnL realized_pnl;
         PnL unrealized_pnl;
         Timestamp last_update;
+        uint64_t fill_sequence; // Last write-ahead journal record applied (0 = none)
 
         Position() : symbol(0), long_quantity(0), short_quantity(0),
                      avg_long_price(0), avg_short_price(0), realized_pnl(0),
-                     unrealized_pnl(0), last_update(0) {}
+                     unrealized_pnl(0), last_update(0), fill_sequence(0) {}
 
         /**
          * Get net position (positive = long, negative = short)
@@ -67,23 +83,6 @@ namespace mm
         }
     };
 
-    /**
-     * Trade record for P&L calculation
-     */
-    struct Trade
-    {
-        SymbolId symbol;
-        Price price;
-        Quantity quantity;
-        OrderSide side;
-        Timestamp timestamp;
-        OrderId order_id;
-
-        Trade() : symbol(0), price(0), quantity(0), side(OrderSide::BUY), timestamp(0), order_id(0) {}
-        Trade(SymbolId s, Price p, Quantity q, OrderSide sd, OrderId oid)
-            : symbol(s), price(p), quantity(q), side(sd), timestamp(get_timestamp()), order_id(oid) {}
-    };
-
     /**
      * Position limits and risk management
      */
@@ -99,14 +98,21 @@ namespace mm
                            max_short_position(500000), max_daily_loss(1000000), max_drawdown(500000) {}
     };
 
+    // Most recent trades kept in memory per symbol; older ones come from the journal
+    constexpr size_t RECENT_TRADES_PER_SYMBOL = 32;
+
+    // Most writer threads that can each hold a PositionShard
+    constexpr size_t MAX_POSITION_SHARDS = 64;
+
     /**
      * High-performance position tracker with real-time P&L calculation
      */
     class PositionTracker
     {
     public:
-        explicit PositionTracker(const PositionLimits &limits = PositionLimits());
-        ~PositionTracker() = default;
+        explicit PositionTracker(const PositionLimits &limits = PositionLimits(),
+                                 const TradeJournal::Config &journal = TradeJournal::Config());
+        ~PositionTracker();
 
         // Non-copyable, non-movable
         PositionTracker(const PositionTracker &) = delete;
@@ -115,24 +121,135 @@ namespace mm
         PositionTracker &operator=(PositionTracker &&) = delete;
 
         /**
-         * Record a trade and update position
+         * Record a trade and update position, stamped with engine time
+         */
+        bool record_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id, Timestamp now);
+
+        /**
+         * Give a writer thread its own shard to record fills into without
+         * touching shared state. The tracker owns the shard; throws once
+         * MAX_POSITION_SHARDS exist.
+         */
+        PositionShard &create_shard();
+
+        /**
+         * Fold every shard's pending fills into the base positions, in each
+         * shard's order; returns the number of fills applied
          */
-        bool record_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id);
+        size_t consolidate();
+
+        /**
+         * Consolidate from a background thread every interval
+         */
+        void start_consolidation(std::chrono::microseconds interval);
+
+        /**
+         * Stop the background thread, if any, and fold in what is left
+         */
+        void stop_consolidation();
+
+        /**
+         * Copy a position including fills still pending in shards. Quantities
+         * are exact; average prices and P&L are as of the last consolidation.
+         */
+        bool get_merged_position(SymbolId symbol, Position &out) const;
+
+        /**
+         * Log every subsequent fill to a write-ahead journal before applying
+         * it. Set before trading starts; nullptr detaches.
+         */
+        void attach_wal(FillWal *wal) { wal_ = wal; }
+
+        /**
+         * Replay journal records newer than each position's fill_sequence, so
+         * a snapshot plus the journal tail rebuilds the state at the crash.
+         * Call before attach_wal; returns the number of fills applied.
+         */
+        size_t recover(const FillWal &wal);
 
         /**
          * Update unrealized P&L based on current market prices
          */
-        void update_unrealized_pnl(SymbolId symbol, Price current_price);
+        void update_unrealized_pnl(SymbolId symbol, Price current_price, Timestamp now);
 
         /**
          * Update unrealized P&L for all positions
          */
-        void update_all_unrealized_pnl(const std::map<SymbolId, Price> &current_prices);
+        void update_all_unrealized_pnl(const std::map<SymbolId, Price> &current_prices, Timestamp now);
+
+        /**
+         * Mark every position to the mid of dense BBO arrays indexed by
+         * SymbolId, as kept by OrderBookManager. One vectorized pass finds the
+         * positions whose P&L moved; only those slots are written. Symbols
+         * without a two-sided quote keep their last mark. Returns the number
+         * of positions updated.
+         */
+        size_t mark_to_market(const Price *best_bids, const Price *best_asks, Timestamp now);
+
+        /**
+         * As above, straight from OrderBookManager's live arrays, which are
+         * snapshotted with relaxed loads before the pass
+         */
+        size_t mark_to_market(const std::atomic<Price> *best_bids, const std::atomic<Price> *best_asks, Timestamp now);
 
         /**
-         * Get position for a symbol
+         * Sample total P&L into the equity curve. Reads the lock-free
+         * aggregates, so fills never wait on it; mark_to_market() and
+         * update_all_unrealized_pnl() sample on their own. Returns false if
+         * another thread was sampling and this sample was skipped.
          */
-        const Position *get_position(SymbolId symbol) const;
+        bool sample_equity(Timestamp now);
+
+        /**
+         * Peak, current and max drawdown as of the last sample
+         */
+        DrawdownStats get_drawdown() const { return equity_curve_.get_drawdown(); }
+
+        /**
+         * Per-second and per-minute total P&L buckets
+         */
+        const EquityCurve &get_equity_curve() const { return equity_curve_; }
+
+        /**
+         * Copy the position for a symbol into out; false if it has never traded
+         */
+        bool get_position(SymbolId symbol, Position &out) const;
+
+        /**
+         * Copy positions for count symbols into out[] as one consistent cut
+         * across all of them. Symbols that have never traded come back flat.
+         * Returns how many of the symbols have traded.
+         */
+        size_t get_positions(const SymbolId *symbols, size_t count, Position *out) const;
+
+        /**
+         * Replace out with every position changed at or after version since
+         * and return the version to pass on the next poll. Start from 0.
+         */
+        uint64_t get_positions_changed_since(uint64_t since, std::vector<Position> &out) const;
+
+        /**
+         * Copy up to max open lots for a symbol into out, in the order FIFO
+         * would close them; returns the number copied
+         */
+        size_t get_open_lots(SymbolId symbol, Lot *out, size_t max) const;
+
+        /**
+         * Lot matching for closing fills; set before trading starts
+         */
+        void set_lot_method(LotMethod method) { lot_method_ = method; }
+        LotMethod get_lot_method() const { return lot_method_; }
+
+        /**
+         * Symbols that have traded since construction or the last reset()
+         */
+        size_t get_active_symbol_count() const { return active_count_.load(std::memory_order_acquire); }
+
+        /**
+         * Number of reset() calls; pollers of get_positions_changed_since()
+         * use it to notice symbols that reset() dropped
+         */
+        uint64_t get_reset_count() const { return reset_count_.load(std::memory_order_acquire); }
 
         /**
          * Get all positions
@@ -142,17 +259,27 @@ namespace mm
         /**
          * Get total realized P&L across all symbols
          */
-        PnL get_total_realized_pnl() const;
+        PnL get_total_realized_pnl() const { return aggregates_.realized_pnl.load(std::memory_order_relaxed); }
 
         /**
          * Get total unrealized P&L across all symbols
          */
-        PnL get_total_unrealized_pnl() const;
+        PnL get_total_unrealized_pnl() const { return aggregates_.unrealized_pnl.load(std::memory_order_relaxed); }
 
         /**
          * Get total P&L (realized + unrealized)
          */
-        PnL get_total_pnl() const;
+        PnL get_total_pnl() const { return get_total_realized_pnl() + get_total_unrealized_pnl(); }
+
+        /**
+         * Sum of |net position| * mark price across all symbols
+         */
+        PnL get_gross_exposure() const { return aggregates_.gross_exposure.load(std::memory_order_relaxed); }
+
+        /**
+         * Sum of signed net position * mark price across all symbols
+         */
+        PnL get_net_exposure() const { return aggregates_.net_exposure.load(std::memory_order_relaxed); }
 
         /**
          * Check if position limits are exceeded
@@ -160,7 +287,7 @@ namespace mm
         bool check_position_limits(SymbolId symbol, Quantity quantity, OrderSide side) const;
 
         /**
-         * Check if risk limits are exceeded
+         * Check if risk limits are exceeded; lock-free, callable from any thread
          */
         bool check_risk_limits() const;
 
@@ -175,17 +302,30 @@ namespace mm
         void set_limits(const PositionLimits &limits) { limits_ = limits; }
 
         /**
-         * Get trade history for a symbol
+         * Get trade history for a symbol, from its recent-trade ring or, for
+         * older trades, from the part of the journal still mapped
          */
         std::vector<Trade> get_trade_history(SymbolId symbol) const;
 
         /**
-         * Get all trade history
+         * Get all trade history still in the journal, in sequence order
          */
         std::vector<Trade> get_all_trade_history() const;
 
         /**
-         * Clear trade history (for memory management)
+         * Copy up to max_trades trades with sequence >= from_sequence into out,
+         * in sequence order. Returns the number copied; the next page starts at
+         * the last one's sequence + 1. Fills are never blocked by the read.
+         */
+        size_t get_trade_history_page(uint64_t from_sequence, Trade *out, size_t max_trades) const;
+
+        /**
+         * Sequence number the next trade will get
+         */
+        uint64_t get_next_trade_sequence() const { return journal_.size(); }
+
+        /**
+         * Clear trade history; the journal keeps the records but stops serving them
          */
         void clear_trade_history();
 
@@ -211,20 +351,189 @@ namespace mm
         void reset();
 
     protected:
-        std::map<SymbolId, Position> positions_;
-        std::map<SymbolId, std::vector<Trade>> trade_history_;
+        /**
+         * What one symbol currently contributes to the portfolio aggregates
+         */
+        struct Contribution
+        {
+            PnL realized_pnl;
+            PnL unrealized_pnl;
+            PnL gross_exposure;
+            PnL net_exposure;
+        };
+
+        /**
+         * One symbol's state. Readers go through the seqlock; writers take
+         * write_lock, which also guards the recent-trade ring. Slots are whole
+         * cache lines so neighbouring symbols never false-share.
+         */
+        struct alignas(CACHE_LINE_SIZE) PositionSlot
+        {
+            Seqlock<Position> position;
+            SpinLock write_lock;
+            std::atomic<bool> active;
+            std::atomic<uint64_t> changed_version;
+            std::unique_ptr<Trade[]> recent_trades; // Ring of RECENT_TRADES_PER_SYMBOL, allocated on the first fill
+            LotQueue lots;
+            bool lots_pending; // Restored from disk; ensure_lots() builds its lot on first use
+            uint64_t trade_count;
+            Price mark_price; // Last trade or mark price, for exposure
+            Contribution contribution;
+
+            PositionSlot() : active(false), changed_version(0), lots_pending(false), trade_count(0), mark_price(0), contribution{} {}
+        };
+
+        // Dense store indexed by SymbolId; active_symbols_ lists touched slots
+        std::unique_ptr<PositionSlot[]> slots_;
+        std::unique_ptr<SymbolId[]> active_symbols_;
+        std::atomic<size_t> active_count_;
+        std::atomic<uint64_t> reset_count_;
+        std::mutex activation_mutex_;
+        TradeJournal journal_;
         PositionLimits limits_;
-        mutable std::mutex mutex_;
+        FillWal *wal_;
+        LotSegmentPool lot_pool_;
+        LotMethod lot_method_;
+
+        // Writer shards, created on demand and folded in by consolidate()
+        friend class PositionShard;
+        std::array<std::unique_ptr<PositionShard>, MAX_POSITION_SHARDS> shards_;
+        std::atomic<size_t> shard_count_;
+        std::mutex consolidation_mutex_;
+        std::mutex consolidation_thread_mutex_;
+        std::condition_variable consolidation_cv_;
+        bool stop_consolidation_;
+        std::thread consolidation_thread_;
 
         /**
-         * Update position for a trade
+         * Apply one shard's pending fills; caller holds consolidation_mutex_
          */
-        void update_position(SymbolId symbol, Price price, Quantity quantity, OrderSide side);
+        size_t drain_shard(PositionShard &shard);
+
+        // Poll version; only get_positions_changed_since advances it
+        alignas(CACHE_LINE_SIZE) mutable std::atomic<uint64_t> version_;
+
+        // Portfolio totals, moved by per-slot deltas on every write
+        struct alignas(CACHE_LINE_SIZE) Aggregates
+        {
+            std::atomic<PnL> realized_pnl;
+            std::atomic<PnL> unrealized_pnl;
+            std::atomic<PnL> gross_exposure;
+            std::atomic<PnL> net_exposure;
+        };
+        Aggregates aggregates_;
+
+        // Sampled total P&L; equity_lock_ serialises samplers, not fills
+        EquityCurve equity_curve_;
+        SpinLock equity_lock_;
 
         /**
-         * Calculate realized P&L for a trade
+         * Structure-of-arrays copy of what mark-to-market reads, indexed by
+         * SymbolId and written under the slot lock. sequence is odd while a
+         * row is being written; a pass that raced a write recomputes that
+         * symbol under its lock.
          */
-        PnL calculate_realized_pnl(SymbolId symbol, Price price, Quantity quantity, OrderSide side);
+        struct MarkState
+        {
+            std::unique_ptr<std::atomic<uint32_t>[]> sequence;
+            std::unique_ptr<int64_t[]> long_quantity;
+            std::unique_ptr<int64_t[]> short_quantity;
+            std::unique_ptr<Price[]> avg_long_price;
+            std::unique_ptr<Price[]> avg_short_price;
+            std::unique_ptr<PnL[]> unrealized_pnl;
+
+            // Per-pass scratch, guarded by mark_mutex_
+            std::unique_ptr<uint32_t[]> seen_sequence;
+            std::unique_ptr<Price[]> marks;
+            std::unique_ptr<Price[]> bbo_bid; // Snapshot of live BBO arrays
+            std::unique_ptr<Price[]> bbo_ask;
+            std::unique_ptr<PnL[]> marked_pnl;
+            std::unique_ptr<uint64_t[]> changed;
+        };
+        MarkState mark_state_;
+        std::mutex mark_mutex_;
+        std::atomic<size_t> symbol_bound_; // Highest activated SymbolId + 1
+
+        // One bit per SymbolId, set on every write; null unless a subclass
+        // persists positions and calls enable_dirty_tracking()
+        std::unique_ptr<std::atomic<uint64_t>[]> dirty_bits_;
+
+        void enable_dirty_tracking();
+
+        /**
+         * Move the aggregates by the change in a slot's contribution after a
+         * write; caller holds slot.write_lock
+         */
+        void update_aggregates(PositionSlot &slot);
+
+        /**
+         * Add the change in a slot's contribution to delta and record the new
+         * contribution; caller holds slot.write_lock
+         */
+        void accumulate_contribution(PositionSlot &slot, Contribution &delta);
+
+        void add_to_aggregates(const Contribution &delta);
+
+        /**
+         * One mark-to-market pass over the first count symbols; caller holds
+         * mark_mutex_
+         */
+        size_t mark_pass(const Price *best_bids, const Price *best_asks, size_t count, Timestamp now);
+
+        /**
+         * Copy a slot's position into the mark-to-market arrays; caller holds
+         * the slot's write_lock
+         */
+        void sync_mark_state(SymbolId symbol, const Position &position);
+
+        /**
+         * Mark a slot active on its first trade; caller holds slot.write_lock
+         */
+        void activate(SymbolId symbol, PositionSlot &slot);
+
+        /**
+         * Stamp a slot with the current poll version and mark it dirty after
+         * a write; caller holds slot.write_lock
+         */
+        void mark_changed(SymbolId symbol, PositionSlot &slot);
+
+        /**
+         * Apply one fill to an activated slot; caller holds slot.write_lock
+         */
+        void apply_fill(SymbolId symbol, PositionSlot &slot, Price price, Quantity quantity, OrderSide side,
+                        OrderId order_id, Timestamp now, uint64_t fill_sequence);
+
+        /**
+         * Visit each active symbol's slot in activation order
+         */
+        template <typename Fn>
+        void for_each_active(Fn &&fn) const
+        {
+            size_t count = active_count_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; ++i)
+            {
+                SymbolId symbol = active_symbols_[i];
+                fn(symbol, slots_[symbol]);
+            }
+        }
+
+        /**
+         * Set a position's quantities and average price from its open lots
+         */
+        void update_position(Position &position, SymbolId symbol, const LotQueue &lots, Timestamp now);
+
+        /**
+         * Net a position loaded from disk to one side, as legacy records may
+         * hold both, and defer its single lot at the average price to
+         * ensure_lots(), so restoring many symbols touches no lot segments
+         */
+        void seed_lots(SymbolId symbol, PositionSlot &slot, Position &position);
+
+        /**
+         * Build a restored slot's lot if still pending; caller holds
+         * slot.write_lock
+         */
+        void ensure_lots(PositionSlot &slot);
 
         /**
          * Calculate unrealized P&L for a position
@@ -233,39 +542,76 @@ namespace mm
     };
 
     /**
-     * Memory-mapped position tracker for persistence
+     * Memory-mapped position tracker for persistence.
+     *
+     * The file is a versioned header followed by one checksummed
+     * PositionRecord per SymbolId (see position_file.hpp), so the mapping
+     * never moves. Writes only set a dirty bit; flush() encodes the dirty
+     * slots and msyncs just the pages they touched. A background thread
+     * flushes on a fixed cadence, so trading threads never wait on disk.
      */
     class MMapPositionTracker : public PositionTracker
     {
     public:
-        explicit MMapPositionTracker(const std::string &file_path, const PositionLimits &limits = PositionLimits());
+        explicit MMapPositionTracker(const std::string &file_path, const PositionLimits &limits = PositionLimits(),
+                                     std::chrono::milliseconds sync_interval = std::chrono::milliseconds(100));
         ~MMapPositionTracker();
 
         /**
-         * Flush positions to memory-mapped file
+         * Copy dirty positions into the file and sync their pages; returns
+         * the number of slots written. Zero interval = only explicit flushes.
          */
-        void flush();
+        size_t flush();
 
         /**
-         * Load positions from memory-mapped file
+         * Load positions from the memory-mapped file, checking each record in
+         * place. Files from before the header are rewritten in the current
+         * format; throws std::runtime_error on a layout mismatch or a corrupt
+         * record.
          */
         void load();
 
     private:
         std::string file_path_;
+        std::mutex mmap_mutex_;
         void *mmap_ptr_;
         size_t mmap_size_;
         int fd_;
+        PositionRecord *records_; // Indexed by SymbolId, just past the header
+        bool legacy_;             // File has no header yet; load() reformats it
+
+        std::chrono::milliseconds sync_interval_;
+        std::mutex sync_mutex_;
+        std::condition_variable sync_cv_;
+        bool stop_;
+        std::thread sync_thread_;
 
         /**
          * Initialize memory mapping
          */
         void init_mmap();
 
+        void map_file(size_t size);
+
         /**
-         * Resize memory mapping if needed
+         * Truncate the file to a header and empty records; caller holds
+         * mmap_mutex_
          */
-        void resize_mmap(size_t new_size);
+        void format_file();
+
+        void load_legacy();
+
+        /**
+         * Install a position read from the file into its slot
+         */
+        void restore(SymbolId symbol, const Position &loaded);
+
+        /**
+         * flush() with mmap_mutex_ held
+         */
+        size_t flush_locked();
+
+        void sync_loop();
     };
 
 } // namespace mm
\ No newline at end of file
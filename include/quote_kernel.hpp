@@ -0,0 +1,59 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace mm
+{
+
+    // Fractional bits of the skew coefficients
+    constexpr int QUOTE_FIXED_POINT_BITS = 16;
+
+    // Inventories are clamped to this magnitude so products fit 64 bits
+    constexpr int64_t QUOTE_INVENTORY_LIMIT = int64_t(1) << 30;
+
+    /**
+     * Inventory-skew model in fixed point. With skew = inventory / max_inventory:
+     *
+     *   mid    = fair_value - skew * max_spread / 2
+     *   spread = min_spread + |skew| * (max_spread - min_spread)
+     *
+     * so each coefficient is price per share of inventory, scaled by
+     * 2^QUOTE_FIXED_POINT_BITS.
+     */
+    struct SkewedQuoteParams
+    {
+        Price min_spread;
+        int64_t mid_coefficient;
+        int64_t spread_coefficient;
+    };
+
+    /**
+     * Throws std::invalid_argument if max_inventory is zero, the spreads are
+     * inverted, or a coefficient does not fit 31 bits
+     */
+    SkewedQuoteParams make_skewed_quote_params(Price min_spread, Price max_spread, Quantity max_inventory);
+
+    /**
+     * One symbol of skewed_quote_kernel()
+     */
+    inline void skewed_quote(Price fair_value, int64_t inventory, const SkewedQuoteParams &params, Price &bid, Price &ask)
+    {
+        int64_t inv = inventory < -QUOTE_INVENTORY_LIMIT ? -QUOTE_INVENTORY_LIMIT
+                                                          : (inventory > QUOTE_INVENTORY_LIMIT ? QUOTE_INVENTORY_LIMIT : inventory);
+        int64_t magnitude = inv < 0 ? -inv : inv;
+        Price offset = (inv * params.mid_coefficient) >> QUOTE_FIXED_POINT_BITS;
+        Price half = (params.min_spread + ((magnitude * params.spread_coefficient) >> QUOTE_FIXED_POINT_BITS)) / 2;
+        Price mid = fair_value - offset;
+        bid = mid - half;
+        ask = mid + half;
+    }
+
+    /**
+     * bid[i] and ask[i] for count symbols from fair_value[i] and inventory[i],
+     * in one pass over the arrays with integer math only. Uses AVX2 when the
+     * build targets it; the scalar tail gives bit-identical results.
+     */
+    void skewed_quote_kernel(const Price *fair_value, const int64_t *inventory, size_t count,
+                             const SkewedQuoteParams &params, Price *bid, Price *ask);
+
+} // namespace mm
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "types.hpp"
+#include <memory>
+
+namespace mm
+{
+
+    class OrderBookManager;
+    class PreTradeRiskGate;
+    class QueueFillSimulator;
+
+    /**
+     * Quotes a strategy wants resting for one symbol; a zero size (or
+     * price) means no order on that side
+     */
+    struct QuoteTarget
+    {
+        Price bid_price;
+        Quantity bid_size;
+        Price ask_price;
+        Quantity ask_size;
+    };
+
+    /**
+     * Hysteresis for QuoteManager: a working order within both tolerances
+     * of its target is left alone, keeping its place in the queue
+     */
+    struct QuoteManagerConfig
+    {
+        Price price_tolerance;   // Largest price difference left unchanged
+        Quantity size_tolerance; // Largest remaining-size difference left unchanged
+        bool amend_in_place;     // Modify a working order rather than cancel and replace it
+
+        QuoteManagerConfig() : price_tolerance(0), size_tolerance(0), amend_in_place(true) {}
+    };
+
+    /**
+     * One resting order as the manager last left it
+     */
+    struct WorkingOrder
+    {
+        OrderId order_id; // 0 = nothing working
+        Price price;
+        Quantity quantity; // Total quantity as the book holds it
+        Quantity filled;
+
+        Quantity remaining() const { return quantity - filled; }
+    };
+
+    /**
+     * Keeps a strategy's working orders in line with its desired quotes.
+     *
+     * Holds the working bid and ask of every symbol and, on each update(),
+     * issues only what differs from the target: nothing when both sides
+     * are within tolerance, otherwise one amend, cancel or new order per
+     * side. Orders that vanished from the book (filled elsewhere, or the
+     * book was replaced) are detected by a failed amend and re-entered.
+     *
+     * Routes every order through the risk gate when one is set. In a
+     * backtest a QueueFillSimulator can take the orders in place of the
+     * book passed to update(). Owned by the strategy's thread: no locks.
+     */
+    class QuoteManager
+    {
+    public:
+        /**
+         * Order ids are handed out from first_order_id upward; give each
+         * manager sharing a book its own range
+         */
+        explicit QuoteManager(OrderId first_order_id, const QuoteManagerConfig &config = QuoteManagerConfig());
+        ~QuoteManager() = default;
+
+        // Non-copyable, non-movable
+        QuoteManager(const QuoteManager &) = delete;
+        QuoteManager &operator=(const QuoteManager &) = delete;
+        QuoteManager(QuoteManager &&) = delete;
+        QuoteManager &operator=(QuoteManager &&) = delete;
+
+        void set_risk_gate(PreTradeRiskGate *gate) { risk_gate_ = gate; }
+        PreTradeRiskGate *risk_gate() const { return risk_gate_; }
+
+        /**
+         * Send orders to a fill simulator instead of the order book; null
+         * restores the book
+         */
+        void set_fill_simulator(QueueFillSimulator *simulator) { simulator_ = simulator; }
+
+        /**
+         * Bring both sides of symbol in line with target
+         */
+        void update(OrderBookManager &order_books, SymbolId symbol, const QuoteTarget &target, Timestamp now);
+
+        /**
+         * One of our orders filled; a fully filled order stops being working.
+         * Also forwarded to the risk gate.
+         */
+        void on_fill(SymbolId symbol, OrderSide side, Quantity quantity);
+
+        /**
+         * Pull every working order, e.g. on shutdown or a risk breach
+         */
+        void cancel_all(OrderBookManager &order_books, Timestamp now);
+
+        const WorkingOrder &working(SymbolId symbol, OrderSide side) const
+        {
+            return side == OrderSide::BUY ? quotes_[symbol].bid : quotes_[symbol].ask;
+        }
+
+        const QuoteManagerConfig &get_config() const { return config_; }
+
+        struct Stats
+        {
+            uint64_t new_orders;
+            uint64_t amends;
+            uint64_t cancels;
+            uint64_t unchanged; // Sides left alone by an update
+            uint64_t rejected;  // Turned down by the risk gate or the book
+
+            uint64_t operations() const { return new_orders + amends + cancels; }
+        };
+
+        const Stats &get_stats() const { return stats_; }
+        void reset_stats() { stats_ = Stats{0, 0, 0, 0, 0}; }
+
+    private:
+        struct SymbolQuotes
+        {
+            WorkingOrder bid;
+            WorkingOrder ask;
+        };
+
+        QuoteManagerConfig config_;
+        PreTradeRiskGate *risk_gate_;
+        QueueFillSimulator *simulator_;
+        OrderId next_order_id_;
+        Stats stats_;
+        std::unique_ptr<SymbolQuotes[]> quotes_; // Indexed by SymbolId
+
+        void update_side(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order,
+                         Price price, Quantity size, Timestamp now);
+        bool place(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order,
+                   Price price, Quantity size, Timestamp now);
+        bool amend(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order,
+                   Price price, Quantity size, Timestamp now);
+        void cancel(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order, Timestamp now);
+        void send_cancel(OrderBookManager &order_books, SymbolId symbol, OrderId order_id, Timestamp now);
+    };
+
+} // namespace mm
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "types.hpp"
+#include "itch_parser.hpp"
+#include "position_tracker.hpp"
+#include <string>
+#include <vector>
+
+namespace mm
+{
+
+    /**
+     * Outcome of replaying one day file
+     */
+    struct DayReplayResult
+    {
+        std::string filename;
+        uintmax_t file_size;
+        bool success;
+        std::string error_message;
+        ITCHParser::Stats parser_stats;
+        PositionTracker::Stats position_stats;
+        size_t active_symbols;
+        size_t memory_usage_bytes;
+        double wall_time_ms;
+        size_t worker;
+    };
+
+    /**
+     * Merged report across all replayed days
+     */
+    struct ReplayReport
+    {
+        std::vector<DayReplayResult> days; // In input order
+        ITCHParser::Stats totals;
+        PnL total_realized_pnl;
+        PnL total_unrealized_pnl;
+        size_t failed_days;
+        size_t peak_memory_usage_bytes;
+        double makespan_ms;
+    };
+
+    /**
+     * Replays independent ITCH day files in parallel on a work-stealing pool.
+     * Each day gets its own OrderBookManager, PositionTracker and replay clock.
+     */
+    class MultiDayReplayDriver
+    {
+    public:
+        struct Config
+        {
+            size_t num_threads;        // 0 = hardware concurrency
+            size_t memory_cap_bytes;   // Per-day cap on book memory, 0 = none
+            size_t orders_per_book;    // Initial pool capacities for each day's books
+            size_t levels_per_book;
+            PositionLimits limits;
+
+            Config() : num_threads(0), memory_cap_bytes(0), orders_per_book(1024), levels_per_book(256) {}
+        };
+
+        explicit MultiDayReplayDriver(const Config &config = Config());
+        ~MultiDayReplayDriver() = default;
+
+        // Non-copyable, non-movable
+        MultiDayReplayDriver(const MultiDayReplayDriver &) = delete;
+        MultiDayReplayDriver &operator=(const MultiDayReplayDriver &) = delete;
+        MultiDayReplayDriver(MultiDayReplayDriver &&) = delete;
+        MultiDayReplayDriver &operator=(MultiDayReplayDriver &&) = delete;
+
+        /**
+         * Replay every file, largest first, and merge the results
+         */
+        ReplayReport run(const std::vector<std::string> &day_files);
+
+    private:
+        Config config_;
+
+        /**
+         * Replay a single day in isolation
+         */
+        DayReplayResult replay_day(const std::string &filename) const;
+    };
+
+} // namespace mm
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "types.hpp"
+#include <memory>
+
+namespace mm
+{
+
+    /**
+     * Outcome of a pre-trade check; the first failing check wins
+     */
+    enum class RiskCheck : uint8_t
+    {
+        PASSED = 0,
+        POSITION_LIMIT = 1,
+        PENDING_LIMIT = 2,
+        NOTIONAL_LIMIT = 3,
+        PRICE_BAND = 4,
+        ORDER_RATE = 5,
+        INVALID_SYMBOL = 6
+    };
+
+    /**
+     * Limits applied to every order before it reaches the book
+     */
+    struct RiskGateLimits
+    {
+        Quantity max_long_position;     // Position plus resting buys, if all filled
+        Quantity max_short_position;    // Same for the short side
+        Quantity max_pending_quantity;  // Resting quantity across both sides
+        PnL max_order_notional;         // price * quantity of a single order
+        Price max_price_deviation;      // Distance from the BBO mid
+        uint32_t max_orders_per_window; // Orders per symbol per rate window
+        Timestamp rate_window;          // Window length in ns
+
+        RiskGateLimits() : max_long_position(500000), max_short_position(500000), max_pending_quantity(100000),
+                           max_order_notional(price_from_dollars(1000000.0)), max_price_deviation(price_from_dollars(5.0)),
+                           max_orders_per_window(1000), rate_window(1000000000) {}
+    };
+
+    /**
+     * Everything the gate needs for one symbol, in one cache line
+     */
+    struct alignas(CACHE_LINE_SIZE) SymbolRiskState
+    {
+        int64_t position;
+        int64_t pending_buy;
+        int64_t pending_sell;
+        Price best_bid;
+        Price best_ask;
+        Timestamp window_start;
+        uint32_t window_orders;
+    };
+
+    static_assert(sizeof(SymbolRiskState) == CACHE_LINE_SIZE, "Risk state must fit one cache line");
+
+    /**
+     * Inline pre-trade risk gate for the order-entry path.
+     *
+     * Owned by one strategy thread: state is plain memory with no locks or
+     * atomics. The owner feeds it fills, cancels and BBO updates; check()
+     * evaluates every limit without early exits and reserves pending
+     * quantity and rate budget only when the order passes.
+     */
+    class PreTradeRiskGate
+    {
+    public:
+        explicit PreTradeRiskGate(const RiskGateLimits &limits = RiskGateLimits());
+        ~PreTradeRiskGate() = default;
+
+        // Non-copyable, non-movable
+        PreTradeRiskGate(const PreTradeRiskGate &) = delete;
+        PreTradeRiskGate &operator=(const PreTradeRiskGate &) = delete;
+        PreTradeRiskGate(PreTradeRiskGate &&) = delete;
+        PreTradeRiskGate &operator=(PreTradeRiskGate &&) = delete;
+
+        /**
+         * Check an order about to be sent and reserve its quantity if it passes
+         */
+        RiskCheck check(SymbolId symbol, Price price, Quantity quantity, OrderSide side, Timestamp now)
+        {
+            ++stats_.checks;
+            if (symbol >= MAX_SYMBOLS)
+            {
+                ++stats_.rejected;
+                return RiskCheck::INVALID_SYMBOL;
+            }
+
+            SymbolRiskState &s = states_[symbol];
+            const int64_t qty = quantity;
+            const int64_t buy_qty = side == OrderSide::BUY ? qty : 0;
+            const int64_t sell_qty = qty - buy_qty;
+
+            // Worst case: every resting order on the side fills
+            const int64_t long_exposure = s.position + s.pending_buy + buy_qty;
+            const int64_t short_exposure = s.pending_sell + sell_qty - s.position;
+
+            const Price mid = (s.best_bid + s.best_ask) / 2;
+            const Price deviation = price > mid ? price - mid : mid - price;
+            const bool have_bbo = (s.best_bid > 0) & (s.best_ask > 0);
+
+            const bool new_window = now - s.window_start >= limits_.rate_window;
+            const uint32_t window_orders = new_window ? 0 : s.window_orders;
+
+            const uint32_t failed =
+                static_cast<uint32_t>((long_exposure > static_cast<int64_t>(limits_.max_long_position)) |
+                                      (short_exposure > static_cast<int64_t>(limits_.max_short_position))) |
+                static_cast<uint32_t>(s.pending_buy + s.pending_sell + qty > static_cast<int64_t>(limits_.max_pending_quantity)) << 1 |
+                static_cast<uint32_t>(price * qty > limits_.max_order_notional) << 2 |
+                static_cast<uint32_t>(have_bbo & (deviation > limits_.max_price_deviation)) << 3 |
+                static_cast<uint32_t>(window_orders >= limits_.max_orders_per_window) << 4;
+
+            if (failed)
+            {
+                ++stats_.rejected;
+                return static_cast<RiskCheck>(__builtin_ctz(failed) + 1);
+            }
+
+            s.pending_buy += buy_qty;
+            s.pending_sell += sell_qty;
+            s.window_start = new_window ? now : s.window_start;
+            s.window_orders = window_orders + 1;
+            return RiskCheck::PASSED;
+        }
+
+        /**
+         * A resting order filled: move quantity from pending into position
+         */
+        void on_fill(SymbolId symbol, OrderSide side, Quantity quantity);
+
+        /**
+         * A resting order left the book unfilled: release its pending quantity
+         */
+        void on_cancel(SymbolId symbol, OrderSide side, Quantity quantity);
+
+        /**
+         * Latest best bid and ask, the reference for the price band
+         */
+        void update_bbo(SymbolId symbol, Price best_bid, Price best_ask);
+
+        /**
+         * Resynchronise the net position, e.g. from a tracker snapshot
+         */
+        void set_position(SymbolId symbol, int64_t net_position);
+
+        const SymbolRiskState &get_state(SymbolId symbol) const { return states_[symbol]; }
+        const RiskGateLimits &get_limits() const { return limits_; }
+
+        struct Stats
+        {
+            uint64_t checks;
+            uint64_t rejected;
+        };
+
+        const Stats &get_stats() const { return stats_; }
+
+        static const char *to_string(RiskCheck result);
+
+    private:
+        RiskGateLimits limits_;
+        Stats stats_;
+        std::unique_ptr<SymbolRiskState[]> states_; // Indexed by SymbolId
+    };
+
+} // namespace mm
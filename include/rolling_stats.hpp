@@ -0,0 +1,242 @@
+#pragma once
+
+#include "types.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace mm
+{
+
+    /**
+     * Exponentially weighted mean and variance of a stream. alpha is the
+     * weight of the newest sample; the first sample seeds the mean. O(1)
+     * per update and no history kept.
+     */
+    class EwmaStats
+    {
+    public:
+        // Throws std::invalid_argument unless 0 < alpha <= 1
+        explicit EwmaStats(double alpha = 0.05)
+            : alpha_(alpha), mean_(0), variance_(0), count_(0)
+        {
+            if (!(alpha > 0.0 && alpha <= 1.0))
+            {
+                throw std::invalid_argument("EWMA alpha must be in (0, 1]");
+            }
+        }
+
+        void update(double x)
+        {
+            if (count_++ == 0)
+            {
+                mean_ = x;
+                return;
+            }
+            double diff = x - mean_;
+            double increment = alpha_ * diff;
+            mean_ += increment;
+            variance_ = (1.0 - alpha_) * (variance_ + diff * increment);
+        }
+
+        double mean() const { return mean_; }
+        double variance() const { return variance_; }
+        double stddev() const { return std::sqrt(variance_); }
+        uint64_t count() const { return count_; }
+        double alpha() const { return alpha_; }
+
+        void reset()
+        {
+            mean_ = 0;
+            variance_ = 0;
+            count_ = 0;
+        }
+
+    private:
+        double alpha_;
+        double mean_;
+        double variance_;
+        uint64_t count_;
+    };
+
+    /**
+     * Sum, mean and variance of the last window samples, kept in a ring
+     * buffer. The oldest sample is subtracted as each new one is added, so
+     * an update is O(1). Sums are exact integers taken relative to the
+     * first sample, so they never drift; samples must stay within about
+     * 3e9 / sqrt(window) of it for the squares to fit 64 bits.
+     */
+    class RollingWindow
+    {
+    public:
+        // Throws std::invalid_argument if window is 0
+        explicit RollingWindow(size_t window)
+            : samples_(window), head_(0), size_(0), reference_(0), sum_(0), sum_squares_(0)
+        {
+            if (window == 0)
+            {
+                throw std::invalid_argument("Rolling window must hold at least one sample");
+            }
+        }
+
+        void push(int64_t x)
+        {
+            if (size_ == 0 && head_ == 0)
+            {
+                reference_ = x;
+            }
+            int64_t offset = x - reference_;
+            if (size_ == samples_.size())
+            {
+                int64_t oldest = samples_[head_];
+                sum_ -= oldest;
+                sum_squares_ -= oldest * oldest;
+            }
+            else
+            {
+                ++size_;
+            }
+            samples_[head_] = offset;
+            head_ = head_ + 1 == samples_.size() ? 0 : head_ + 1;
+            sum_ += offset;
+            sum_squares_ += offset * offset;
+        }
+
+        size_t size() const { return size_; }
+        size_t window() const { return samples_.size(); }
+        bool full() const { return size_ == samples_.size(); }
+
+        int64_t sum() const { return sum_ + reference_ * static_cast<int64_t>(size_); }
+        double mean() const { return size_ ? reference_ + double(sum_) / size_ : 0.0; }
+
+        // Population variance of the samples in the window
+        double variance() const
+        {
+            if (size_ == 0)
+            {
+                return 0.0;
+            }
+            double n = double(size_);
+            double variance = (double(sum_squares_) - double(sum_) * double(sum_) / n) / n;
+            return variance > 0.0 ? variance : 0.0;
+        }
+
+        double stddev() const { return std::sqrt(variance()); }
+
+        void reset()
+        {
+            head_ = 0;
+            size_ = 0;
+            sum_ = 0;
+            sum_squares_ = 0;
+        }
+
+    private:
+        std::vector<int64_t> samples_; // Offsets from reference_
+        size_t head_;                  // Next slot written, the oldest once full
+        size_t size_;
+        int64_t reference_;
+        int64_t sum_;
+        int64_t sum_squares_;
+    };
+
+    /**
+     * Minimum and maximum of the last window samples. Each side keeps a
+     * monotonic queue, in a ring buffer, of the samples that can still
+     * become the extreme; every sample enters and leaves each queue once,
+     * so an update is amortised O(1).
+     */
+    class RollingMinMax
+    {
+    public:
+        // Throws std::invalid_argument if window is 0
+        explicit RollingMinMax(size_t window)
+            : window_(window), max_(window), min_(window), count_(0)
+        {
+            if (window == 0)
+            {
+                throw std::invalid_argument("Rolling window must hold at least one sample");
+            }
+        }
+
+        void push(int64_t x)
+        {
+            uint64_t sequence = count_++;
+            max_.push(sequence, x, window_, [](int64_t kept, int64_t newest) { return kept > newest; });
+            min_.push(sequence, x, window_, [](int64_t kept, int64_t newest) { return kept < newest; });
+        }
+
+        // Extremes of the window; 0 before the first sample
+        int64_t max() const { return max_.front(); }
+        int64_t min() const { return min_.front(); }
+
+        size_t size() const { return count_ < window_ ? static_cast<size_t>(count_) : window_; }
+        size_t window() const { return window_; }
+
+        void reset()
+        {
+            max_.clear();
+            min_.clear();
+            count_ = 0;
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t sequence;
+            int64_t value;
+        };
+
+        // Samples in arrival order, each strictly less extreme than the one
+        // before it, so the front is the window's extreme; never holds more
+        // than the window
+        class MonotonicQueue
+        {
+        public:
+            explicit MonotonicQueue(size_t capacity) : entries_(capacity), head_(0), size_(0) {}
+
+            template <typename Keeps>
+            void push(uint64_t sequence, int64_t x, size_t window, Keeps keeps)
+            {
+                if (size_ && entries_[head_].sequence + window <= sequence)
+                {
+                    head_ = next(head_);
+                    --size_;
+                }
+                while (size_ && !keeps(entries_[back()].value, x))
+                {
+                    --size_;
+                }
+                entries_[slot(size_)] = Entry{sequence, x};
+                ++size_;
+            }
+
+            int64_t front() const { return size_ ? entries_[head_].value : 0; }
+
+            void clear()
+            {
+                head_ = 0;
+                size_ = 0;
+            }
+
+        private:
+            std::vector<Entry> entries_;
+            size_t head_;
+            size_t size_;
+
+            size_t next(size_t i) const { return i + 1 == entries_.size() ? 0 : i + 1; }
+            size_t slot(size_t offset) const
+            {
+                size_t i = head_ + offset;
+                return i >= entries_.size() ? i - entries_.size() : i;
+            }
+            size_t back() const { return slot(size_ - 1); }
+        };
+
+        size_t window_;
+        MonotonicQueue max_;
+        MonotonicQueue min_;
+        uint64_t count_;
+    };
+
+} // namespace mm
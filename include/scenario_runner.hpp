@@ -3,6 +3,7 @@
 #include "types.hpp"
 #include "order_book.hpp"
 #include "position_tracker.hpp"
+#include "clock.hpp"
 #include <string>
 #include <vector>
 #include <map>
@@ -127,6 +128,9 @@ namespace mm
         Stats stats_;
         bool matching_enabled_;
 
+        // Scenario files carry no times; commands are stamped by line number
+        EngineClock clock_;
+
         /**
          * Parse scenario file into commands
          */
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace mm
+{
+
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    // Test-and-test-and-set lock for short critical sections on the write path
+    class SpinLock
+    {
+    public:
+        SpinLock() : locked_(false) {}
+
+        SpinLock(const SpinLock &) = delete;
+        SpinLock &operator=(const SpinLock &) = delete;
+
+        void lock()
+        {
+            while (locked_.exchange(true, std::memory_order_acquire))
+            {
+                while (locked_.load(std::memory_order_relaxed))
+                {
+                    cpu_relax();
+                }
+            }
+        }
+
+        bool try_lock() { return !locked_.exchange(true, std::memory_order_acquire); }
+        void unlock() { locked_.store(false, std::memory_order_release); }
+
+    private:
+        std::atomic<bool> locked_;
+    };
+
+    /**
+     * Sequence lock around a trivially copyable value.
+     *
+     * One writer at a time (callers serialise writers); readers copy the value
+     * and retry if the sequence moved, so they never block the writer. The
+     * sequence is odd while a write is in progress and advances by two per write.
+     */
+    template <typename T>
+    class Seqlock
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied with memcpy");
+
+    public:
+        Seqlock() : seq_(0), value_() {}
+
+        Seqlock(const Seqlock &) = delete;
+        Seqlock &operator=(const Seqlock &) = delete;
+
+        bool try_load(T &out) const
+        {
+            uint64_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                return false;
+            }
+            copy_to(out);
+            return validate(before);
+        }
+
+        // Optimistic read in three steps, for readers spanning several seqlocks:
+        // begin_read() waits out any writer, copy_to() copies, and validate()
+        // confirms no write overlapped the copy
+        uint64_t begin_read() const
+        {
+            uint64_t seq;
+            while ((seq = seq_.load(std::memory_order_acquire)) & 1)
+            {
+                cpu_relax();
+            }
+            return seq;
+        }
+
+        void copy_to(T &out) const
+        {
+            std::memcpy(static_cast<void *>(&out), static_cast<const void *>(&value_), sizeof(T));
+        }
+
+        bool validate(uint64_t seq) const
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return seq_.load(std::memory_order_relaxed) == seq;
+        }
+
+        T load() const
+        {
+            T out;
+            while (!try_load(out))
+            {
+                cpu_relax();
+            }
+            return out;
+        }
+
+        // Writer side: mutate in place between the two sequence bumps
+        template <typename Fn>
+        void write(Fn &&fn)
+        {
+            uint64_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            fn(value_);
+            seq_.store(seq + 2, std::memory_order_release);
+        }
+
+        void store(const T &value)
+        {
+            write([&](T &v)
+                  { std::memcpy(static_cast<void *>(&v), static_cast<const void *>(&value), sizeof(T)); });
+        }
+
+        // Number of completed writes
+        uint64_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+        // Only valid on the writer side, with writers serialised
+        const T &writer_value() const { return value_; }
+
+    private:
+        std::atomic<uint64_t> seq_;
+        T value_;
+    };
+
+} // namespace mm
@@ -3,14 +3,19 @@
 #include "types.hpp"
 #include "order_book.hpp"
 #include "position_tracker.hpp"
-#include <array>
+#include "risk_gate.hpp"
+#include "quote_manager.hpp"
+#include "quote_kernel.hpp"
+#include "rolling_stats.hpp"
 #include <cstddef>
+#include <vector>
 
 namespace mm
 {
 
-    // Maximum number of symbols supported by strategies
-    constexpr size_t MAX_STRATEGY_SYMBOLS = 16;
+    // Throws std::invalid_argument if a configured symbol is past MAX_SYMBOLS,
+    // where the dense BBO arrays strategies quote from end
+    void validate_strategy_symbols(const std::vector<SymbolId> &symbols);
 
     // MarketMakingStrategy interface
     class MarketMakingStrategy
@@ -21,11 +26,43 @@ namespace mm
         // Called to update quotes for all symbols
         virtual void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) = 0;
 
+        // Called by StrategyDispatcher for one symbol whose best bid/ask moved or that filled;
+        // slot is the symbol's index in symbol_at()
+        virtual void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                                    PositionTracker &positions, Timestamp now) = 0;
+
+        // Called by StrategyDispatcher once per dispatch that made any on_book_update() call,
+        // so strategies can defer per-symbol work and do it for every updated symbol at once
+        virtual void on_dispatch_end(OrderBookManager &, PositionTracker &, Timestamp) {}
+
+        // Symbols the strategy quotes
+        virtual size_t symbol_count() const = 0;
+        virtual SymbolId symbol_at(size_t slot) const = 0;
+
         // Called to notify strategy of a trade
         virtual void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) = 0;
 
         // Called to notify strategy of a position or P&L update
         virtual void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) = 0;
+
+        // Route order entry through a pre-trade risk gate owned by the strategy's thread
+        void set_risk_gate(PreTradeRiskGate *gate) { quotes_.set_risk_gate(gate); }
+
+        // Send orders to a backtest fill simulator instead of the order book
+        void set_fill_simulator(QueueFillSimulator *simulator) { quotes_.set_fill_simulator(simulator); }
+
+        // Order entry counts since construction
+        const QuoteManager::Stats &get_quote_stats() const { return quotes_.get_stats(); }
+
+    protected:
+        explicit MarketMakingStrategy(OrderId first_order_id, const QuoteManagerConfig &quoting)
+            : quotes_(first_order_id, quoting) {}
+
+        // Working orders; update_quotes() hands it targets and it sends only what changed
+        QuoteManager quotes_;
+
+        // Forward one of our fills to the quote manager (and through it the risk gate)
+        void on_quote_fill(SymbolId symbol, OrderSide side, Quantity qty) { quotes_.on_fill(symbol, side, qty); }
     };
 
     // Fixed spread market making strategy
@@ -37,30 +74,27 @@ namespace mm
             Price base_price;
             Price spread;
             Quantity quote_size;
-            size_t num_symbols;
-            std::array<SymbolId, MAX_STRATEGY_SYMBOLS> symbols;
+            std::vector<SymbolId> symbols;
+            QuoteManagerConfig quoting;
         };
 
         explicit FixedSpreadStrategy(const Config &cfg);
         void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override;
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now) override;
+        size_t symbol_count() const override { return config_.symbols.size(); }
+        SymbolId symbol_at(size_t slot) const override { return config_.symbols[slot]; }
         void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) override;
         void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) override;
 
     private:
         Config config_;
-        // Pre-allocated state for each symbol
-        struct SymbolState
-        {
-            OrderId bid_order_id;
-            OrderId ask_order_id;
-            Price last_bid;
-            Price last_ask;
-            Quantity last_qty;
-        };
-        std::array<SymbolState, MAX_STRATEGY_SYMBOLS> state_;
+
+        void quote(OrderBookManager &order_books, size_t slot, Timestamp now);
     };
 
-    // Inventory-skewed market making strategy
+    // Inventory-skewed market making strategy; quotes for every symbol updated
+    // in a dispatch are computed together by skewed_quote_kernel
     class InventorySkewedStrategy : public MarketMakingStrategy
     {
     public:
@@ -71,27 +105,149 @@ namespace mm
             Price max_spread;
             Quantity quote_size;
             Quantity max_inventory;
-            size_t num_symbols;
-            std::array<SymbolId, MAX_STRATEGY_SYMBOLS> symbols;
+            std::vector<SymbolId> symbols;
+            QuoteManagerConfig quoting;
         };
 
         explicit InventorySkewedStrategy(const Config &cfg);
         void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override;
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now) override;
+        void on_dispatch_end(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override;
+        size_t symbol_count() const override { return config_.symbols.size(); }
+        SymbolId symbol_at(size_t slot) const override { return config_.symbols[slot]; }
         void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) override;
         void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) override;
 
+        // Fair value that quotes are skewed around; starts at base_price
+        void set_fair_value(size_t slot, Price fair_value) { fair_value_[slot] = fair_value; }
+
     private:
         Config config_;
-        struct SymbolState
+        SkewedQuoteParams params_;
+
+        // Per-symbol state by slot, one array per field, sized at construction
+        std::vector<Price> fair_value_;
+        std::vector<int64_t> inventory_;
+        std::vector<Price> bid_;
+        std::vector<Price> ask_;
+        std::vector<uint8_t> dirty_;
+
+        // Slots updated in the current dispatch, and their inputs and
+        // quotes gathered contiguously for the kernel
+        std::vector<uint32_t> dirty_slots_;
+        std::vector<Price> batch_fair_value_;
+        std::vector<int64_t> batch_inventory_;
+        std::vector<Price> batch_bid_;
+        std::vector<Price> batch_ask_;
+
+        std::vector<Position> snapshot_;
+    };
+
+    // StrategyType::ADAPTIVE_SPREAD: quotes around the mid with a spread that
+    // widens with the EWMA volatility of mid changes
+    class AdaptiveSpreadStrategy : public MarketMakingStrategy
+    {
+    public:
+        struct Config
         {
-            OrderId bid_order_id;
-            OrderId ask_order_id;
-            Price last_bid;
-            Price last_ask;
-            Quantity last_qty;
-            Quantity inventory;
+            Price base_price; // Fair value until a symbol's book is two-sided
+            Price min_spread;
+            Price max_spread;
+            double volatility_multiplier; // Spread added per unit of mid-change stddev
+            double ewma_alpha;
+            Quantity quote_size;
+            std::vector<SymbolId> symbols;
+            QuoteManagerConfig quoting;
         };
-        std::array<SymbolState, MAX_STRATEGY_SYMBOLS> state_;
+
+        explicit AdaptiveSpreadStrategy(const Config &cfg);
+        void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override;
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now) override;
+        size_t symbol_count() const override { return config_.symbols.size(); }
+        SymbolId symbol_at(size_t slot) const override { return config_.symbols[slot]; }
+        void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) override;
+        void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) override;
+
+        Price get_spread(size_t slot) const;
+
+    private:
+        Config config_;
+        std::vector<Price> mid_; // Last two-sided mid by slot, 0 = none yet
+        std::vector<EwmaStats> volatility_;
+
+        void quote(OrderBookManager &order_books, size_t slot, const BestBidOffer &bbo, Timestamp now);
+    };
+
+    // StrategyType::MEAN_REVERSION: leans its quotes from the mid toward the
+    // mean of the last window mids
+    class MeanReversionStrategy : public MarketMakingStrategy
+    {
+    public:
+        struct Config
+        {
+            Price base_price; // Fair value until a symbol's book is two-sided
+            Price spread;
+            size_t window;    // Mids averaged
+            double reversion; // 0 = quote the mid, 1 = quote the rolling mean
+            Quantity quote_size;
+            std::vector<SymbolId> symbols;
+            QuoteManagerConfig quoting;
+        };
+
+        explicit MeanReversionStrategy(const Config &cfg);
+        void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override;
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now) override;
+        size_t symbol_count() const override { return config_.symbols.size(); }
+        SymbolId symbol_at(size_t slot) const override { return config_.symbols[slot]; }
+        void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) override;
+        void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) override;
+
+        Price get_fair_value(size_t slot) const { return fair_value_[slot]; }
+
+    private:
+        Config config_;
+        std::vector<Price> fair_value_;
+        std::vector<RollingWindow> mids_;
+
+        void quote(OrderBookManager &order_books, size_t slot, const BestBidOffer &bbo, Timestamp now);
+    };
+
+    // StrategyType::MOMENTUM: shifts its quotes by skew in the direction of a
+    // breakout, when the mid makes a new high or low of the last window mids
+    class MomentumStrategy : public MarketMakingStrategy
+    {
+    public:
+        struct Config
+        {
+            Price base_price; // Fair value until a symbol's book is two-sided
+            Price spread;
+            size_t window; // Mids the breakout range covers
+            Price skew;
+            Quantity quote_size;
+            std::vector<SymbolId> symbols;
+            QuoteManagerConfig quoting;
+        };
+
+        explicit MomentumStrategy(const Config &cfg);
+        void update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now) override;
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &positions, Timestamp now) override;
+        size_t symbol_count() const override { return config_.symbols.size(); }
+        SymbolId symbol_at(size_t slot) const override { return config_.symbols[slot]; }
+        void on_trade(SymbolId symbol, Price price, Quantity qty, OrderSide side, Timestamp now) override;
+        void on_position_update(SymbolId symbol, const Position &pos, const PositionTracker::Stats &stats, Timestamp now) override;
+
+        Price get_fair_value(size_t slot) const { return fair_value_[slot]; }
+
+    private:
+        Config config_;
+        std::vector<Price> fair_value_;
+        std::vector<RollingMinMax> ranges_;
+
+        void quote(OrderBookManager &order_books, size_t slot, const BestBidOffer &bbo, Timestamp now);
     };
 
 } // namespace mm
\ No newline at end of file
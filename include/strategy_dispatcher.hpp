@@ -0,0 +1,115 @@
+#pragma once
+
+#include "types.hpp"
+#include "order_book.hpp"
+#include <memory>
+#include <vector>
+
+namespace mm
+{
+
+    class MarketMakingStrategy;
+    class PositionTracker;
+
+    /**
+     * Calls strategies only for symbols whose top of book moved or that
+     * filled, instead of every strategy re-quoting its whole universe.
+     *
+     * The feed side marks symbols touched by a packet (and fills mark
+     * theirs); dispatch(), once per packet, compares each touched symbol's
+     * best bid/ask in the books' dense BBO arrays with what was last
+     * dispatched and calls on_book_update() on the subscribed strategies of
+     * the ones that changed, then on_dispatch_end() on every strategy. Work
+     * per packet is proportional to the symbols it touched, not to the
+     * number of symbols quoted.
+     *
+     * Single-threaded: owned by the thread that applies the feed.
+     */
+    class StrategyDispatcher
+    {
+    public:
+        StrategyDispatcher();
+        ~StrategyDispatcher() = default;
+
+        // Non-copyable, non-movable
+        StrategyDispatcher(const StrategyDispatcher &) = delete;
+        StrategyDispatcher &operator=(const StrategyDispatcher &) = delete;
+        StrategyDispatcher(StrategyDispatcher &&) = delete;
+        StrategyDispatcher &operator=(StrategyDispatcher &&) = delete;
+
+        /**
+         * Subscribe a strategy to every symbol it quotes; allocates, so
+         * call during setup
+         */
+        void add_strategy(MarketMakingStrategy *strategy);
+
+        /**
+         * The symbol's book changed; dispatched only if its BBO moved.
+         * Symbols no strategy quotes are ignored.
+         */
+        void touch(SymbolId symbol)
+        {
+            if (symbol < MAX_SYMBOLS && dirty_[symbol] == CLEAN && first_subscription_[symbol] != NO_SUBSCRIPTION)
+            {
+                dirty_[symbol] = TOUCHED;
+                pending_.push_back(symbol);
+            }
+        }
+
+        /**
+         * Touch every symbol a feed packet updated
+         */
+        void touch(const BookUpdate *updates, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                touch(updates[i].symbol);
+            }
+        }
+
+        /**
+         * One of our orders filled: forward it to the symbol's strategies
+         * and dispatch the symbol even if its BBO did not move
+         */
+        void on_fill(SymbolId symbol, Price price, Quantity quantity, OrderSide side, Timestamp now);
+
+        /**
+         * Call changed symbols' strategies; returns the number of calls
+         */
+        size_t dispatch(OrderBookManager &order_books, PositionTracker &positions, Timestamp now);
+
+        struct Stats
+        {
+            uint64_t dispatches; // dispatch() calls
+            uint64_t touched;    // Symbols examined
+            uint64_t changed;    // Symbols whose BBO moved or that filled
+            uint64_t callbacks;  // on_book_update() calls
+        };
+
+        const Stats &get_stats() const { return stats_; }
+
+    private:
+        static constexpr uint8_t CLEAN = 0;
+        static constexpr uint8_t TOUCHED = 1;
+        static constexpr uint8_t FILLED = 2;
+        static constexpr uint32_t NO_SUBSCRIPTION = UINT32_MAX;
+
+        // Subscriptions of one symbol form a chain through next
+        struct Subscription
+        {
+            MarketMakingStrategy *strategy;
+            uint32_t slot;
+            uint32_t next;
+        };
+
+        std::vector<MarketMakingStrategy *> strategies_;
+        std::vector<Subscription> subscriptions_;
+        std::unique_ptr<uint32_t[]> first_subscription_; // Indexed by SymbolId
+        std::unique_ptr<BestBidOffer[]> dispatched_;     // BBO as of the last callback, by SymbolId
+        std::unique_ptr<uint8_t[]> dirty_;               // CLEAN, TOUCHED or FILLED, by SymbolId
+        std::vector<SymbolId> pending_;                  // Symbols whose dirty_ is set
+        std::vector<SymbolId> changed_;                  // Symbols dispatched this round
+        Stats stats_;
+    };
+
+} // namespace mm
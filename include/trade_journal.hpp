@@ -0,0 +1,189 @@
+#pragma once
+
+#include "types.hpp"
+#include "seqlock.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+namespace mm
+{
+
+    /**
+     * Trade record for P&L calculation
+     */
+    struct Trade
+    {
+        SymbolId symbol;
+        Price price;
+        Quantity quantity;
+        OrderSide side;
+        Timestamp timestamp;
+        OrderId order_id;
+        uint64_t sequence; // Global record order, assigned by the journal
+
+        Trade() : symbol(0), price(0), quantity(0), side(OrderSide::BUY), timestamp(0), order_id(0), sequence(0) {}
+        Trade(SymbolId s, Price p, Quantity q, OrderSide sd, OrderId oid, Timestamp ts)
+            : symbol(s), price(p), quantity(q), side(sd), timestamp(ts), order_id(oid), sequence(0) {}
+    };
+
+    /**
+     * Append-only trade log of fixed-size records in memory-mapped segments.
+     *
+     * Records are addressed by a global index, which append() also stamps
+     * into the record as its sequence number. The log keeps a fixed ring of
+     * mapped segments: a background thread maps the next segment ahead of the
+     * writer and unmaps the oldest, so append() is a copy into already-faulted
+     * memory. With a directory each segment is a file that stays on disk after
+     * it leaves the ring; without one the segments are anonymous memory.
+     * File numbers continue after the highest segment already in the
+     * directory, so a restarted engine never overwrites an earlier run's
+     * segments; an existing file is refused rather than reused.
+     */
+    class TradeJournal
+    {
+    public:
+        struct Config
+        {
+            std::string directory;      // Empty = anonymous memory
+            size_t records_per_segment;
+            size_t segments;            // Mapped ring size including the spare, at least 2
+
+            Config() : records_per_segment(1 << 14), segments(4) {}
+        };
+
+        explicit TradeJournal(const Config &config = Config());
+        ~TradeJournal();
+
+        // Non-copyable, non-movable
+        TradeJournal(const TradeJournal &) = delete;
+        TradeJournal &operator=(const TradeJournal &) = delete;
+        TradeJournal(TradeJournal &&) = delete;
+        TradeJournal &operator=(TradeJournal &&) = delete;
+
+        /**
+         * Append a trade and return its index. Appends are serialised, so
+         * indices follow record order across all symbols.
+         */
+        uint64_t append(const Trade &trade);
+
+        /**
+         * Number of records appended so far
+         */
+        uint64_t size() const { return committed_.load(std::memory_order_acquire); }
+
+        /**
+         * Oldest index still readable
+         */
+        uint64_t first_available() const;
+
+        /**
+         * Hide everything appended so far from readers
+         */
+        void trim() { floor_.store(size(), std::memory_order_release); }
+
+        /**
+         * Visit readable records in [from, to) in index order. Records are
+         * copied out READ_CHUNK at a time under the segment lock and fn runs
+         * on the copies with the lock released, so a slow reader never holds
+         * up a remap on the fill path.
+         */
+        template <typename Fn>
+        void for_each(uint64_t from, uint64_t to, Fn &&fn) const
+        {
+            Trade chunk[READ_CHUNK];
+            uint64_t indices[READ_CHUNK];
+            to = std::min(to, size());
+            while (from < to)
+            {
+                size_t copied = 0;
+                {
+                    std::shared_lock<std::shared_mutex> lock(segments_mutex_);
+                    from = std::max(from, first_available());
+                    uint64_t end = std::min(to, from + READ_CHUNK);
+                    for (uint64_t index = from; index < end; ++index)
+                    {
+                        const Segment &segment = segments_[(index / records_per_segment_) % num_segments_];
+                        if (segment.number.load(std::memory_order_acquire) == index / records_per_segment_)
+                        {
+                            indices[copied] = index;
+                            chunk[copied++] = segment.records[index % records_per_segment_];
+                        }
+                    }
+                    from = std::max(from, end);
+                }
+                for (size_t i = 0; i < copied; ++i)
+                {
+                    fn(indices[i], chunk[i]);
+                }
+            }
+        }
+
+        /**
+         * Copy up to max readable records starting at index from; returns the
+         * number copied
+         */
+        size_t read(uint64_t from, Trade *out, size_t max) const
+        {
+            size_t copied = 0;
+            from = std::max(from, first_available());
+            for_each(from, from + max, [&](uint64_t, const Trade &trade)
+                     { out[copied++] = trade; });
+            return copied;
+        }
+
+        size_t records_per_segment() const { return records_per_segment_; }
+        size_t mapped_bytes() const { return num_segments_ * records_per_segment_ * sizeof(Trade); }
+
+    private:
+        static constexpr size_t READ_CHUNK = 256; // Records copied per hold of segments_mutex_
+
+        struct Segment
+        {
+            std::atomic<uint64_t> number; // Segment held in this slot, ~0 if none
+            Trade *records;
+
+            Segment() : number(~0ull), records(nullptr) {}
+        };
+
+        std::string directory_;
+        uint64_t first_file_; // File number of segment 0
+        size_t records_per_segment_;
+        size_t num_segments_;
+        std::unique_ptr<Segment[]> segments_;
+        mutable std::shared_mutex segments_mutex_; // Readers vs remapping
+
+        // Writer state, touched only under append_lock_
+        alignas(CACHE_LINE_SIZE) SpinLock append_lock_;
+        uint64_t next_index_;
+        Trade *current_;
+        std::atomic<uint64_t> committed_;
+        std::atomic<uint64_t> floor_;
+
+        // Background preparation of the next segment
+        std::mutex prepare_mutex_;
+        std::condition_variable prepare_cv_;
+        uint64_t wanted_segment_;
+        bool stop_;
+        std::thread preparer_;
+
+        /**
+         * Map segment number into its ring slot, evicting the previous occupant
+         */
+        void prepare(uint64_t number);
+
+        /**
+         * Switch the writer to segment number, mapping it here if the
+         * background thread has not got to it yet
+         */
+        void rotate(uint64_t number);
+
+        void preparer_loop();
+    };
+
+} // namespace mm
@@ -0,0 +1,42 @@
+#include "clock.hpp"
+#include <chrono>
+
+namespace mm
+{
+
+    namespace
+    {
+        // Spin against steady_clock once per process to get the TSC rate
+        double calibrate_ns_per_tick()
+        {
+#if MM_HAS_TSC
+            using clock = std::chrono::steady_clock;
+            auto start = clock::now();
+            uint64_t tsc_start = __rdtsc();
+            while (clock::now() - start < std::chrono::milliseconds(5))
+            {
+            }
+            uint64_t tsc_end = __rdtsc();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+            return tsc_end > tsc_start ? static_cast<double>(elapsed) / static_cast<double>(tsc_end - tsc_start) : 1.0;
+#else
+            return 1.0;
+#endif
+        }
+    }
+
+    EngineClock::EngineClock(ClockMode mode)
+        : mode_(mode), replay_now_(0), tsc_base_(0), ns_base_(0), ns_per_tick_(1.0)
+    {
+        if (mode_ == ClockMode::LIVE)
+        {
+            static const double ns_per_tick = calibrate_ns_per_tick();
+            ns_per_tick_ = ns_per_tick;
+#if MM_HAS_TSC
+            tsc_base_ = __rdtsc();
+#endif
+            ns_base_ = get_timestamp();
+        }
+    }
+
+}
@@ -0,0 +1,104 @@
+#include "equity_curve.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace mm
+{
+
+    namespace
+    {
+        constexpr Timestamp NANOS_PER_SECOND = 1000000000ull;
+        constexpr Timestamp NANOS_PER_MINUTE = 60 * NANOS_PER_SECOND;
+    }
+
+    EquityCurve::EquityCurve(const Config &config)
+        : seconds_(config.second_buckets, NANOS_PER_SECOND), minutes_(config.minute_buckets, NANOS_PER_MINUTE), peak_(0)
+    {
+    }
+
+    void EquityCurve::sample(PnL equity, Timestamp now)
+    {
+        DrawdownStats stats = drawdown_.writer_value();
+        stats.equity = equity;
+        if (stats.samples == 0 || equity > stats.peak)
+        {
+            // The curve starts flat, so a first sample below 0 is already a drawdown
+            stats.peak = std::max<PnL>(equity, 0);
+            stats.peak_time = now;
+        }
+        stats.drawdown = stats.peak - equity;
+        if (stats.drawdown > stats.max_drawdown)
+        {
+            stats.max_drawdown = stats.drawdown;
+            stats.max_drawdown_time = now;
+        }
+        ++stats.samples;
+
+        drawdown_.store(stats);
+        peak_.store(stats.peak, std::memory_order_relaxed);
+        seconds_.sample(equity, stats.drawdown, now);
+        minutes_.sample(equity, stats.drawdown, now);
+    }
+
+    void EquityCurve::reset()
+    {
+        drawdown_.store(DrawdownStats{});
+        peak_.store(0, std::memory_order_relaxed);
+        seconds_.reset();
+        minutes_.reset();
+    }
+
+    EquityCurve::Ring::Ring(size_t capacity, Timestamp width)
+        : buckets_(std::make_unique<Seqlock<EquityBucket>[]>(capacity)), capacity_(capacity), width_(width), opened_(0)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("Equity curve needs at least one bucket");
+        }
+    }
+
+    void EquityCurve::Ring::sample(PnL equity, PnL drawdown, Timestamp now)
+    {
+        Timestamp start = now - now % width_;
+        uint64_t opened = opened_.load(std::memory_order_relaxed);
+        Seqlock<EquityBucket> &newest = buckets_[(opened + capacity_ - 1) % capacity_];
+
+        if (opened > 0 && newest.writer_value().start == start)
+        {
+            newest.write([&](EquityBucket &bucket)
+                         {
+                bucket.high = std::max(bucket.high, equity);
+                bucket.low = std::min(bucket.low, equity);
+                bucket.close = equity;
+                bucket.max_drawdown = std::max(bucket.max_drawdown, drawdown);
+                ++bucket.samples; });
+            return;
+        }
+
+        buckets_[opened % capacity_].store(EquityBucket{start, equity, equity, equity, equity, drawdown, 1});
+        opened_.store(opened + 1, std::memory_order_release);
+    }
+
+    size_t EquityCurve::Ring::copy_to(EquityBucket *out, size_t max) const
+    {
+        uint64_t opened = opened_.load(std::memory_order_acquire);
+        uint64_t first = opened - std::min<uint64_t>({opened, capacity_, max});
+        for (uint64_t i = first; i < opened; ++i)
+        {
+            out[i - first] = buckets_[i % capacity_].load();
+        }
+
+        // Buckets the writer wrapped onto while we copied now hold newer data
+        uint64_t now_opened = opened_.load(std::memory_order_acquire);
+        uint64_t oldest_intact = now_opened > capacity_ ? now_opened - capacity_ : 0;
+        uint64_t stale = std::min(std::max(oldest_intact, first), opened) - first;
+        std::copy(out + stale, out + (opened - first), out);
+        return static_cast<size_t>(opened - first - stale);
+    }
+
+    void EquityCurve::Ring::reset()
+    {
+        opened_.store(0, std::memory_order_release);
+    }
+
+}
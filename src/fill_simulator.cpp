@@ -0,0 +1,236 @@
+#include "fill_simulator.hpp"
+#include <algorithm>
+
+namespace mm
+{
+
+    QueueFillSimulator::QueueFillSimulator(OrderBookManager &market)
+        : market_(market), first_order_(std::make_unique<uint32_t[]>(MAX_SYMBOLS)), stats_{0, 0, 0, 0, 0}
+    {
+        std::fill(first_order_.get(), first_order_.get() + MAX_SYMBOLS, NONE);
+    }
+
+    bool QueueFillSimulator::add_order(SymbolId symbol, OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now)
+    {
+        if (symbol >= MAX_SYMBOLS || quantity == 0 || index_.count(order_id))
+        {
+            return false;
+        }
+
+        uint32_t index;
+        if (free_.empty())
+        {
+            index = static_cast<uint32_t>(orders_.size());
+            orders_.emplace_back();
+        }
+        else
+        {
+            index = free_.back();
+            free_.pop_back();
+        }
+
+        SimOrder &order = orders_[index];
+        order = SimOrder{order_id, price, quantity, 0, 0, 0, symbol, side, NONE, first_order_[symbol]};
+        join_queue(order, now);
+        if (order.next != NONE)
+        {
+            orders_[order.next].prev = index;
+        }
+        first_order_[symbol] = index;
+        index_.emplace(order_id, index);
+        stats_.working_orders = index_.size();
+        return true;
+    }
+
+    bool QueueFillSimulator::cancel_order(SymbolId symbol, OrderId order_id, Timestamp)
+    {
+        auto it = index_.find(order_id);
+        if (it == index_.end() || orders_[it->second].symbol != symbol)
+        {
+            return false;
+        }
+        remove(it->second);
+        return true;
+    }
+
+    bool QueueFillSimulator::modify_order(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity, Timestamp now)
+    {
+        auto it = index_.find(order_id);
+        if (it == index_.end() || orders_[it->second].symbol != symbol)
+        {
+            return false;
+        }
+
+        SimOrder &order = orders_[it->second];
+        if (new_quantity <= order.filled)
+        {
+            remove(it->second);
+            return true;
+        }
+
+        bool keeps_priority = new_price == order.price && new_quantity <= order.quantity;
+        order.price = new_price;
+        order.quantity = new_quantity;
+        if (!keeps_priority)
+        {
+            join_queue(order, now);
+        }
+        return true;
+    }
+
+    Quantity QueueFillSimulator::get_queue_ahead(OrderId order_id) const
+    {
+        auto it = index_.find(order_id);
+        return it != index_.end() ? orders_[it->second].ahead : 0;
+    }
+
+    size_t QueueFillSimulator::apply(const BookUpdate *updates, size_t count)
+    {
+        size_t applied = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const BookUpdate &update = updates[i];
+            ++stats_.feed_events;
+            if (update.symbol < MAX_SYMBOLS && first_order_[update.symbol] != NONE)
+            {
+                ++stats_.tracked_events;
+                on_market_event(update);
+            }
+            applied += market_.apply(&update, 1);
+        }
+        return applied;
+    }
+
+    // Back of the queue at the order's price: everything resting there now
+    // is ahead of it
+    void QueueFillSimulator::join_queue(SimOrder &order, Timestamp now)
+    {
+        const OrderBook *book = static_cast<const OrderBookManager &>(market_).get_order_book(order.symbol);
+        order.ahead = book ? book->get_level_quantity(order.price, order.side) : 0;
+        order.joined = now;
+    }
+
+    void QueueFillSimulator::fill(uint32_t index, Quantity quantity, Timestamp now)
+    {
+        SimOrder &order = orders_[index];
+        quantity = std::min(quantity, order.remaining());
+        if (quantity == 0)
+        {
+            return;
+        }
+        order.filled += quantity;
+        fills_.push_back(SimulatedFill{order.order_id, order.symbol, order.side, order.price, quantity, now});
+        ++stats_.fills;
+        stats_.filled_quantity += quantity;
+        if (order.remaining() == 0)
+        {
+            remove(index);
+        }
+    }
+
+    void QueueFillSimulator::remove(uint32_t index)
+    {
+        SimOrder &order = orders_[index];
+        if (order.prev != NONE)
+        {
+            orders_[order.prev].next = order.next;
+        }
+        else
+        {
+            first_order_[order.symbol] = order.next;
+        }
+        if (order.next != NONE)
+        {
+            orders_[order.next].prev = order.prev;
+        }
+        index_.erase(order.order_id);
+        free_.push_back(index);
+        stats_.working_orders = index_.size();
+    }
+
+    // Called before the update reaches the market book, while the order it
+    // refers to can still be looked up
+    void QueueFillSimulator::on_market_event(const BookUpdate &update)
+    {
+        uint32_t index = first_order_[update.symbol];
+
+        if (update.type == BookUpdateType::ADD)
+        {
+            // A new order at or through our price on the other side would
+            // have traded with us instead of resting: it takes our best
+            // prices first, earlier joins first within a price, until its
+            // quantity runs out
+            crossing_.clear();
+            for (; index != NONE; index = orders_[index].next)
+            {
+                const SimOrder &order = orders_[index];
+                bool crosses = update.side == OrderSide::BUY
+                                   ? order.side == OrderSide::SELL && update.price >= order.price
+                                   : order.side == OrderSide::BUY && update.price <= order.price;
+                if (crosses)
+                {
+                    crossing_.push_back(index);
+                }
+            }
+            std::sort(crossing_.begin(), crossing_.end(), [this](uint32_t a, uint32_t b)
+                      {
+                const SimOrder &x = orders_[a];
+                const SimOrder &y = orders_[b];
+                if (x.price != y.price)
+                {
+                    return x.side == OrderSide::BUY ? x.price > y.price : x.price < y.price;
+                }
+                return x.joined != y.joined ? x.joined < y.joined : x.order_id < y.order_id; });
+
+            Quantity incoming = update.quantity;
+            for (uint32_t crossed : crossing_)
+            {
+                if (incoming == 0)
+                {
+                    break;
+                }
+                Quantity quantity = std::min(incoming, orders_[crossed].remaining());
+                fill(crossed, quantity, update.timestamp);
+                incoming -= quantity;
+            }
+            return;
+        }
+
+        const OrderBook *book = static_cast<const OrderBookManager &>(market_).get_order_book(update.symbol);
+        const Order *resting = book ? book->get_order(update.order_id) : nullptr;
+        if (!resting)
+        {
+            return;
+        }
+        Quantity resting_remaining = resting->quantity - resting->filled_quantity;
+        Quantity quantity = update.type == BookUpdateType::EXECUTE || update.type == BookUpdateType::CANCEL
+                                ? std::min(update.quantity, resting_remaining)
+                                : resting_remaining;
+
+        while (index != NONE)
+        {
+            uint32_t next = orders_[index].next;
+            SimOrder &order = orders_[index];
+            if (order.side == resting->side)
+            {
+                bool at_price = order.price == resting->price;
+                bool better = order.side == OrderSide::BUY ? order.price > resting->price : order.price < resting->price;
+                // Ties on timestamp go to the market order, so we never fill early
+                bool was_ahead = at_price && resting->timestamp <= order.joined;
+
+                if (update.type == BookUpdateType::EXECUTE && (better || (at_price && !was_ahead)))
+                {
+                    // The aggressor got past us to reach this order
+                    order.ahead = 0;
+                    fill(index, order.remaining(), update.timestamp);
+                }
+                else if (was_ahead)
+                {
+                    order.ahead -= std::min(quantity, order.ahead);
+                }
+            }
+            index = next;
+        }
+    }
+
+}
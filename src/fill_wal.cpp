@@ -0,0 +1,254 @@
+#include "fill_wal.hpp"
+#include "crc32.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mm
+{
+
+    namespace
+    {
+        // Records read per pread during recovery and replay
+        constexpr size_t READ_CHUNK_RECORDS = 4096;
+
+        bool write_all(int fd, const void *data, size_t length)
+        {
+            const char *bytes = static_cast<const char *>(data);
+            while (length > 0)
+            {
+                ssize_t written = ::write(fd, bytes, length);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                bytes += written;
+                length -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+
+        /**
+         * Walk the valid prefix of the file; stops at the first short, corrupt
+         * or out-of-order record. Returns the byte length of the valid prefix.
+         */
+        template <typename Fn>
+        size_t scan_records(int fd, Fn &&fn)
+        {
+            std::vector<FillRecord> chunk(READ_CHUNK_RECORDS);
+            size_t offset = 0;
+            uint64_t last_sequence = 0;
+
+            while (true)
+            {
+                ssize_t got = pread(fd, chunk.data(), chunk.size() * sizeof(FillRecord), static_cast<off_t>(offset));
+                if (got < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (got <= 0)
+                {
+                    return offset;
+                }
+
+                size_t records = static_cast<size_t>(got) / sizeof(FillRecord);
+                for (size_t i = 0; i < records; ++i)
+                {
+                    const FillRecord &record = chunk[i];
+                    if (record.crc != FillWal::checksum(record) || record.sequence <= last_sequence)
+                    {
+                        return offset;
+                    }
+                    fn(record);
+                    last_sequence = record.sequence;
+                    offset += sizeof(FillRecord);
+                }
+                if (records < chunk.size())
+                {
+                    return offset; // Trailing partial record, if any, is torn
+                }
+            }
+        }
+    }
+
+    FillWal::FillWal(const std::string &path, const Config &config)
+        : path_(path), config_(config), fd_(-1), base_sequence_(1), mask_(0),
+          head_(0), durable_(0), stop_(false), records_(0), batches_(0), sync_time_ns_(0), truncated_bytes_(0)
+    {
+        if (config_.ring_capacity == 0 || (config_.ring_capacity & (config_.ring_capacity - 1)) != 0)
+        {
+            throw std::invalid_argument("Fill journal ring capacity must be a power of two");
+        }
+
+        fd_ = open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ == -1)
+        {
+            throw std::runtime_error("Failed to open fill journal: " + path_);
+        }
+
+        uint64_t last_sequence = recover_tail();
+        base_sequence_ = last_sequence + 1;
+        durable_.store(last_sequence, std::memory_order_relaxed);
+
+        mask_ = config_.ring_capacity - 1;
+        ring_ = std::make_unique<Cell[]>(config_.ring_capacity);
+        for (size_t i = 0; i < config_.ring_capacity; ++i)
+        {
+            ring_[i].turn.store(i, std::memory_order_relaxed);
+        }
+
+        writer_ = std::thread(&FillWal::writer_loop, this);
+    }
+
+    FillWal::~FillWal()
+    {
+        // The writer drains everything already appended before it exits
+        stop_.store(true, std::memory_order_release);
+        if (writer_.joinable())
+        {
+            writer_.join();
+        }
+        if (fd_ != -1)
+        {
+            close(fd_);
+        }
+    }
+
+    uint32_t FillWal::checksum(const FillRecord &record)
+    {
+        return crc32c(&record, offsetof(FillRecord, crc));
+    }
+
+    uint64_t FillWal::recover_tail()
+    {
+        struct stat st;
+        if (fstat(fd_, &st) == -1)
+        {
+            close(fd_);
+            throw std::runtime_error("Failed to get fill journal stats");
+        }
+
+        uint64_t last_sequence = 0;
+        size_t valid = scan_records(fd_, [&](const FillRecord &record)
+                                    { last_sequence = record.sequence; });
+
+        // Anything past the valid prefix was mid-write when the process died
+        if (valid < static_cast<size_t>(st.st_size))
+        {
+            truncated_bytes_ = static_cast<size_t>(st.st_size) - valid;
+            if (ftruncate(fd_, static_cast<off_t>(valid)) == -1)
+            {
+                close(fd_);
+                throw std::runtime_error("Failed to truncate fill journal");
+            }
+            fdatasync(fd_);
+        }
+        lseek(fd_, static_cast<off_t>(valid), SEEK_SET);
+        return last_sequence;
+    }
+
+    size_t FillWal::replay(const std::function<void(const FillRecord &)> &fn) const
+    {
+        size_t count = 0;
+        scan_records(fd_, [&](const FillRecord &record)
+                     {
+            fn(record);
+            ++count; });
+        return count;
+    }
+
+    void FillWal::wait_durable(uint64_t sequence) const
+    {
+        while (durable_.load(std::memory_order_acquire) < sequence)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    FillWal::Stats FillWal::get_stats() const
+    {
+        uint64_t records = records_.load(std::memory_order_relaxed);
+        return Stats{
+            .records = records,
+            .batches = batches_.load(std::memory_order_relaxed),
+            .bytes = records * sizeof(FillRecord),
+            .sync_time_ns = sync_time_ns_.load(std::memory_order_relaxed),
+            .truncated_bytes = truncated_bytes_};
+    }
+
+    void FillWal::writer_loop()
+    {
+        std::vector<FillRecord> batch(config_.max_batch_records);
+        uint64_t tail = 0;
+
+        // Move ready records out of the ring, in sequence order
+        auto drain = [&](size_t count)
+        {
+            while (count < batch.size())
+            {
+                Cell &cell = ring_[tail & mask_];
+                if (cell.turn.load(std::memory_order_acquire) != tail + 1)
+                {
+                    break;
+                }
+                batch[count] = cell.record;
+                cell.turn.store(tail + config_.ring_capacity, std::memory_order_release);
+                ++tail;
+                ++count;
+            }
+            return count;
+        };
+
+        while (true)
+        {
+            // Read stop before draining so nothing appended earlier is missed
+            bool stopping = stop_.load(std::memory_order_acquire);
+            size_t count = drain(0);
+            if (count == 0)
+            {
+                if (stopping && tail == head_.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+                continue;
+            }
+
+            // Group commit: let more fills join this batch before syncing
+            if (config_.group_commit_window.count() > 0 && count < batch.size() && !stopping)
+            {
+                std::this_thread::sleep_for(config_.group_commit_window);
+                count = drain(count);
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                batch[i].crc = checksum(batch[i]);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            if (!write_all(fd_, batch.data(), count * sizeof(FillRecord)) || fdatasync(fd_) == -1)
+            {
+                // Fail stop: fills past this point could never be reported durable
+                std::terminate();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            sync_time_ns_.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                                    std::memory_order_relaxed);
+            records_.fetch_add(count, std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            durable_.store(batch[count - 1].sequence, std::memory_order_release);
+        }
+    }
+
+}
@@ -7,8 +7,9 @@
 namespace mm
 {
 
-    ITCHParser::ITCHParser(OrderBookManager &order_books, PositionTracker &position_tracker)
-        : order_books_(order_books), position_tracker_(position_tracker), next_symbol_id_(1)
+    ITCHParser::ITCHParser(OrderBookManager &order_books, PositionTracker &position_tracker, EngineClock &clock)
+        : order_books_(order_books), position_tracker_(position_tracker), clock_(clock), stats_(), next_symbol_id_(1), header_(), pending_(), pending_count_(0),
+          memory_cap_bytes_(0), memory_cap_exceeded_(false), update_sink_()
     {
     }
 
@@ -22,38 +23,58 @@ namespace mm
         }
 
         auto start_time = std::chrono::high_resolution_clock::now();
+        memory_cap_exceeded_ = false;
 
-        const size_t buffer_size = 8192;
-        uint8_t buffer[buffer_size];
+        // Memory usage walks every book, so only sample it periodically
+        const uint64_t memory_check_interval = 1 << 16;
+        uint64_t next_memory_check = stats_.total_messages + memory_check_interval;
 
-        while (file.read(reinterpret_cast<char *>(buffer), buffer_size))
+        // Large enough for any frame (2-byte length prefix + up to 64KB body)
+        const size_t buffer_size = 1 << 17;
+        std::vector<uint8_t> buffer(buffer_size);
+        size_t pending = 0;
+
+        while (file.read(reinterpret_cast<char *>(buffer.data() + pending), buffer_size - pending) || file.gcount() > 0)
         {
-            size_t bytes_read = file.gcount();
+            size_t bytes_read = pending + file.gcount();
             size_t offset = 0;
 
-            while (offset < bytes_read)
+            while (offset + 2 <= bytes_read)
             {
-                if (offset + 2 > bytes_read)
-                    break;
-
-                uint16_t message_length = (buffer[offset] << 8) | buffer[offset + 1];
-                if (offset + message_length > bytes_read)
+                size_t frame_length = 2 + ((buffer[offset] << 8) | buffer[offset + 1]);
+                if (offset + frame_length > bytes_read)
                     break;
 
-                if (!process_message(&buffer[offset], message_length))
+                if (!process_message(&buffer[offset], frame_length))
                 {
                     stats_.errors++;
                 }
 
-                offset += message_length;
+                offset += frame_length;
+            }
+
+            if (memory_cap_bytes_ != 0 && stats_.total_messages >= next_memory_check)
+            {
+                next_memory_check = stats_.total_messages + memory_check_interval;
+                if (order_books_.memory_usage() > memory_cap_bytes_)
+                {
+                    memory_cap_exceeded_ = true;
+                    break;
+                }
             }
+
+            // Carry a frame split across reads over to the next read
+            pending = bytes_read - offset;
+            std::memmove(buffer.data(), buffer.data() + offset, pending);
         }
 
+        flush();
+
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         stats_.processing_time_ms = duration.count();
 
-        return true;
+        return !memory_cap_exceeded_;
     }
 
     bool ITCHParser::process_message(const uint8_t *data, size_t length)
@@ -61,35 +82,48 @@ namespace mm
         if (length < 3)
             return false;
 
-        (void)((data[0] << 8) | data[1]);
-        uint8_t message_type = data[2];
+        size_t message_length = (data[0] << 8) | data[1];
+        const uint8_t *msg = data + 2;
+        uint8_t message_type = msg[0];
 
         stats_.total_messages++;
 
+        // Every ITCH 5.0 message starts with type, stock locate, tracking number and timestamp
+        if (message_length < 11 || message_length + 2 > length)
+            return false;
+
+        header_.type = static_cast<ITCHMessageType>(message_type);
+        header_.length = static_cast<uint16_t>(message_length);
+        header_.stock_locate = (msg[1] << 8) | msg[2];
+        header_.tracking_number = (msg[3] << 8) | msg[4];
+        header_.timestamp = convert_timestamp(&msg[5]);
+
+        clock_.advance(header_.timestamp);
+
         switch (static_cast<ITCHMessageType>(message_type))
         {
         case ITCHMessageType::ADD_ORDER_NO_MPID:
         case ITCHMessageType::ADD_ORDER_WITH_MPID:
-            return parse_add_order(data, length);
+            return parse_add_order(msg, message_length);
 
         case ITCHMessageType::ORDER_EXECUTED:
         case ITCHMessageType::ORDER_EXECUTED_WITH_PRICE:
-            return parse_order_executed(data, length);
+            return parse_order_executed(msg, message_length);
 
         case ITCHMessageType::ORDER_CANCEL:
-            return parse_order_cancel(data, length);
+            return parse_order_cancel(msg, message_length);
 
         case ITCHMessageType::ORDER_DELETE:
-            return parse_order_delete(data, length);
+            return parse_order_delete(msg, message_length);
 
         case ITCHMessageType::ORDER_REPLACE:
-            return parse_order_replace(data, length);
+            return parse_order_replace(msg, message_length);
 
         case ITCHMessageType::TRADE:
-            return parse_trade(data, length);
+            return parse_trade(msg, message_length);
 
         case ITCHMessageType::STOCK_DIRECTORY:
-            return parse_stock_directory(data, length);
+            return parse_stock_directory(msg, message_length);
 
         default:
             return true;
@@ -102,10 +136,9 @@ namespace mm
             return false;
 
         AddOrderMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        size_t offset = 3;
+        size_t offset = 11;
 
         msg.order_reference_number = 0;
         for (int i = 0; i < 8; i++)
@@ -122,7 +155,9 @@ namespace mm
         }
         offset += 4;
 
-        msg.stock_locate = data[offset++];
+        std::memcpy(msg.stock, &data[offset], 8);
+        offset += 8;
+
         msg.price = 0;
         for (int i = 0; i < 4; i++)
         {
@@ -130,7 +165,7 @@ namespace mm
         }
         offset += 4;
 
-        if (msg.type == ITCHMessageType::ADD_ORDER_WITH_MPID)
+        if (msg.type == ITCHMessageType::ADD_ORDER_WITH_MPID && length >= 40)
         {
             std::memcpy(msg.mpid, &data[offset], 4);
             msg.has_mpid = true;
@@ -144,27 +179,29 @@ namespace mm
         Price price = convert_price(msg.price);
         OrderSide side = (msg.buy_sell_indicator == 'B') ? OrderSide::BUY : OrderSide::SELL;
 
-        bool success = order_books_.add_order(symbol_id, msg.order_reference_number,
-                                              price, msg.shares, side);
-
-        if (success)
-        {
-            stats_.add_orders++;
-        }
-
-        return success;
+        BookUpdate update{};
+        update.type = BookUpdateType::ADD;
+        update.side = side;
+        update.symbol = symbol_id;
+        update.quantity = msg.shares;
+        update.order_id = msg.order_reference_number;
+        update.price = price;
+        update.timestamp = clock_.now();
+        enqueue(update);
+
+        stats_.add_orders++;
+        return true;
     }
 
     bool ITCHParser::parse_order_executed(const uint8_t *data, size_t length)
     {
-        if (length < 32)
+        if (length < 31)
             return false;
 
         OrderExecutedMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        size_t offset = 3;
+        size_t offset = 11;
 
         msg.order_reference_number = 0;
         for (int i = 0; i < 8; i++)
@@ -186,20 +223,27 @@ namespace mm
             msg.match_number = (msg.match_number << 8) | data[offset + i];
         }
 
+        BookUpdate update{};
+        update.type = BookUpdateType::EXECUTE;
+        update.symbol = get_symbol_id(msg.stock_locate);
+        update.quantity = msg.executed_shares;
+        update.order_id = msg.order_reference_number;
+        update.timestamp = clock_.now();
+        enqueue(update);
+
         stats_.executions++;
         return true;
     }
 
     bool ITCHParser::parse_order_cancel(const uint8_t *data, size_t length)
     {
-        if (length < 20)
+        if (length < 23)
             return false;
 
         OrderCancelMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        size_t offset = 3;
+        size_t offset = 11;
 
         msg.order_reference_number = 0;
         for (int i = 0; i < 8; i++)
@@ -214,20 +258,27 @@ namespace mm
             msg.canceled_shares = (msg.canceled_shares << 8) | data[offset + i];
         }
 
+        BookUpdate update{};
+        update.type = BookUpdateType::CANCEL;
+        update.symbol = get_symbol_id(msg.stock_locate);
+        update.quantity = msg.canceled_shares;
+        update.order_id = msg.order_reference_number;
+        update.timestamp = clock_.now();
+        enqueue(update);
+
         stats_.cancels++;
         return true;
     }
 
     bool ITCHParser::parse_order_delete(const uint8_t *data, size_t length)
     {
-        if (length < 12)
+        if (length < 19)
             return false;
 
         OrderDeleteMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        size_t offset = 3;
+        size_t offset = 11;
 
         msg.order_reference_number = 0;
         for (int i = 0; i < 8; i++)
@@ -235,20 +286,26 @@ namespace mm
             msg.order_reference_number = (msg.order_reference_number << 8) | data[offset + i];
         }
 
+        BookUpdate update{};
+        update.type = BookUpdateType::DELETE;
+        update.symbol = get_symbol_id(msg.stock_locate);
+        update.order_id = msg.order_reference_number;
+        update.timestamp = clock_.now();
+        enqueue(update);
+
         stats_.deletes++;
         return true;
     }
 
     bool ITCHParser::parse_order_replace(const uint8_t *data, size_t length)
     {
-        if (length < 36)
+        if (length < 35)
             return false;
 
         OrderReplaceMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        size_t offset = 3;
+        size_t offset = 11;
 
         msg.original_order_reference_number = 0;
         for (int i = 0; i < 8; i++)
@@ -277,6 +334,16 @@ namespace mm
             msg.price = (msg.price << 8) | data[offset + i];
         }
 
+        BookUpdate update{};
+        update.type = BookUpdateType::REPLACE;
+        update.symbol = get_symbol_id(msg.stock_locate);
+        update.quantity = msg.shares;
+        update.order_id = msg.original_order_reference_number;
+        update.new_order_id = msg.new_order_reference_number;
+        update.price = convert_price(msg.price);
+        update.timestamp = clock_.now();
+        enqueue(update);
+
         stats_.replaces++;
         return true;
     }
@@ -287,10 +354,9 @@ namespace mm
             return false;
 
         TradeMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        size_t offset = 3;
+        size_t offset = 11;
 
         msg.order_reference_number = 0;
         for (int i = 0; i < 8; i++)
@@ -308,7 +374,8 @@ namespace mm
         }
         offset += 4;
 
-        msg.stock_locate = data[offset++];
+        std::memcpy(msg.stock, &data[offset], 8);
+        offset += 8;
 
         msg.price = 0;
         for (int i = 0; i < 4; i++)
@@ -327,7 +394,7 @@ namespace mm
         Price price = convert_price(msg.price);
         OrderSide side = (msg.buy_sell_indicator == 'B') ? OrderSide::BUY : OrderSide::SELL;
 
-        position_tracker_.record_trade(symbol_id, price, msg.shares, side, msg.order_reference_number);
+        position_tracker_.record_trade(symbol_id, price, msg.shares, side, msg.order_reference_number, clock_.now());
 
         stats_.trades++;
         return true;
@@ -335,20 +402,13 @@ namespace mm
 
     bool ITCHParser::parse_stock_directory(const uint8_t *data, size_t length)
     {
-        if (length < 40)
+        if (length < 39)
             return false;
 
         StockDirectoryMessage msg;
-        msg.type = static_cast<ITCHMessageType>(data[2]);
-        msg.length = (data[0] << 8) | data[1];
-
-        size_t offset = 3;
+        static_cast<ITCHMessage &>(msg) = header_;
 
-        msg.stock_locate = data[offset++];
-        msg.tracking_number = data[offset++];
-
-        std::memcpy(msg.timestamp, &data[offset], 6);
-        offset += 6;
+        size_t offset = 11;
 
         std::memcpy(msg.stock, &data[offset], 8);
         offset += 8;
@@ -389,7 +449,33 @@ namespace mm
         return true;
     }
 
-    SymbolId ITCHParser::get_symbol_id(uint8_t stock_locate)
+    void ITCHParser::enqueue(const BookUpdate &update)
+    {
+        pending_[pending_count_++] = update;
+        if (pending_count_ == pending_.size())
+        {
+            flush();
+        }
+    }
+
+    void ITCHParser::flush()
+    {
+        if (pending_count_ == 0)
+            return;
+
+        if (update_sink_)
+        {
+            update_sink_(pending_.data(), pending_count_);
+            pending_count_ = 0;
+            return;
+        }
+
+        size_t applied = order_books_.apply_batch(pending_.data(), pending_count_);
+        stats_.errors += pending_count_ - applied;
+        pending_count_ = 0;
+    }
+
+    SymbolId ITCHParser::get_symbol_id(uint16_t stock_locate)
     {
         auto it = symbol_mapping_.find(stock_locate);
         if (it != symbol_mapping_.end())
@@ -404,7 +490,8 @@ namespace mm
 
     Price ITCHParser::convert_price(uint32_t itch_price)
     {
-        return static_cast<Price>(itch_price) * 100;
+        // ITCH prices carry four implied decimals, same as the internal format
+        return static_cast<Price>(itch_price);
     }
 
     Timestamp ITCHParser::convert_timestamp(const uint8_t *itch_timestamp)
@@ -3,13 +3,32 @@
 #include "itch_parser.hpp"
 #include "scenario_runner.hpp"
 #include "strategy.hpp"
+#include "strategy_dispatcher.hpp"
+#include "policy_strategy.hpp"
+#include "replay_driver.hpp"
+#include "clock.hpp"
+#include "risk_gate.hpp"
+#include "quote_manager.hpp"
+#include "portfolio_var.hpp"
+#include "parameter_sweep.hpp"
+#include "fill_simulator.hpp"
+#include "position_shm.hpp"
 #include "types.hpp"
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <random>
+#include <cmath>
 #include <iomanip>
 #include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
 #include <thread>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 using namespace mm;
 
@@ -45,6 +64,7 @@ void benchmark_order_book_operations()
     std::cout << "\n=== Order Book Performance Benchmark ===" << std::endl;
 
     OrderBook order_book(1);
+    EngineClock clock(ClockMode::LIVE);
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<Price> price_dist(price_from_dollars(100.0), price_from_dollars(101.0));
@@ -61,7 +81,7 @@ void benchmark_order_book_operations()
         Quantity qty = qty_dist(gen);
         OrderSide side = (i % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
 
-        order_book.add_order(order_id, price, qty, side);
+        order_book.add_order(order_id, price, qty, side, clock.now());
     }
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
@@ -76,6 +96,569 @@ void benchmark_order_book_operations()
     print_order_book_stats(order_book);
 }
 
+void benchmark_quote_manager()
+{
+    std::cout << "\n=== Quote Update Benchmark ===" << std::endl;
+
+    constexpr size_t num_symbols = 16;
+    constexpr size_t cycles = 20000;
+    constexpr Quantity quote_size = 100;
+    const Price tick = price_from_dollars(0.01);
+    const Price half_spread = price_from_dollars(0.05);
+
+    // Fair values wander one tick at a time; most cycles most symbols stay put
+    std::mt19937 gen(29);
+    std::vector<Price> mids(cycles * num_symbols);
+    for (size_t symbol = 0; symbol < num_symbols; ++symbol)
+    {
+        Price mid = price_from_dollars(100.0);
+        for (size_t cycle = 0; cycle < cycles; ++cycle)
+        {
+            uint32_t roll = gen() % 20;
+            mid += roll == 0 ? tick : roll == 1 ? -tick : 0;
+            mids[cycle * num_symbols + symbol] = mid;
+        }
+    }
+
+    EngineClock clock(ClockMode::LIVE);
+    auto report = [&](const char *label, uint64_t operations, Timestamp elapsed)
+    {
+        std::cout << std::setw(28) << std::left << label << std::right
+                  << static_cast<double>(operations) / cycles << " book ops/cycle, "
+                  << static_cast<double>(elapsed) / cycles << " ns/cycle" << std::endl;
+    };
+
+    // Before: cancel both sides and add two new orders every cycle
+    {
+        OrderBookManager books;
+        std::array<bool, num_symbols> quoted{};
+        uint64_t operations = 0;
+        Timestamp start = clock.now();
+        for (size_t cycle = 0; cycle < cycles; ++cycle)
+        {
+            for (size_t i = 0; i < num_symbols; ++i)
+            {
+                SymbolId symbol = static_cast<SymbolId>(i + 1);
+                Price mid = mids[cycle * num_symbols + i];
+                OrderId bid_id = 10000 + i * 2 + 1;
+                OrderId ask_id = 10000 + i * 2 + 2;
+                if (quoted[i])
+                {
+                    books.cancel_order(symbol, bid_id, cycle);
+                    books.cancel_order(symbol, ask_id, cycle);
+                    operations += 2;
+                }
+                books.add_order(symbol, bid_id, mid - half_spread, quote_size, OrderSide::BUY, cycle);
+                books.add_order(symbol, ask_id, mid + half_spread, quote_size, OrderSide::SELL, cycle);
+                operations += 2;
+                quoted[i] = true;
+            }
+        }
+        report("cancel/replace every cycle:", operations, clock.now() - start);
+    }
+
+    // After: the quote manager sends only what differs, with and without hysteresis
+    for (Price tolerance : {Price(0), tick})
+    {
+        QuoteManagerConfig config;
+        config.price_tolerance = tolerance;
+        QuoteManager quotes(1, config);
+        OrderBookManager books;
+        Timestamp start = clock.now();
+        for (size_t cycle = 0; cycle < cycles; ++cycle)
+        {
+            for (size_t i = 0; i < num_symbols; ++i)
+            {
+                Price mid = mids[cycle * num_symbols + i];
+                quotes.update(books, static_cast<SymbolId>(i + 1),
+                              QuoteTarget{mid - half_spread, quote_size, mid + half_spread, quote_size}, cycle);
+            }
+        }
+        report(tolerance ? "quote manager, 1 tick band:" : "quote manager, exact:",
+               quotes.get_stats().operations(), clock.now() - start);
+    }
+}
+
+void benchmark_strategy_dispatch()
+{
+    std::cout << "\n=== Strategy Dispatch Benchmark ===" << std::endl;
+
+    constexpr size_t packets = 10000;
+    constexpr size_t updates_per_packet = 16;
+    const Price base_price = price_from_dollars(100.00);
+
+    for (size_t universe : {size_t(64), size_t(256), size_t(1024)})
+    {
+        // Feed adds and deletes orders a few cents either side of the quotes,
+        // so only some updates move a BBO
+        std::mt19937 gen(31);
+        std::vector<BookUpdate> feed;
+        feed.reserve(packets * updates_per_packet);
+        std::vector<std::pair<SymbolId, OrderId>> live;
+        OrderId next_id = 1;
+        for (size_t i = 0; i < packets * updates_per_packet; ++i)
+        {
+            BookUpdate update{};
+            if (live.size() < 64 || (gen() & 1))
+            {
+                update.type = BookUpdateType::ADD;
+                update.symbol = static_cast<SymbolId>(gen() % universe + 1);
+                update.side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+                Price offset = price_from_dollars(0.01) * static_cast<Price>(gen() % 8 + 2);
+                update.price = update.side == OrderSide::BUY ? base_price - offset : base_price + offset;
+                update.quantity = 100;
+                update.order_id = next_id++;
+                live.emplace_back(update.symbol, update.order_id);
+            }
+            else
+            {
+                size_t pick = gen() % live.size();
+                update.type = BookUpdateType::DELETE;
+                update.symbol = live[pick].first;
+                update.order_id = live[pick].second;
+                live[pick] = live.back();
+                live.pop_back();
+            }
+            feed.push_back(update);
+        }
+
+        Timestamp elapsed[2] = {0, 0};
+        uint64_t evaluations[2] = {0, 0};
+        EngineClock clock(ClockMode::LIVE);
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            OrderBookManager books;
+            PositionTracker positions;
+            FixedSpreadStrategy::Config config{};
+            config.base_price = base_price;
+            config.spread = price_from_dollars(0.10);
+            config.quote_size = 100;
+            for (size_t i = 0; i < universe; ++i)
+            {
+                config.symbols.push_back(static_cast<SymbolId>(i + 1));
+            }
+            FixedSpreadStrategy strategy(config);
+            strategy.update_quotes(books, positions, 0);
+            StrategyDispatcher dispatcher;
+            dispatcher.add_strategy(&strategy);
+
+            for (size_t packet = 0; packet < packets; ++packet)
+            {
+                const BookUpdate *updates = feed.data() + packet * updates_per_packet;
+                books.apply(updates, updates_per_packet);
+                Timestamp now = static_cast<Timestamp>(packet + 1);
+                Timestamp start = clock.now();
+                if (mode == 0)
+                {
+                    // Polling: the strategy re-evaluates every symbol
+                    strategy.update_quotes(books, positions, now);
+                    evaluations[mode] += universe;
+                }
+                else
+                {
+                    dispatcher.touch(updates, updates_per_packet);
+                    evaluations[mode] += dispatcher.dispatch(books, positions, now);
+                }
+                elapsed[mode] += clock.now() - start;
+            }
+        }
+
+        std::cout << universe << " symbols, " << updates_per_packet << " updates/packet: poll "
+                  << static_cast<double>(elapsed[0]) / packets << " ns/packet (" << evaluations[0] / packets
+                  << " symbol evaluations), dispatch " << static_cast<double>(elapsed[1]) / packets << " ns/packet ("
+                  << static_cast<double>(evaluations[1]) / packets << " symbol evaluations)" << std::endl;
+    }
+}
+
+void benchmark_strategy_cycle()
+{
+    std::cout << "\n=== Inventory-Skewed Quote Cycle Benchmark ===" << std::endl;
+
+    const Price base_price = price_from_dollars(100.00);
+    const Price min_spread = price_from_dollars(0.05);
+    const Price max_spread = price_from_dollars(0.20);
+    constexpr Quantity max_inventory = 1000;
+    EngineClock clock(ClockMode::LIVE);
+
+    for (size_t num_symbols : {size_t(16), size_t(256), size_t(4096)})
+    {
+        std::mt19937 gen(37);
+        std::vector<int64_t> inventory(num_symbols);
+        for (auto &inv : inventory)
+        {
+            inv = static_cast<int64_t>(gen() % 2001) - 1000;
+        }
+
+        // Quote math alone: the old per-symbol double formula over an array
+        // of structs, against the fixed-point kernel over arrays
+        struct SymbolState
+        {
+            OrderId bid_order_id;
+            OrderId ask_order_id;
+            Price last_bid;
+            Price last_ask;
+            Quantity last_qty;
+            int64_t inventory;
+        };
+        std::vector<SymbolState> states(num_symbols);
+        for (size_t i = 0; i < num_symbols; ++i)
+        {
+            states[i] = SymbolState{0, 0, 0, 0, 0, inventory[i]};
+        }
+        const size_t rounds = std::max<size_t>(1, 4000000 / num_symbols);
+        Price checksum = 0;
+        Timestamp start = clock.now();
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            for (auto &state : states)
+            {
+                double skew = double(state.inventory) / double(max_inventory);
+                Price mid = base_price - Price(skew * double(max_spread) / 2);
+                Price spread = min_spread + Price(std::abs(skew) * double(max_spread - min_spread));
+                state.last_bid = mid - spread / 2;
+                state.last_ask = mid + spread / 2;
+            }
+            checksum += states[round % num_symbols].last_bid;
+        }
+        double double_ns = static_cast<double>(clock.now() - start) / (rounds * num_symbols);
+
+        SkewedQuoteParams params = make_skewed_quote_params(min_spread, max_spread, max_inventory);
+        std::vector<Price> fair(num_symbols, base_price), bids(num_symbols), asks(num_symbols);
+        start = clock.now();
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            skewed_quote_kernel(fair.data(), inventory.data(), num_symbols, params, bids.data(), asks.data());
+            checksum += bids[round % num_symbols];
+        }
+        double kernel_ns = static_cast<double>(clock.now() - start) / (rounds * num_symbols);
+
+        // Whole cycles through the strategy: a full refresh of every symbol,
+        // and a dispatch after fills in a tenth of the symbols
+        OrderBookManager books(64, 16);
+        PositionTracker positions;
+        InventorySkewedStrategy::Config config{};
+        config.base_price = base_price;
+        config.min_spread = min_spread;
+        config.max_spread = max_spread;
+        config.quote_size = 100;
+        config.max_inventory = max_inventory;
+        for (size_t i = 0; i < num_symbols; ++i)
+        {
+            config.symbols.push_back(static_cast<SymbolId>(i + 1));
+        }
+        InventorySkewedStrategy strategy(config);
+        StrategyDispatcher dispatcher;
+        dispatcher.add_strategy(&strategy);
+        strategy.update_quotes(books, positions, 0);
+
+        // Fills hit our own quotes, so books and quote manager stay in step;
+        // alternate cycles re-quote by full refresh or by dispatch
+        constexpr size_t cycles = 200;
+        const size_t fills_per_cycle = std::max<size_t>(1, num_symbols / 10);
+        Timestamp refresh_ns = 0;
+        Timestamp dispatch_ns = 0;
+        uint64_t trade_id = 1;
+        for (size_t cycle = 1; cycle <= cycles; ++cycle)
+        {
+            for (size_t fill = 0; fill < fills_per_cycle; ++fill)
+            {
+                SymbolId symbol = static_cast<SymbolId>(gen() % num_symbols + 1);
+                OrderSide side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+                BestBidOffer bbo = books.get_bbo(symbol);
+                Price price = side == OrderSide::BUY ? bbo.bid : bbo.ask;
+                Quantity qty = 10 + gen() % 20;
+                if (price <= 0 || !books.execute_trade(symbol, price, qty, side == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY, cycle))
+                {
+                    continue;
+                }
+                positions.record_trade(symbol, price, qty, side, trade_id++, cycle);
+                dispatcher.on_fill(symbol, price, qty, side, cycle);
+            }
+            start = clock.now();
+            if (cycle & 1)
+            {
+                strategy.update_quotes(books, positions, cycle);
+                refresh_ns += clock.now() - start;
+                dispatcher.dispatch(books, positions, cycle); // Nothing left to change; clears the dirty set
+            }
+            else
+            {
+                dispatcher.dispatch(books, positions, cycle);
+                dispatch_ns += clock.now() - start;
+            }
+        }
+
+        std::cout << std::setw(5) << num_symbols << " symbols: quote math " << double_ns << " ns/symbol (double, AoS) vs "
+                  << kernel_ns << " ns/symbol (fixed point, SoA); cycle after " << fills_per_cycle << " fills: full refresh "
+                  << refresh_ns / (cycles / 2) / 1000.0 << " us, dispatch " << dispatch_ns / (cycles / 2) / 1000.0
+                  << " us (" << (checksum & 1) << ")" << std::endl;
+    }
+}
+
+void benchmark_policy_strategy()
+{
+    std::cout << "\n=== Policy Strategy vs Virtual Dispatch Benchmark ===" << std::endl;
+
+    const Price base_price = price_from_dollars(100.00);
+    constexpr size_t num_symbols = 256;
+    constexpr size_t rounds = 4000;
+    EngineClock clock(ClockMode::LIVE);
+    std::mt19937 gen(41);
+
+    OrderBookManager books(64, 16);
+    PositionTracker positions;
+    std::vector<SymbolId> symbols;
+    for (size_t i = 0; i < num_symbols; ++i)
+    {
+        SymbolId symbol = static_cast<SymbolId>(i + 1);
+        symbols.push_back(symbol);
+        positions.record_trade(symbol, base_price, 1 + gen() % 900, (gen() & 1) ? OrderSide::BUY : OrderSide::SELL, i + 1, 0);
+    }
+
+    InventorySkewedPolicyStrategy::Config config{};
+    config.fair_value.base_price = base_price;
+    config.spread = InventorySkewSpread::Config{price_from_dollars(0.05), price_from_dollars(0.20), 1000};
+    config.size.quote_size = 100;
+    config.symbols = symbols;
+
+    // Quote math alone, inlined into the loop
+    InventorySkewedPolicyStrategy::Config bare_config = config;
+    QuoteManager bare_quotes(OrderId(3) << 40);
+    InventorySkewedPolicyStrategy bare(bare_config, bare_quotes);
+    std::vector<int64_t> inventory(num_symbols);
+    for (auto &inv : inventory)
+    {
+        inv = static_cast<int64_t>(gen() % 2001) - 1000;
+    }
+    const BestBidOffer no_book{0, 0};
+    Price checksum = 0;
+    Timestamp start = clock.now();
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        for (size_t slot = 0; slot < num_symbols; ++slot)
+        {
+            QuoteTarget target = bare.compute_quote(slot, no_book, inventory[slot] + static_cast<int64_t>(round));
+            checksum += target.bid_price ^ target.ask_size;
+        }
+    }
+    double compute_ns = static_cast<double>(clock.now() - start) / (rounds * num_symbols);
+
+    // A whole book update: position read, quote, and the quote manager's
+    // comparison against the working orders (unchanged after the first round)
+    auto per_quote_ns = [&](auto &&on_book_update)
+    {
+        for (size_t slot = 0; slot < num_symbols; ++slot)
+        {
+            on_book_update(symbols[slot], slot, books.get_bbo(symbols[slot]), Timestamp(0));
+        }
+        Timestamp begin = clock.now();
+        for (size_t round = 1; round <= rounds; ++round)
+        {
+            for (size_t slot = 0; slot < num_symbols; ++slot)
+            {
+                on_book_update(symbols[slot], slot, no_book, Timestamp(round));
+            }
+        }
+        return static_cast<double>(clock.now() - begin) / (rounds * num_symbols);
+    };
+
+    double direct_ns = per_quote_ns([&](SymbolId symbol, size_t slot, const BestBidOffer &bbo, Timestamp now)
+                                    { bare.on_book_update(symbol, slot, bbo, books, positions, now); });
+
+    // Held through the base interface as a runtime choice would be, so the calls stay virtual
+    std::vector<std::unique_ptr<MarketMakingStrategy>> candidates;
+    candidates.push_back(std::make_unique<StrategyAdapter<InventorySkewedPolicyStrategy>>(config, OrderId(4) << 40));
+    candidates.push_back(std::make_unique<StrategyAdapter<FixedSpreadPolicyStrategy>>(
+        FixedSpreadPolicyStrategy::Config{{base_price}, {price_from_dollars(0.10)}, {100}, symbols}, OrderId(5) << 40));
+    MarketMakingStrategy *adapted = candidates.front().get();
+    double adapter_ns = per_quote_ns([&](SymbolId symbol, size_t slot, const BestBidOffer &bbo, Timestamp now)
+                                     { adapted->on_book_update(symbol, slot, bbo, books, positions, now); });
+
+    // The hand-written virtual strategy, quoting one symbol per call
+    FixedSpreadStrategy::Config fixed_config{base_price, price_from_dollars(0.10), 100, symbols, QuoteManagerConfig()};
+    std::unique_ptr<MarketMakingStrategy> fixed = std::make_unique<FixedSpreadStrategy>(fixed_config);
+    double fixed_ns = per_quote_ns([&](SymbolId symbol, size_t slot, const BestBidOffer &bbo, Timestamp now)
+                                   { fixed->on_book_update(symbol, slot, bbo, books, positions, now); });
+
+    std::cout << "Quote math (policies inlined): " << compute_ns << " ns/quote" << std::endl;
+    std::cout << "on_book_update, skewed policy strategy: direct " << direct_ns << " ns/quote, through StrategyAdapter "
+              << adapter_ns << " ns/quote" << std::endl;
+    std::cout << "on_book_update, FixedSpreadStrategy (virtual): " << fixed_ns << " ns/quote (" << (checksum & 1) << ")" << std::endl;
+}
+
+void benchmark_parameter_sweep()
+{
+    std::cout << "\n=== Parameter Sweep Benchmark ===" << std::endl;
+
+    const std::string itch_file = "data/sample.itch";
+    if (!std::filesystem::exists(itch_file))
+    {
+        std::cout << "ITCH file not found: " << itch_file << ", skipping." << std::endl;
+        return;
+    }
+
+    // Decoded once, shared read-only by every run below
+    FeedTape tape;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!tape.load_itch_file(itch_file))
+    {
+        std::cout << "Failed to decode " << itch_file << std::endl;
+        return;
+    }
+    double decode_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Decoded " << tape.updates_applied() << " book updates into " << tape.size() << " events over "
+              << tape.symbol_count() << " symbols in " << decode_ms << " ms" << std::endl;
+
+    std::vector<SweepParams> grid;
+    for (double min_spread : {0.01, 0.02, 0.05, 0.10})
+    {
+        for (double widen : {0.0, 0.05, 0.10, 0.20})
+        {
+            for (Quantity max_inventory : {100u, 500u, 2000u, 10000u})
+            {
+                for (Quantity quote_size : {100u, 200u, 500u, 1000u})
+                {
+                    grid.push_back(SweepParams{price_from_dollars(min_spread), price_from_dollars(min_spread + widen),
+                                               max_inventory, quote_size});
+                }
+            }
+        }
+    }
+
+    // One parameter set per pass against grouped passes, then every core
+    ParameterSweep::Config config;
+    config.num_threads = 1;
+    config.configs_per_pass = 1;
+    SweepReport ungrouped = ParameterSweep(config).run(tape, grid);
+    config.configs_per_pass = 8;
+    SweepReport grouped = ParameterSweep(config).run(tape, grid);
+    config.num_threads = 0;
+    SweepReport parallel = ParameterSweep(config).run(tape, grid);
+
+    double events = static_cast<double>(tape.size()) * grid.size();
+    std::cout << grid.size() << " parameter sets, 1 thread: " << ungrouped.makespan_ms << " ms ungrouped, "
+              << grouped.makespan_ms << " ms in groups of 8 (" << events / grouped.makespan_ms / 1e3 << "M events/s)" << std::endl;
+    std::cout << parallel.threads << " thread(s): " << parallel.makespan_ms << " ms, speedup "
+              << grouped.makespan_ms / parallel.makespan_ms << "x" << std::endl;
+
+    std::vector<SweepResult> ranked = parallel.results;
+    std::sort(ranked.begin(), ranked.end(), [](const SweepResult &a, const SweepResult &b)
+              { return a.pnl > b.pnl; });
+    std::cout << "Best parameter sets by P&L:" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(3, ranked.size()); ++i)
+    {
+        const SweepResult &r = ranked[i];
+        std::cout << "  spread " << price_to_dollars(r.params.min_spread) << "-" << price_to_dollars(r.params.max_spread)
+                  << " max_inventory " << r.params.max_inventory << " size " << r.params.quote_size
+                  << ": P&L " << price_to_dollars(r.pnl) << ", max drawdown " << price_to_dollars(r.max_drawdown)
+                  << ", " << r.fills << " fills, " << r.quote_updates << " quote updates" << std::endl;
+    }
+}
+
+void benchmark_signal_strategies()
+{
+    std::cout << "\n=== Rolling Statistics and Signal Strategy Benchmark ===" << std::endl;
+
+    constexpr size_t window = 256;
+    constexpr size_t events = 2000000;
+    EngineClock clock(ClockMode::LIVE);
+    std::mt19937 gen(43);
+    std::vector<int64_t> mids(events);
+    int64_t mid = price_from_dollars(100.00);
+    for (auto &m : mids)
+    {
+        mid += static_cast<int64_t>(gen() % 21) - 10;
+        m = mid;
+    }
+
+    // Estimators alone: O(1) updates against recomputing the window per event
+    EwmaStats ewma(0.05);
+    RollingWindow rolling(window);
+    RollingMinMax range(window);
+    double checksum = 0;
+    Timestamp start = clock.now();
+    for (int64_t m : mids)
+    {
+        ewma.update(double(m));
+        checksum += ewma.stddev();
+    }
+    double ewma_ns = static_cast<double>(clock.now() - start) / events;
+    start = clock.now();
+    for (int64_t m : mids)
+    {
+        rolling.push(m);
+        checksum += rolling.stddev();
+    }
+    double rolling_ns = static_cast<double>(clock.now() - start) / events;
+    start = clock.now();
+    for (int64_t m : mids)
+    {
+        range.push(m);
+        checksum += double(range.max() - range.min());
+    }
+    double range_ns = static_cast<double>(clock.now() - start) / events;
+
+    constexpr size_t naive_events = events / 20;
+    start = clock.now();
+    for (size_t i = window; i < window + naive_events; ++i)
+    {
+        double sum = 0, squares = 0;
+        int64_t lo = mids[i], hi = mids[i];
+        for (size_t j = i + 1 - window; j <= i; ++j)
+        {
+            sum += double(mids[j]);
+            squares += double(mids[j]) * double(mids[j]);
+            lo = std::min(lo, mids[j]);
+            hi = std::max(hi, mids[j]);
+        }
+        checksum += std::sqrt(std::max(0.0, squares / window - (sum / window) * (sum / window))) + double(hi - lo);
+    }
+    double naive_ns = static_cast<double>(clock.now() - start) / naive_events;
+
+    std::cout << "Per event over a " << window << "-sample window: EWMA " << ewma_ns << " ns, rolling mean/stddev "
+              << rolling_ns << " ns, rolling min/max " << range_ns << " ns; recomputing window stddev and range "
+              << naive_ns << " ns" << std::endl;
+
+    // Whole strategy callbacks: sample the mid, requote through the quote manager
+    constexpr size_t num_symbols = 64;
+    constexpr size_t strategy_events = 500000;
+    std::vector<SymbolId> symbols;
+    for (size_t i = 0; i < num_symbols; ++i)
+    {
+        symbols.push_back(static_cast<SymbolId>(i + 1));
+    }
+    PositionTracker positions;
+    QuoteManagerConfig quoting;
+    quoting.price_tolerance = 100;
+
+    AdaptiveSpreadStrategy::Config adaptive_config{price_from_dollars(100.00), price_from_dollars(0.02), price_from_dollars(0.20),
+                                                   2.0, 0.05, 100, symbols, quoting};
+    MeanReversionStrategy::Config reversion_config{price_from_dollars(100.00), price_from_dollars(0.04), window, 0.5, 100, symbols, quoting};
+    MomentumStrategy::Config momentum_config{price_from_dollars(100.00), price_from_dollars(0.04), window, price_from_dollars(0.01), 100, symbols, quoting};
+    std::vector<std::pair<const char *, std::unique_ptr<MarketMakingStrategy>>> strategies;
+    strategies.emplace_back("adaptive spread", std::make_unique<AdaptiveSpreadStrategy>(adaptive_config));
+    strategies.emplace_back("mean reversion", std::make_unique<MeanReversionStrategy>(reversion_config));
+    strategies.emplace_back("momentum", std::make_unique<MomentumStrategy>(momentum_config));
+
+    for (auto &[name, strategy] : strategies)
+    {
+        OrderBookManager books(64, 64);
+        start = clock.now();
+        for (size_t i = 0; i < strategy_events; ++i)
+        {
+            size_t slot = i % num_symbols;
+            // Market one tick either side of the walk, a cent wider than our quotes
+            BestBidOffer bbo{mids[i] - 300, mids[i] + 300};
+            strategy->on_book_update(symbols[slot], slot, bbo, books, positions, Timestamp(i));
+        }
+        double ns = static_cast<double>(clock.now() - start) / strategy_events;
+        const QuoteManager::Stats &stats = strategy->get_quote_stats();
+        std::cout << "  " << std::setw(16) << std::left << name << std::right << ns << " ns/event, "
+                  << stats.operations() << " order operations, " << stats.unchanged << " sides unchanged" << std::endl;
+    }
+    std::cout << "(" << (checksum > 0) << ")" << std::endl;
+}
+
 void benchmark_position_tracker()
 {
     std::cout << "\n=== Position Tracker Performance Benchmark ===" << std::endl;
@@ -86,6 +669,7 @@ void benchmark_position_tracker()
     limits.max_short_position = 50000;
 
     PositionTracker position_tracker(limits);
+    EngineClock clock(ClockMode::LIVE);
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<Quantity> qty_dist(100, 1000);
@@ -107,13 +691,13 @@ void benchmark_position_tracker()
         {
             // Buy at slightly lower price
             Price buy_price = base_price - price_from_dollars(0.01);
-            position_tracker.record_trade(symbol, buy_price, qty, OrderSide::BUY, order_id);
+            position_tracker.record_trade(symbol, buy_price, qty, OrderSide::BUY, order_id, clock.now());
         }
         else
         {
             // Sell at slightly higher price (profitable)
             Price sell_price = base_price + price_from_dollars(0.02);
-            position_tracker.record_trade(symbol, sell_price, qty, OrderSide::SELL, order_id);
+            position_tracker.record_trade(symbol, sell_price, qty, OrderSide::SELL, order_id, clock.now());
         }
     }
     auto end = std::chrono::high_resolution_clock::now();
@@ -127,6 +711,962 @@ void benchmark_position_tracker()
               << static_cast<double>(num_trades) * 1000000 / duration.count() << " trades/second" << std::endl;
 
     print_position_stats(position_tracker);
+
+    // Per-trade latency over enough trades to rotate through journal segments
+    const size_t latency_trades = 1000000;
+    std::vector<Timestamp> latencies(latency_trades);
+    for (size_t i = 0; i < latency_trades; ++i)
+    {
+        OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+        Timestamp before = clock.now();
+        position_tracker.record_trade(symbol_dist(gen), base_price, 100, side, i, before);
+        latencies[i] = clock.now() - before;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "record_trade latency over " << latency_trades << " trades: p50=" << latencies[latency_trades / 2]
+              << "ns p99=" << latencies[latency_trades * 99 / 100] << "ns p99.9=" << latencies[latency_trades * 999 / 1000]
+              << "ns max=" << latencies.back() << "ns" << std::endl;
+
+    const size_t risk_checks = 10000000;
+    size_t passed = 0;
+    auto risk_start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < risk_checks; ++i)
+    {
+        passed += position_tracker.check_risk_limits();
+    }
+    auto risk_end = std::chrono::high_resolution_clock::now();
+    std::cout << "check_risk_limits: " << std::chrono::duration<double, std::nano>(risk_end - risk_start).count() / risk_checks
+              << " ns/call (" << passed << " passed), gross exposure $" << price_to_dollars(position_tracker.get_gross_exposure()) << std::endl;
+}
+
+void benchmark_position_contention()
+{
+    std::cout << "\n=== Position Reader/Writer Contention Benchmark ===" << std::endl;
+
+    constexpr SymbolId num_symbols = 16;
+    constexpr size_t num_trades = 200000;
+    constexpr size_t num_readers = 2;
+    const Price price = price_from_dollars(100.0);
+
+    // Writer records fills while readers run quote cycles that read every
+    // symbol's position; returns writer trades/second and reader reads/second
+    auto run = [&](auto &&write_fn, auto &&read_fn, size_t readers)
+    {
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> reads{0};
+        std::vector<std::thread> threads;
+        for (size_t r = 0; r < readers; ++r)
+        {
+            threads.emplace_back([&]()
+                                 {
+                uint64_t local = 0;
+                int64_t sink = 0;
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    for (SymbolId symbol = 1; symbol <= num_symbols; ++symbol)
+                    {
+                        sink += read_fn(symbol);
+                    }
+                    local += num_symbols;
+                }
+                reads.fetch_add(local + (sink == 42), std::memory_order_relaxed); });
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < num_trades; ++i)
+        {
+            write_fn(static_cast<SymbolId>(i % num_symbols + 1), static_cast<OrderId>(i), (i & 1) ? OrderSide::SELL : OrderSide::BUY,
+                     static_cast<Timestamp>(i));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        done.store(true);
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        return std::make_pair(num_trades / seconds, reads.load() / seconds);
+    };
+
+    // Previous layout: map of positions and trade history behind one mutex
+    struct LockedPositions
+    {
+        std::map<SymbolId, Position> positions;
+        std::map<SymbolId, std::vector<Trade>> trade_history;
+        std::mutex mutex;
+    };
+
+    auto report = [&](const char *name, auto &&make_write, auto &&make_read)
+    {
+        auto idle = run(make_write(), make_read(), 0);
+        auto contended = run(make_write(), make_read(), num_readers);
+        std::cout << name << ": writer " << idle.first << " trades/s alone, " << contended.first
+                  << " trades/s with " << num_readers << " readers (" << contended.second << " reads/s)" << std::endl;
+        return contended.first;
+    };
+
+    auto locked = std::make_unique<LockedPositions>();
+    double locked_rate = report(
+        "Mutex + map",
+        [&]()
+        {
+            return [&](SymbolId symbol, OrderId order_id, OrderSide side, Timestamp now)
+            {
+                std::lock_guard<std::mutex> lock(locked->mutex);
+                locked->trade_history[symbol].emplace_back(symbol, price, 100, side, order_id, now);
+                Position &position = locked->positions[symbol];
+                position.symbol = symbol;
+                position.last_update = now;
+                (side == OrderSide::BUY ? position.long_quantity : position.short_quantity) += 100;
+            };
+        },
+        [&]()
+        {
+            return [&](SymbolId symbol) -> int64_t
+            {
+                std::lock_guard<std::mutex> lock(locked->mutex);
+                auto it = locked->positions.find(symbol);
+                return it != locked->positions.end() ? it->second.get_net_position() : 0;
+            };
+        });
+
+    auto tracker = std::make_unique<PositionTracker>();
+    double seqlock_rate = report(
+        "Seqlock slots",
+        [&]()
+        {
+            return [&](SymbolId symbol, OrderId order_id, OrderSide side, Timestamp now)
+            {
+                tracker->record_trade(symbol, price, 100, side, order_id, now);
+            };
+        },
+        [&]()
+        {
+            return [&](SymbolId symbol) -> int64_t
+            {
+                return tracker->check_position_limits(symbol, 100, OrderSide::BUY);
+            };
+        });
+
+    std::cout << "Contended writer speedup: " << seqlock_rate / locked_rate << "x" << std::endl;
+}
+
+void benchmark_risk_gate()
+{
+    std::cout << "\n=== Pre-Trade Risk Gate Benchmark ===" << std::endl;
+
+    constexpr size_t num_symbols = 256;
+    constexpr size_t num_orders = 1 << 16;
+    constexpr size_t num_checks = 10000000;
+
+    // Roomy quantity limits so reservations never saturate; price band and
+    // rate limits still reject a share of orders
+    RiskGateLimits limits;
+    limits.max_long_position = 4000000000u;
+    limits.max_short_position = 4000000000u;
+    limits.max_pending_quantity = 4000000000u;
+    limits.max_price_deviation = price_from_dollars(0.50);
+    limits.max_orders_per_window = 1000000;
+    PreTradeRiskGate gate(limits);
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> cents_dist(-60, 60);
+    for (SymbolId symbol = 1; symbol <= num_symbols; ++symbol)
+    {
+        gate.update_bbo(symbol, price_from_dollars(99.99), price_from_dollars(100.01));
+    }
+
+    struct OrderRequest
+    {
+        SymbolId symbol;
+        OrderSide side;
+        Quantity quantity;
+        Price price;
+    };
+    std::vector<OrderRequest> orders(num_orders);
+    for (auto &order : orders)
+    {
+        order.symbol = static_cast<SymbolId>(gen() % num_symbols + 1);
+        order.side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+        order.quantity = 100 + gen() % 900;
+        order.price = price_from_dollars(100.0) + price_from_dollars(0.01) * cents_dist(gen);
+    }
+
+    EngineClock clock(ClockMode::LIVE);
+    size_t passed = 0;
+    Timestamp start = clock.now();
+    for (size_t i = 0; i < num_checks; ++i)
+    {
+        const OrderRequest &order = orders[i & (num_orders - 1)];
+        passed += gate.check(order.symbol, order.price, order.quantity, order.side, i) == RiskCheck::PASSED;
+    }
+    Timestamp end = clock.now();
+
+    double ns_per_check = static_cast<double>(end - start) / num_checks;
+    std::cout << num_checks << " checks across " << num_symbols << " symbols: " << ns_per_check << " ns/check ("
+              << passed << " passed, " << gate.get_stats().rejected << " rejected), budget 50 ns: "
+              << (ns_per_check < 50.0 ? "within" : "exceeded") << std::endl;
+}
+
+void benchmark_fill_wal()
+{
+    std::cout << "\n=== Fill Write-Ahead Journal Benchmark ===" << std::endl;
+
+    constexpr size_t num_symbols = 64;
+    std::filesystem::path wal_path = std::filesystem::temp_directory_path() / "mm_bench_fills.wal";
+
+    // Record fills back to back (interval 0) or paced at interval_ns apart;
+    // returns time on the trading thread and time until all are durable
+    EngineClock clock(ClockMode::LIVE);
+    auto run = [&](FillWal *wal, size_t num_fills, Timestamp interval_ns)
+    {
+        PositionTracker tracker;
+        tracker.attach_wal(wal);
+        Timestamp busy = 0;
+        Timestamp start = clock.now();
+        for (size_t i = 0; i < num_fills; ++i)
+        {
+            while (interval_ns > 0 && clock.now() < start + i * interval_ns)
+            {
+            }
+            SymbolId symbol = static_cast<SymbolId>(i % num_symbols + 1);
+            OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+            Timestamp before = clock.now();
+            tracker.record_trade(symbol, price_from_dollars(100.0) + static_cast<Price>(i % 100), 100, side, i + 1, before);
+            busy += clock.now() - before;
+        }
+        if (wal)
+        {
+            wal->wait_durable(wal->recovered_sequence() + num_fills);
+        }
+        return std::make_pair(busy, clock.now() - start);
+    };
+
+    constexpr size_t burst_fills = 200000;
+    std::cout << "record_trade without journal: " << static_cast<double>(run(nullptr, burst_fills, 0).first) / burst_fills
+              << " ns/fill" << std::endl;
+
+    struct Load
+    {
+        const char *name;
+        size_t fills;
+        Timestamp interval_ns;
+    };
+    for (const Load &load : {Load{"burst", burst_fills, 0}, Load{"100k fills/s", 20000, 10000}})
+    {
+        std::cout << load.name << ":" << std::endl;
+        for (auto window : {std::chrono::microseconds(0), std::chrono::microseconds(100),
+                            std::chrono::microseconds(1000), std::chrono::microseconds(5000)})
+        {
+            std::filesystem::remove(wal_path);
+            FillWal::Config config;
+            config.group_commit_window = window;
+            FillWal wal(wal_path.string(), config);
+
+            auto [busy_ns, durable_ns] = run(&wal, load.fills, load.interval_ns);
+            FillWal::Stats stats = wal.get_stats();
+            double seconds = static_cast<double>(durable_ns) / 1e9;
+            std::cout << "  window " << std::setw(5) << window.count() << " us: "
+                      << static_cast<double>(busy_ns) / load.fills << " ns/fill on the trading thread, "
+                      << static_cast<uint64_t>(load.fills / seconds) << " durable fills/s, "
+                      << stats.batches << " fdatasyncs (" << static_cast<double>(stats.records) / stats.batches
+                      << " fills/sync, " << static_cast<double>(stats.sync_time_ns) / stats.batches / 1000.0
+                      << " us/sync)" << std::endl;
+        }
+    }
+    std::filesystem::remove(wal_path);
+}
+
+void benchmark_mark_to_market()
+{
+    std::cout << "\n=== Mark-to-Market Benchmark ===" << std::endl;
+
+    EngineClock clock(ClockMode::LIVE);
+    for (size_t num_symbols : {size_t(1000), size_t(10000)})
+    {
+        constexpr int passes = 200;
+        PositionLimits limits;
+        limits.max_drawdown = price_from_dollars(1e9);
+        PositionTracker tracker(limits);
+
+        std::mt19937 gen(5);
+        std::vector<Price> bids(MAX_SYMBOLS, 0);
+        std::vector<Price> asks(MAX_SYMBOLS, 0);
+        for (size_t i = 0; i < num_symbols; ++i)
+        {
+            SymbolId symbol = static_cast<SymbolId>(i);
+            Price base = price_from_dollars(20.0 + gen() % 100);
+            tracker.record_trade(symbol, base, 100 + gen() % 900, OrderSide::BUY, i * 2 + 1, 0);
+            tracker.record_trade(symbol, base + 5, 50 + gen() % 400, OrderSide::SELL, i * 2 + 2, 0);
+            bids[symbol] = base - 1;
+            asks[symbol] = base + 1;
+        }
+
+        // Every pass moves every mark by a tick
+        auto tick = [&](int pass)
+        {
+            Price move = (pass & 1) ? 1 : -1;
+            for (size_t i = 0; i < num_symbols; ++i)
+            {
+                bids[i] += move;
+                asks[i] += move;
+            }
+        };
+
+        std::map<SymbolId, Price> marks;
+        Timestamp map_ns = 0;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            tick(pass);
+            for (size_t i = 0; i < num_symbols; ++i)
+            {
+                marks[static_cast<SymbolId>(i)] = (bids[i] + asks[i]) / 2;
+            }
+            Timestamp start = clock.now();
+            tracker.update_all_unrealized_pnl(marks, start);
+            map_ns += clock.now() - start;
+        }
+
+        Timestamp pass_ns = 0;
+        size_t updated = 0;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            tick(pass);
+            Timestamp start = clock.now();
+            updated += tracker.mark_to_market(bids.data(), asks.data(), start);
+            pass_ns += clock.now() - start;
+        }
+
+        // The kernel alone, over SoA arrays shaped like the tracker's
+        std::vector<int64_t> long_qty(num_symbols), short_qty(num_symbols);
+        std::vector<Price> avg_long(num_symbols), avg_short(num_symbols), out_marks(num_symbols);
+        std::vector<PnL> unrealized(num_symbols), out_pnl(num_symbols);
+        std::vector<uint64_t> changed((num_symbols + 63) / 64);
+        for (size_t i = 0; i < num_symbols; ++i)
+        {
+            long_qty[i] = 100 + gen() % 900;
+            short_qty[i] = 50 + gen() % 400;
+            avg_long[i] = bids[i];
+            avg_short[i] = asks[i] + 4;
+        }
+        MarkToMarketInput input{long_qty.data(), short_qty.data(), avg_long.data(), avg_short.data(),
+                                unrealized.data(), bids.data(), asks.data()};
+        Timestamp kernel_ns = 0;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            tick(pass);
+            Timestamp start = clock.now();
+            mark_to_market_kernel(input, num_symbols, out_marks.data(), out_pnl.data(), changed.data());
+            kernel_ns += clock.now() - start;
+            unrealized.swap(out_pnl);
+            input.unrealized_pnl = unrealized.data();
+        }
+
+        auto per_symbol = [&](Timestamp ns)
+        { return static_cast<double>(ns) / passes / num_symbols; };
+        std::cout << num_symbols << " symbols: map update " << per_symbol(map_ns) << " ns/symbol, "
+                  << "mark_to_market " << per_symbol(pass_ns) << " ns/symbol ("
+                  << static_cast<double>(pass_ns) / passes / 1000.0 << " us/pass, "
+                  << updated / passes << " updated/pass), kernel only " << per_symbol(kernel_ns)
+                  << " ns/symbol" << std::endl;
+    }
+}
+
+void benchmark_lot_matching()
+{
+    std::cout << "\n=== Lot Matching Benchmark ===" << std::endl;
+
+    constexpr size_t num_fills = 4000000;
+    constexpr size_t num_symbols = 64;
+
+    // Alternating buys and sells with uneven sizes, so lots pile up, get
+    // partially closed and the position keeps crossing through flat
+    std::mt19937 gen(17);
+    std::vector<Quantity> sizes(1 << 16);
+    std::vector<Price> prices(1 << 16);
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        sizes[i] = 1 + gen() % 500;
+        prices[i] = price_from_dollars(100.0) + static_cast<Price>(gen() % 200) - 100;
+    }
+
+    EngineClock clock(ClockMode::LIVE);
+    for (LotMethod method : {LotMethod::FIFO, LotMethod::LIFO})
+    {
+        // Raw queue operations
+        LotSegmentPool pool;
+        std::vector<LotQueue> queues(num_symbols);
+        PnL realized = 0;
+        Timestamp start = clock.now();
+        for (size_t i = 0; i < num_fills; ++i)
+        {
+            size_t k = i & (sizes.size() - 1);
+            OrderSide side = (i / num_symbols) & 1 ? OrderSide::SELL : OrderSide::BUY;
+            realized += queues[i % num_symbols].fill(pool, method, prices[k], sizes[k], side, i, i);
+        }
+        Timestamp queue_ns = clock.now() - start;
+
+        size_t open_lots = 0;
+        for (const LotQueue &queue : queues)
+        {
+            open_lots += queue.lot_count();
+        }
+
+        // Through the tracker, including the journal and seqlock publish
+        PositionLimits limits;
+        limits.max_drawdown = price_from_dollars(1e12);
+        limits.max_daily_loss = price_from_dollars(1e12);
+        PositionTracker tracker(limits);
+        tracker.set_lot_method(method);
+        start = clock.now();
+        for (size_t i = 0; i < num_fills; ++i)
+        {
+            size_t k = i & (sizes.size() - 1);
+            OrderSide side = (i / num_symbols) & 1 ? OrderSide::SELL : OrderSide::BUY;
+            tracker.record_trade(static_cast<SymbolId>(i % num_symbols), prices[k], sizes[k], side, i, i);
+        }
+        Timestamp tracker_ns = clock.now() - start;
+
+        std::cout << (method == LotMethod::FIFO ? "FIFO" : "LIFO") << ": " << num_fills << " fills, "
+                  << static_cast<double>(queue_ns) / num_fills << " ns/fill in the lot queue, "
+                  << static_cast<double>(tracker_ns) / num_fills << " ns/fill via record_trade, "
+                  << open_lots << " open lots in " << pool.in_use() << " segments (pool capacity "
+                  << pool.capacity() << "), realized " << price_to_dollars(realized) << std::endl;
+    }
+}
+
+void benchmark_sharded_positions()
+{
+    std::cout << "\n=== Sharded Position Accumulation Benchmark ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    constexpr size_t total_fills = 1 << 20;
+    constexpr size_t num_symbols = 64;
+    EngineClock clock(ClockMode::LIVE);
+
+    // Every writer trades the same symbols, so shared-mode writers collide
+    // on slot locks and the journal while shard writers touch only their own memory
+    auto fill = [](size_t t, size_t i, auto &&record)
+    {
+        SymbolId symbol = static_cast<SymbolId>((i * 7 + t) % num_symbols);
+        OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+        record(symbol, price_from_dollars(50.0) + static_cast<Price>(i % 13), 1 + i % 5, side, i, i);
+    };
+
+    for (size_t num_threads : {size_t(1), size_t(2), size_t(4), size_t(8), size_t(16)})
+    {
+        size_t per_thread = total_fills / num_threads;
+
+        PositionTracker shared;
+        std::vector<std::thread> threads;
+        Timestamp start = clock.now();
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                for (size_t i = 0; i < per_thread; ++i)
+                {
+                    fill(t, i, [&](auto... args) { shared.record_trade(args...); });
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        Timestamp shared_ns = clock.now() - start;
+        threads.clear();
+
+        PositionTracker sharded;
+        std::vector<PositionShard *> shards;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            shards.push_back(&sharded.create_shard());
+        }
+        sharded.start_consolidation(std::chrono::microseconds(500));
+        start = clock.now();
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                for (size_t i = 0; i < per_thread; ++i)
+                {
+                    fill(t, i, [&](auto... args) { shards[t]->record_trade(args...); });
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        Timestamp sharded_ns = clock.now() - start;
+        sharded.stop_consolidation();
+        Timestamp settled_ns = clock.now() - start;
+
+        auto rate = [&](Timestamp ns)
+        { return static_cast<double>(per_thread * num_threads) / (static_cast<double>(ns) / 1e9) / 1e6; };
+        std::cout << std::setw(2) << num_threads << " writers: shared " << rate(shared_ns) << " M fills/s, sharded "
+                  << rate(sharded_ns) << " M fills/s (" << rate(settled_ns) << " M fills/s including final consolidation)"
+                  << std::endl;
+    }
+}
+
+void benchmark_equity_curve()
+{
+    std::cout << "\n=== Equity Curve Benchmark ===" << std::endl;
+
+    EngineClock clock(ClockMode::LIVE);
+    PositionTracker tracker;
+    std::mt19937 gen(9);
+    constexpr size_t trades = 40000;
+    for (size_t i = 0; i < trades; ++i)
+    {
+        OrderSide side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+        tracker.record_trade(static_cast<SymbolId>(i % 100), price_from_dollars(50.0) + gen() % 200, 1 + gen() % 10, side, i, i);
+    }
+
+    // Before the curve, drawdown meant walking the whole trade history
+    Timestamp start = clock.now();
+    size_t history = tracker.get_all_trade_history().size();
+    Timestamp history_ns = clock.now() - start;
+
+    // One sample every 10 ms of engine time, so buckets roll over as they would live
+    constexpr size_t samples = 1000000;
+    constexpr Timestamp step = 10000000;
+    EquityCurve curve;
+    PnL equity = 0;
+    start = clock.now();
+    for (size_t i = 0; i < samples; ++i)
+    {
+        equity += static_cast<PnL>(gen() % 2001) - 1000;
+        curve.sample(equity, i * step);
+    }
+    Timestamp curve_ns = clock.now() - start;
+
+    start = clock.now();
+    for (size_t i = 0; i < samples; ++i)
+    {
+        tracker.sample_equity(i * step);
+    }
+    Timestamp tracker_ns = clock.now() - start;
+
+    std::vector<EquityBucket> buckets(3600);
+    start = clock.now();
+    size_t copied = curve.copy_seconds(buckets.data(), buckets.size());
+    Timestamp copy_ns = clock.now() - start;
+
+    DrawdownStats stats = curve.get_drawdown();
+    std::cout << "Trade history walk (" << history << " trades): " << history_ns / 1000.0 << " us" << std::endl;
+    std::cout << "EquityCurve::sample: " << static_cast<double>(curve_ns) / samples << " ns/sample" << std::endl;
+    std::cout << "PositionTracker::sample_equity: " << static_cast<double>(tracker_ns) / samples << " ns/sample" << std::endl;
+    std::cout << "Copy " << copied << " second buckets: " << copy_ns / 1000.0 << " us" << std::endl;
+    std::cout << "Random walk peak " << stats.peak << ", max drawdown " << stats.max_drawdown << std::endl;
+}
+
+void benchmark_position_file_load()
+{
+    std::cout << "\n=== Position File Load Benchmark ===" << std::endl;
+
+    EngineClock clock(ClockMode::LIVE);
+    std::string path = "/tmp/mm_benchmark_positions.dat";
+    std::remove(path.c_str());
+
+    // Every SymbolId holds a position
+    {
+        MMapPositionTracker tracker(path, PositionLimits(), std::chrono::milliseconds(0));
+        for (size_t i = 1; i < MAX_SYMBOLS; ++i)
+        {
+            tracker.record_trade(static_cast<SymbolId>(i), price_from_dollars(10.0) + static_cast<Price>(i), 100, OrderSide::BUY, i, i);
+        }
+    }
+
+    Timestamp start = clock.now();
+    {
+        PositionFileView view(path);
+        Timestamp open_ns = clock.now() - start;
+
+        Position position;
+        Quantity total = 0;
+        start = clock.now();
+        for (size_t i = 1; i < view.record_count(); ++i)
+        {
+            view.get_position(static_cast<SymbolId>(i), position);
+            total += position.long_quantity;
+        }
+        Timestamp scan_ns = clock.now() - start;
+        std::cout << "View open: " << open_ns / 1000.0 << " us, checked read of all "
+                  << view.record_count() - 1 << " records: " << scan_ns / 1000.0 << " us (" << total << " shares)" << std::endl;
+    }
+
+    start = clock.now();
+    {
+        MMapPositionTracker tracker(path, PositionLimits(), std::chrono::milliseconds(0));
+        Timestamp load_ns = clock.now() - start;
+        std::cout << "Tracker startup with " << tracker.get_stats().total_symbols << " symbols: " << load_ns / 1000.0 << " us" << std::endl;
+    }
+
+    // The same positions as a pre-header bare Position array, rewritten on load
+    {
+        std::vector<Position> legacy(MAX_SYMBOLS);
+        PositionFileView view(path);
+        for (size_t i = 1; i < MAX_SYMBOLS; ++i)
+        {
+            view.get_position(static_cast<SymbolId>(i), legacy[i]);
+        }
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(legacy.data()), static_cast<std::streamsize>(legacy.size() * sizeof(Position)));
+    }
+    start = clock.now();
+    {
+        MMapPositionTracker tracker(path, PositionLimits(), std::chrono::milliseconds(0));
+        std::cout << "Legacy file migration: " << (clock.now() - start) / 1000.0 << " us" << std::endl;
+    }
+    std::remove(path.c_str());
+}
+
+void benchmark_shared_position_view()
+{
+    std::cout << "\n=== Shared-Memory Position View Benchmark ===" << std::endl;
+
+    EngineClock clock(ClockMode::LIVE);
+    constexpr size_t fills = 1 << 20;
+    constexpr size_t num_symbols = 1000;
+    std::string name = "/mm_benchmark_positions_" + std::to_string(getpid());
+
+    auto run_fills = [&](PositionTracker &tracker)
+    {
+        Timestamp start = clock.now();
+        for (size_t i = 0; i < fills; ++i)
+        {
+            OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+            tracker.record_trade(static_cast<SymbolId>(1 + i % num_symbols), price_from_dollars(25.0) + static_cast<Price>(i % 11),
+                                 1 + i % 3, side, i, i);
+        }
+        return static_cast<double>(clock.now() - start) / fills;
+    };
+
+    PositionTracker unpublished;
+    double alone_ns = run_fills(unpublished);
+
+    PositionTracker tracker;
+    double published_ns;
+    {
+        SharedPositionPublisher publisher(tracker, name, std::chrono::microseconds(1000));
+        published_ns = run_fills(tracker);
+    }
+    std::cout << "record_trade: " << alone_ns << " ns/fill unpublished, " << published_ns
+              << " ns/fill with a 1 ms publisher" << std::endl;
+
+    // Cost of one cycle when every symbol changed, and of a full reader scan
+    SharedPositionPublisher publisher(tracker, name, std::chrono::microseconds(0));
+    SharedPositionReader reader(name);
+    for (size_t i = 0; i < num_symbols; ++i)
+    {
+        tracker.record_trade(static_cast<SymbolId>(1 + i), price_from_dollars(25.0), 1, OrderSide::BUY, i, i);
+    }
+    Timestamp start = clock.now();
+    size_t published = publisher.publish();
+    Timestamp publish_ns = clock.now() - start;
+
+    std::vector<Position> positions;
+    start = clock.now();
+    size_t read = reader.get_positions(positions);
+    Timestamp read_ns = clock.now() - start;
+
+    Position position;
+    constexpr size_t point_reads = 1000000;
+    start = clock.now();
+    for (size_t i = 0; i < point_reads; ++i)
+    {
+        reader.get_position(static_cast<SymbolId>(1 + i % num_symbols), position);
+    }
+    Timestamp point_ns = clock.now() - start;
+
+    std::cout << "Publish cycle: " << published << " positions in " << publish_ns / 1000.0 << " us" << std::endl;
+    std::cout << "Reader scan: " << read << " positions in " << read_ns / 1000.0 << " us, point read "
+              << static_cast<double>(point_ns) / point_reads << " ns" << std::endl;
+}
+
+void benchmark_portfolio_var()
+{
+    std::cout << "\n=== Portfolio VaR Benchmark ===" << std::endl;
+
+    EngineClock clock(ClockMode::LIVE);
+    for (size_t num_symbols : {size_t(100), size_t(1000)})
+    {
+        PortfolioVaRConfig config;
+        config.capacity = num_symbols;
+        PortfolioVaR var(config);
+
+        std::mt19937 gen(13);
+        std::vector<Price> bids(MAX_SYMBOLS, 0), asks(MAX_SYMBOLS, 0);
+        for (size_t i = 0; i < num_symbols; ++i)
+        {
+            bids[i] = price_from_dollars(10.0 + gen() % 90);
+            asks[i] = bids[i] + 2;
+            var.add_symbol(static_cast<SymbolId>(i));
+        }
+
+        constexpr int observations = 50;
+        Timestamp observe_ns = 0;
+        for (int round = 0; round < observations; ++round)
+        {
+            Price market = static_cast<Price>(gen() % 201) - 100;
+            for (size_t i = 0; i < num_symbols; ++i)
+            {
+                Price move = market + static_cast<Price>(gen() % 101) - 50;
+                bids[i] += move;
+                asks[i] += move;
+            }
+            Timestamp start = clock.now();
+            var.observe(bids.data(), asks.data());
+            observe_ns += clock.now() - start;
+        }
+
+        constexpr size_t fills = 200000;
+        std::vector<SymbolId> symbols(fills);
+        std::vector<Quantity> quantities(fills);
+        for (size_t i = 0; i < fills; ++i)
+        {
+            symbols[i] = static_cast<SymbolId>(gen() % num_symbols);
+            quantities[i] = 1 + gen() % 100;
+        }
+        Timestamp start = clock.now();
+        PnL checksum = 0;
+        for (size_t i = 0; i < fills; ++i)
+        {
+            var.on_fill(symbols[i], (i & 1) ? OrderSide::SELL : OrderSide::BUY, quantities[i]);
+            checksum += var.value_at_risk();
+        }
+        Timestamp fill_ns = clock.now() - start;
+
+        // What a fill would cost without the incremental state: q'Cq from
+        // scratch over the same padded rows and dot kernel
+        constexpr int recomputes = 20;
+        double full = 0;
+        start = clock.now();
+        for (int r = 0; r < recomputes; ++r)
+        {
+            full = var.full_variance();
+        }
+        Timestamp full_ns = (clock.now() - start) / recomputes;
+
+        start = clock.now();
+        constexpr size_t what_ifs = 1000000;
+        for (size_t i = 0; i < what_ifs; ++i)
+        {
+            checksum += var.value_at_risk_after(symbols[i % fills], 100);
+        }
+        Timestamp what_if_ns = clock.now() - start;
+
+        std::cout << num_symbols << " symbols: fill + VaR " << static_cast<double>(fill_ns) / fills << " ns, full q'Cq recompute "
+                  << full_ns / 1000.0 << " us, what-if " << static_cast<double>(what_if_ns) / what_ifs << " ns, observation "
+                  << observe_ns / observations / 1000.0 << " us (VaR $" << price_to_dollars(var.value_at_risk())
+                  << ", relative drift " << std::abs(var.variance() - full) / full << ", " << (checksum & 1) << ")" << std::endl;
+    }
+}
+
+void benchmark_batched_feed_apply()
+{
+    std::cout << "\n=== Batched Feed Apply Benchmark ===" << std::endl;
+
+    constexpr size_t num_live_orders = 10000000;
+    constexpr size_t num_symbols = 64;
+    constexpr size_t num_events = 1000000;
+    constexpr size_t setup_chunk = 1 << 16;
+
+    OrderBookManager order_books;
+    std::mt19937_64 gen(7);
+    std::uniform_int_distribution<int> tick_dist(-1000, 1000);
+    std::uniform_int_distribution<size_t> live_dist(0, num_live_orders - 1);
+
+    auto make_add = [&](OrderId order_id, Timestamp now)
+    {
+        BookUpdate update{};
+        update.type = BookUpdateType::ADD;
+        update.side = (order_id & 1) ? OrderSide::BUY : OrderSide::SELL;
+        update.symbol = static_cast<SymbolId>(order_id % num_symbols + 1);
+        update.quantity = 1000000;
+        update.order_id = order_id;
+        Price offset = price_from_dollars(0.01) * (tick_dist(gen) + (update.side == OrderSide::BUY ? -1001 : 1001));
+        update.price = price_from_dollars(100.0) + offset;
+        update.timestamp = now;
+        return update;
+    };
+
+    std::vector<OrderId> live(num_live_orders);
+    std::vector<BookUpdate> updates;
+    updates.reserve(setup_chunk);
+    OrderId next_id = 1;
+    Timestamp now = 0;
+
+    std::cout << "Building " << num_live_orders << " live orders across " << num_symbols << " books..." << std::endl;
+    for (size_t i = 0; i < num_live_orders; ++i)
+    {
+        live[i] = next_id;
+        updates.push_back(make_add(next_id++, ++now));
+        if (updates.size() == setup_chunk || i + 1 == num_live_orders)
+        {
+            order_books.apply_batch(updates.data(), updates.size());
+            updates.clear();
+        }
+    }
+
+    // Half executes, half delete + re-add, against uniformly random live orders
+    auto make_stream = [&]()
+    {
+        std::vector<BookUpdate> stream;
+        stream.reserve(num_events * 3 / 2 + 1);
+        for (size_t i = 0; i < num_events; ++i)
+        {
+            size_t k = live_dist(gen);
+            BookUpdate update{};
+            update.symbol = static_cast<SymbolId>(live[k] % num_symbols + 1);
+            update.order_id = live[k];
+            update.timestamp = ++now;
+            if (gen() & 1)
+            {
+                update.type = BookUpdateType::EXECUTE;
+                update.quantity = 1;
+                stream.push_back(update);
+            }
+            else
+            {
+                update.type = BookUpdateType::DELETE;
+                stream.push_back(update);
+                live[k] = next_id;
+                stream.push_back(make_add(next_id++, now));
+            }
+        }
+        return stream;
+    };
+
+    // Both paths group, look up and lock books the same way; only the
+    // prefetch stages differ
+    auto run = [&](const char *name, bool prefetch)
+    {
+        std::vector<BookUpdate> stream = make_stream();
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t applied = order_books.apply_batch(stream.data(), stream.size(), prefetch);
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << name << ": " << stream.size() << " messages (" << applied << " applied) in "
+                  << seconds * 1000.0 << " ms, " << stream.size() / seconds << " messages/second" << std::endl;
+        return stream.size() / seconds;
+    };
+
+    double plain = run("Batched apply, no prefetch", false);
+    double prefetched = run("Batched prefetch apply", true);
+    std::cout << "Prefetch speedup: " << prefetched / plain << "x" << std::endl;
+}
+
+void benchmark_fill_simulator()
+{
+    std::cout << "\n=== Queue Fill Simulator Benchmark ===" << std::endl;
+
+    constexpr size_t num_symbols = 256;
+    constexpr size_t quotes_per_symbol = 8;
+    constexpr size_t num_live_orders = 200000;
+    constexpr size_t num_events = 1000000;
+
+    std::mt19937_64 gen(11);
+    std::uniform_int_distribution<int> tick_dist(1, 20);
+    std::uniform_int_distribution<size_t> live_dist(0, num_live_orders - 1);
+    const Price tick = price_from_dollars(0.01);
+
+    auto make_add = [&](OrderId order_id, Timestamp now)
+    {
+        BookUpdate update{};
+        update.type = BookUpdateType::ADD;
+        update.side = (order_id & 1) ? OrderSide::BUY : OrderSide::SELL;
+        update.symbol = static_cast<SymbolId>(order_id % num_symbols + 1);
+        update.quantity = 100 * (1 + order_id % 5);
+        update.order_id = order_id;
+        Price offset = tick * tick_dist(gen);
+        update.price = price_from_dollars(100.0) + (update.side == OrderSide::BUY ? -offset : offset);
+        update.timestamp = now;
+        return update;
+    };
+
+    // The same book built twice, one copy behind the simulator
+    std::vector<BookUpdate> setup;
+    setup.reserve(num_live_orders);
+    std::vector<OrderId> live(num_live_orders);
+    OrderId next_id = 1;
+    Timestamp now = 0;
+    for (size_t i = 0; i < num_live_orders; ++i)
+    {
+        live[i] = next_id;
+        setup.push_back(make_add(next_id++, ++now));
+    }
+    OrderBookManager raw_market(4096, 256);
+    OrderBookManager sim_market(4096, 256);
+    raw_market.apply(setup.data(), setup.size());
+    sim_market.apply(setup.data(), setup.size());
+
+    QueueFillSimulator simulator(sim_market);
+    OrderId quote_id = OrderId(1) << 40;
+    for (size_t s = 0; s < num_symbols; ++s)
+    {
+        for (size_t q = 0; q < quotes_per_symbol; ++q)
+        {
+            OrderSide side = (q & 1) ? OrderSide::BUY : OrderSide::SELL;
+            Price offset = tick * static_cast<Price>(1 + q / 2);
+            Price price = price_from_dollars(100.0) + (side == OrderSide::BUY ? -offset : offset);
+            simulator.add_order(static_cast<SymbolId>(s + 1), quote_id++, price, 100, side, now);
+        }
+    }
+    size_t tracked = simulator.get_stats().working_orders;
+
+    // Executes, partial cancels and delete + re-add against random live orders
+    std::vector<BookUpdate> stream;
+    stream.reserve(num_events * 4 / 3 + 1);
+    for (size_t i = 0; i < num_events; ++i)
+    {
+        size_t k = live_dist(gen);
+        BookUpdate update{};
+        update.symbol = static_cast<SymbolId>(live[k] % num_symbols + 1);
+        update.order_id = live[k];
+        update.timestamp = ++now;
+        switch (gen() % 3)
+        {
+        case 0:
+            update.type = BookUpdateType::EXECUTE;
+            update.quantity = 10;
+            stream.push_back(update);
+            break;
+        case 1:
+            update.type = BookUpdateType::CANCEL;
+            update.quantity = 10;
+            stream.push_back(update);
+            break;
+        default:
+            update.type = BookUpdateType::DELETE;
+            stream.push_back(update);
+            live[k] = next_id;
+            stream.push_back(make_add(next_id++, now));
+            break;
+        }
+    }
+
+    auto run = [&](const char *name, auto &&apply)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t applied = apply();
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / stream.size();
+        std::cout << name << ": " << stream.size() << " messages (" << applied << " applied), "
+                  << ns << " ns/message" << std::endl;
+        return ns;
+    };
+
+    double raw = run("Market book only", [&]() { return raw_market.apply(stream.data(), stream.size()); });
+    double simulated = run("With fill simulator", [&]() { return simulator.apply(stream.data(), stream.size()); });
+
+    const QueueFillSimulator::Stats &stats = simulator.get_stats();
+    std::cout << "Tracked quotes: " << tracked << " across " << num_symbols << " symbols, "
+              << stats.fills << " fills (" << stats.filled_quantity << " shares), "
+              << stats.working_orders << " still working" << std::endl;
+    std::cout << "Queue tracking overhead: " << simulated - raw << " ns/message" << std::endl;
 }
 
 void test_market_making_scenario()
@@ -139,22 +1679,23 @@ void test_market_making_scenario()
     limits.max_long_position = 5000;
     limits.max_short_position = 5000;
     PositionTracker position_tracker(limits);
+    EngineClock clock(ClockMode::LIVE);
 
     std::cout << "Placing initial market making orders..." << std::endl;
 
-    order_book.add_order(1, price_from_dollars(100.00), 1000, OrderSide::BUY);
+    order_book.add_order(1, price_from_dollars(100.00), 1000, OrderSide::BUY, clock.now());
     std::cout << "Placed bid: 1000 @ $100.00" << std::endl;
 
-    order_book.add_order(2, price_from_dollars(100.10), 1000, OrderSide::SELL);
+    order_book.add_order(2, price_from_dollars(100.10), 1000, OrderSide::SELL, clock.now());
     std::cout << "Placed ask: 1000 @ $100.10" << std::endl;
 
     print_order_book_stats(order_book);
 
     std::cout << "\nSimulating trade against our bid..." << std::endl;
-    bool executed = order_book.execute_trade(price_from_dollars(100.00), 500, OrderSide::SELL);
+    bool executed = order_book.execute_trade(price_from_dollars(100.00), 500, OrderSide::SELL, clock.now());
     if (executed)
     {
-        position_tracker.record_trade(1, price_from_dollars(100.00), 500, OrderSide::BUY, 1);
+        position_tracker.record_trade(1, price_from_dollars(100.00), 500, OrderSide::BUY, 1, clock.now());
         std::cout << "Executed: 500 @ $100.00 (BUY)" << std::endl;
     }
 
@@ -162,10 +1703,10 @@ void test_market_making_scenario()
     print_position_stats(position_tracker);
 
     std::cout << "\nSimulating trade against our ask..." << std::endl;
-    executed = order_book.execute_trade(price_from_dollars(100.10), 300, OrderSide::BUY);
+    executed = order_book.execute_trade(price_from_dollars(100.10), 300, OrderSide::BUY, clock.now());
     if (executed)
     {
-        position_tracker.record_trade(1, price_from_dollars(100.10), 300, OrderSide::SELL, 2);
+        position_tracker.record_trade(1, price_from_dollars(100.10), 300, OrderSide::SELL, 2, clock.now());
         std::cout << "Executed: 300 @ $100.10 (SELL)" << std::endl;
     }
 
@@ -174,7 +1715,7 @@ void test_market_making_scenario()
 
     std::cout << "\nUpdating unrealized P&L..." << std::endl;
     Price current_price = price_from_dollars(100.05); // Mid price
-    position_tracker.update_unrealized_pnl(1, current_price);
+    position_tracker.update_unrealized_pnl(1, current_price, clock.now());
 
     print_position_stats(position_tracker);
 }
@@ -189,8 +1730,9 @@ void test_itch_data_processing()
     limits.max_long_position = 50000;
     limits.max_short_position = 50000;
     PositionTracker position_tracker(limits);
+    EngineClock clock(ClockMode::REPLAY);
 
-    ITCHParser parser(order_books, position_tracker);
+    ITCHParser parser(order_books, position_tracker, clock);
 
     std::string itch_file = "data/sample.itch";
     if (!std::filesystem::exists(itch_file))
@@ -243,6 +1785,57 @@ void test_itch_data_processing()
     }
 }
 
+void test_multi_day_replay()
+{
+    std::cout << "\n=== Multi-Day Replay Test ===" << std::endl;
+
+    std::vector<std::string> day_files;
+    if (std::filesystem::exists("data"))
+    {
+        for (const auto &entry : std::filesystem::directory_iterator("data"))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".itch")
+            {
+                day_files.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(day_files.begin(), day_files.end());
+
+    if (day_files.empty())
+    {
+        std::cout << "No ITCH day files found in data/" << std::endl;
+        std::cout << "Skipping multi-day replay test." << std::endl;
+        return;
+    }
+
+    MultiDayReplayDriver::Config config;
+    config.memory_cap_bytes = size_t(2) << 30;
+    config.limits.max_position_size = 100000;
+    config.limits.max_long_position = 50000;
+    config.limits.max_short_position = 50000;
+    MultiDayReplayDriver driver(config);
+
+    ReplayReport report = driver.run(day_files);
+
+    std::cout << "Replay Report:" << std::endl;
+    for (const auto &day : report.days)
+    {
+        std::cout << "  " << day.filename << " (" << day.file_size << " bytes, worker " << day.worker << "): "
+                  << (day.success ? "OK" : day.error_message) << ", "
+                  << day.parser_stats.total_messages << " messages, "
+                  << day.active_symbols << " books, "
+                  << day.memory_usage_bytes / (1024 * 1024) << " MB, "
+                  << day.wall_time_ms << " ms" << std::endl;
+    }
+    std::cout << "  Days: " << report.days.size() << " (" << report.failed_days << " failed)" << std::endl;
+    std::cout << "  Total Messages: " << report.totals.total_messages << std::endl;
+    std::cout << "  Total Errors: " << report.totals.errors << std::endl;
+    std::cout << "  Total Realized P&L: " << price_to_dollars(report.total_realized_pnl) << std::endl;
+    std::cout << "  Peak Day Memory: " << report.peak_memory_usage_bytes / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "  Makespan: " << report.makespan_ms << " ms" << std::endl;
+}
+
 void test_scenario_runner()
 {
     std::cout << "\n=== Scenario Runner Test ===" << std::endl;
@@ -310,21 +1903,25 @@ void test_strategy_simulation()
 {
     std::cout << "\n=== Market Making Strategy Simulation ===" << std::endl;
 
+    // A synthetic market feed (passive adds, cancels and aggressive orders
+    // around a drifting mid) runs through a QueueFillSimulator; our quotes
+    // fill only once the market volume queued ahead of them has gone
     constexpr size_t num_symbols = 2;
-    std::array<SymbolId, MAX_STRATEGY_SYMBOLS> symbols = {1, 2};
+    constexpr int num_rounds = 200;
+    const Price tick = price_from_dollars(0.01);
+    std::vector<SymbolId> symbols = {1, 2};
 
-    std::unique_ptr<OrderBookManager> order_books = std::make_unique<OrderBookManager>();
+    std::unique_ptr<OrderBookManager> market;
     PositionLimits limits;
     limits.max_position_size = 10000;
     limits.max_long_position = 5000;
     limits.max_short_position = 5000;
-    std::unique_ptr<PositionTracker> position_tracker = std::make_unique<PositionTracker>(limits);
+    std::unique_ptr<PositionTracker> position_tracker;
 
     FixedSpreadStrategy::Config fixed_cfg;
     fixed_cfg.base_price = price_from_dollars(100.00);
     fixed_cfg.spread = price_from_dollars(0.10);
     fixed_cfg.quote_size = 100;
-    fixed_cfg.num_symbols = num_symbols;
     fixed_cfg.symbols = symbols;
     FixedSpreadStrategy fixed_strategy(fixed_cfg);
 
@@ -334,63 +1931,175 @@ void test_strategy_simulation()
     inv_cfg.max_spread = price_from_dollars(0.20);
     inv_cfg.quote_size = 100;
     inv_cfg.max_inventory = 1000;
-    inv_cfg.num_symbols = num_symbols;
     inv_cfg.symbols = symbols;
     InventorySkewedStrategy inv_strategy(inv_cfg);
 
     for (int strat = 0; strat < 2; ++strat)
     {
         std::cout << "\n--- Simulating " << (strat == 0 ? "FixedSpreadStrategy" : "InventorySkewedStrategy") << " ---" << std::endl;
-        order_books = std::make_unique<OrderBookManager>();
+        market = std::make_unique<OrderBookManager>();
         position_tracker = std::make_unique<PositionTracker>(limits);
         MarketMakingStrategy *strategy = (strat == 0) ? (MarketMakingStrategy *)&fixed_strategy : (MarketMakingStrategy *)&inv_strategy;
 
+        QueueFillSimulator simulator(*market);
+        strategy->set_fill_simulator(&simulator);
+
+        RiskGateLimits gate_limits;
+        gate_limits.max_long_position = limits.max_long_position;
+        gate_limits.max_short_position = limits.max_short_position;
+        PreTradeRiskGate risk_gate(gate_limits);
+        strategy->set_risk_gate(&risk_gate);
+
+        // Quote everything once, then re-quote only symbols that moved or filled
+        StrategyDispatcher dispatcher;
+        dispatcher.add_strategy(strategy);
+        strategy->update_quotes(*market, *position_tracker, 0);
+
         std::mt19937 gen(42 + strat);
-        std::uniform_int_distribution<int> symbol_dist(0, num_symbols - 1);
-        std::uniform_real_distribution<double> trade_prob(0.0, 1.0);
+        std::uniform_int_distribution<int> step_dist(-1, 1);
+        std::uniform_int_distribution<int> level_dist(1, 4);
+        std::uniform_int_distribution<int> lots_dist(1, 5);
+        std::uniform_real_distribution<double> prob(0.0, 1.0);
 
-        for (int round = 0; round < 20; ++round)
+        // Market orders resting in each symbol's book, in arrival order
+        struct FeedOrder
         {
-            Timestamp now = round * 1000000;
-            strategy->update_quotes(*order_books, *position_tracker, now);
+            OrderId order_id;
+            Price price;
+            Quantity remaining;
+            OrderSide side;
+        };
+        std::vector<std::vector<FeedOrder>> resting(num_symbols);
+        std::vector<Price> mids(num_symbols, price_from_dollars(100.00));
+        std::vector<BookUpdate> feed;
+        OrderId next_market_id = 1;
+        Timestamp now = 0;
+
+        auto emit = [&](BookUpdateType type, size_t i, OrderId order_id, Price price, Quantity quantity, OrderSide side)
+        {
+            BookUpdate update{};
+            update.type = type;
+            update.side = side;
+            update.symbol = symbols[i];
+            update.quantity = quantity;
+            update.order_id = order_id;
+            update.price = price;
+            update.timestamp = ++now;
+            feed.push_back(update);
+        };
+
+        // An incoming order trades with the best opposite orders in
+        // price-time priority; a passive remainder rests
+        auto submit = [&](size_t i, OrderSide side, Price price, Quantity quantity, bool rest)
+        {
+            std::vector<FeedOrder> &book = resting[i];
+            while (quantity > 0)
+            {
+                size_t best = book.size();
+                for (size_t k = 0; k < book.size(); ++k)
+                {
+                    const FeedOrder &order = book[k];
+                    bool crosses = side == OrderSide::BUY ? order.side == OrderSide::SELL && order.price <= price
+                                                          : order.side == OrderSide::BUY && order.price >= price;
+                    if (crosses && (best == book.size() || (side == OrderSide::BUY ? order.price < book[best].price
+                                                                                    : order.price > book[best].price)))
+                    {
+                        best = k;
+                    }
+                }
+                if (best == book.size())
+                {
+                    break;
+                }
+                Quantity traded = std::min(quantity, book[best].remaining);
+                emit(BookUpdateType::EXECUTE, i, book[best].order_id, 0, traded, book[best].side);
+                quantity -= traded;
+                if ((book[best].remaining -= traded) == 0)
+                {
+                    book.erase(book.begin() + best);
+                }
+            }
+            if (rest && quantity > 0)
+            {
+                OrderId order_id = next_market_id++;
+                book.push_back(FeedOrder{order_id, price, quantity, side});
+                emit(BookUpdateType::ADD, i, order_id, price, quantity, side);
+            }
+        };
+
+        for (int round = 0; round < num_rounds; ++round)
+        {
+            feed.clear();
             for (size_t i = 0; i < num_symbols; ++i)
             {
-                SymbolId symbol = symbols[i];
-                const OrderBook *ob = order_books->get_order_book(symbol);
-                if (!ob)
-                    continue;
-                auto [bid, bid_qty] = ob->get_best_bid();
-                auto [ask, ask_qty] = ob->get_best_ask();
-                if (trade_prob(gen) < 0.5 && bid > 0)
+                // Random walk held within 8 ticks of the strategies' base price
+                int step = step_dist(gen);
+                Price drift = mids[i] - price_from_dollars(100.00);
+                if ((step > 0 && drift >= 8 * tick) || (step < 0 && drift <= -8 * tick))
+                {
+                    step = -step;
+                }
+                mids[i] += tick * step;
+                for (int n = 0; n < 3; ++n)
+                {
+                    OrderSide side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+                    Price offset = tick * level_dist(gen);
+                    submit(i, side, side == OrderSide::BUY ? mids[i] - offset : mids[i] + offset, 100 * lots_dist(gen), true);
+                }
+                for (int n = 0; n < 2 && !resting[i].empty(); ++n)
                 {
-                    Quantity qty = 10 + (gen() % 20);
-                    order_books->execute_trade(symbol, bid, qty, OrderSide::SELL);
-                    position_tracker->record_trade(symbol, bid, qty, OrderSide::BUY, 100000 + round * 10 + i);
-                    strategy->on_trade(symbol, bid, qty, OrderSide::BUY, now);
+                    size_t k = gen() % resting[i].size();
+                    FeedOrder &order = resting[i][k];
+                    if (order.remaining > 100 && prob(gen) < 0.5)
+                    {
+                        emit(BookUpdateType::CANCEL, i, order.order_id, 0, order.remaining / 2, order.side);
+                        order.remaining -= order.remaining / 2;
+                    }
+                    else
+                    {
+                        emit(BookUpdateType::DELETE, i, order.order_id, 0, 0, order.side);
+                        resting[i].erase(resting[i].begin() + k);
+                    }
                 }
-                if (trade_prob(gen) < 0.5 && ask > 0)
+                if (prob(gen) < 0.6)
                 {
-                    Quantity qty = 10 + (gen() % 20);
-                    order_books->execute_trade(symbol, ask, qty, OrderSide::BUY);
-                    position_tracker->record_trade(symbol, ask, qty, OrderSide::SELL, 200000 + round * 10 + i);
-                    strategy->on_trade(symbol, ask, qty, OrderSide::SELL, now);
+                    OrderSide side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+                    Price limit = side == OrderSide::BUY ? mids[i] + 6 * tick : mids[i] - 6 * tick;
+                    submit(i, side, limit, 100 * lots_dist(gen), false);
                 }
-                const Position *pos = position_tracker->get_position(symbol);
-                if (pos)
+            }
+
+            simulator.apply(feed.data(), feed.size());
+            dispatcher.touch(feed.data(), feed.size());
+            for (const SimulatedFill &fill : simulator.get_fills())
+            {
+                position_tracker->record_trade(fill.symbol, fill.price, fill.quantity, fill.side, fill.order_id, fill.timestamp);
+                dispatcher.on_fill(fill.symbol, fill.price, fill.quantity, fill.side, fill.timestamp);
+            }
+            simulator.clear_fills();
+
+            position_tracker->mark_to_market(market->best_bids(), market->best_asks(), now);
+            for (SymbolId symbol : symbols)
+            {
+                BestBidOffer bbo = market->get_bbo(symbol);
+                risk_gate.update_bbo(symbol, bbo.bid, bbo.ask);
+                Position pos;
+                if (position_tracker->get_position(symbol, pos))
                 {
-                    strategy->on_position_update(symbol, *pos, position_tracker->get_stats(), now);
+                    strategy->on_position_update(symbol, pos, position_tracker->get_stats(), now);
                 }
             }
+            dispatcher.dispatch(*market, *position_tracker, now);
         }
         for (size_t i = 0; i < num_symbols; ++i)
         {
             SymbolId symbol = symbols[i];
-            const Position *pos = position_tracker->get_position(symbol);
+            Position pos;
             std::cout << "Symbol " << symbol << ": ";
-            if (pos)
+            if (position_tracker->get_position(symbol, pos))
             {
-                std::cout << "NetPos=" << pos->get_net_position() << ", RealizedPnL=" << price_to_dollars(pos->realized_pnl)
-                          << ", UnrealizedPnL=" << price_to_dollars(pos->unrealized_pnl) << std::endl;
+                std::cout << "NetPos=" << pos.get_net_position() << ", RealizedPnL=" << price_to_dollars(pos.realized_pnl)
+                          << ", UnrealizedPnL=" << price_to_dollars(pos.unrealized_pnl) << std::endl;
             }
             else
             {
@@ -399,6 +2108,18 @@ void test_strategy_simulation()
         }
         auto stats = position_tracker->get_stats();
         std::cout << "Total P&L: " << price_to_dollars(stats.total_pnl) << std::endl;
+        const QueueFillSimulator::Stats &sim_stats = simulator.get_stats();
+        std::cout << "Fills: " << sim_stats.fills << " (" << sim_stats.filled_quantity << " shares) from "
+                  << sim_stats.feed_events << " feed events" << std::endl;
+        std::cout << "Risk gate: " << risk_gate.get_stats().checks << " checks, "
+                  << risk_gate.get_stats().rejected << " rejected" << std::endl;
+        const QuoteManager::Stats &quote_stats = strategy->get_quote_stats();
+        std::cout << "Quotes: " << quote_stats.new_orders << " new, " << quote_stats.amends << " amended, "
+                  << quote_stats.cancels << " cancelled, " << quote_stats.unchanged << " unchanged" << std::endl;
+        std::cout << "Dispatch: " << dispatcher.get_stats().changed << " symbol updates over "
+                  << dispatcher.get_stats().dispatches << " rounds" << std::endl;
+        strategy->set_risk_gate(nullptr);
+        strategy->set_fill_simulator(nullptr);
     }
 }
 
@@ -412,9 +2133,28 @@ int main()
         test_market_making_scenario();
 
         benchmark_order_book_operations();
+        benchmark_quote_manager();
+        benchmark_strategy_dispatch();
+        benchmark_strategy_cycle();
+        benchmark_policy_strategy();
+        benchmark_signal_strategies();
         benchmark_position_tracker();
+        benchmark_position_contention();
+        benchmark_risk_gate();
+        benchmark_portfolio_var();
+        benchmark_fill_wal();
+        benchmark_mark_to_market();
+        benchmark_lot_matching();
+        benchmark_sharded_positions();
+        benchmark_equity_curve();
+        benchmark_position_file_load();
+        benchmark_shared_position_view();
+        benchmark_batched_feed_apply();
+        benchmark_fill_simulator();
 
         test_itch_data_processing();
+        test_multi_day_replay();
+        benchmark_parameter_sweep();
 
         test_scenario_runner();
 
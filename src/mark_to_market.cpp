@@ -0,0 +1,78 @@
+#include "mark_to_market.hpp"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace mm
+{
+
+    namespace
+    {
+#if defined(__AVX2__)
+        // Low 64 bits of a * b for signed 64-bit a and 0 <= b < 2^32; AVX2
+        // has no 64-bit multiply, so combine two 32x32 products
+        inline __m256i mul_i64_u32(__m256i a, __m256i b)
+        {
+            __m256i low = _mm256_mul_epu32(a, b);
+            __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+            return _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+        }
+#endif
+    }
+
+    void mark_to_market_kernel(const MarkToMarketInput &input, size_t count, Price *marks, PnL *pnl, uint64_t *changed)
+    {
+        std::memset(changed, 0, (count + 63) / 64 * sizeof(uint64_t));
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        auto load = [](const int64_t *p)
+        { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); };
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i bid = load(input.best_bid + i);
+            __m256i ask = load(input.best_ask + i);
+            __m256i valid = _mm256_and_si256(_mm256_cmpgt_epi64(bid, zero), _mm256_cmpgt_epi64(ask, zero));
+            // Both sides positive on valid lanes, so a logical shift halves correctly
+            __m256i mid = _mm256_srli_epi64(_mm256_add_epi64(bid, ask), 1);
+
+            __m256i long_pnl = mul_i64_u32(_mm256_sub_epi64(mid, load(input.avg_long_price + i)), load(input.long_quantity + i));
+            __m256i short_pnl = mul_i64_u32(_mm256_sub_epi64(load(input.avg_short_price + i), mid), load(input.short_quantity + i));
+
+            __m256i current = load(input.unrealized_pnl + i);
+            __m256i result = _mm256_blendv_epi8(current, _mm256_add_epi64(long_pnl, short_pnl), valid);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(marks + i), mid);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(pnl + i), result);
+
+            // i is a multiple of 4, so the four bits never straddle a word
+            uint64_t same = static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(result, current))));
+            changed[i / 64] |= (~same & 0xF) << (i % 64);
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            PnL current = input.unrealized_pnl[i];
+            PnL result = current;
+            Price bid = input.best_bid[i];
+            Price ask = input.best_ask[i];
+            if (bid > 0 && ask > 0)
+            {
+                Price mid = (bid + ask) / 2;
+                marks[i] = mid;
+                result = (mid - input.avg_long_price[i]) * input.long_quantity[i] +
+                         (input.avg_short_price[i] - mid) * input.short_quantity[i];
+            }
+            pnl[i] = result;
+            if (result != current)
+            {
+                changed[i / 64] |= 1ull << (i % 64);
+            }
+        }
+    }
+
+}
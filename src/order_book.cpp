@@ -5,16 +5,28 @@
 namespace mm
 {
 
-    OrderBook::OrderBook(SymbolId symbol)
-        : symbol_(symbol), order_pool_(10000), level_pool_(1000)
+    OrderBook::OrderBook(SymbolId symbol, size_t order_capacity, size_t level_capacity)
+        : symbol_(symbol), order_pool_(order_capacity), level_pool_(level_capacity)
     {
     }
 
-    bool OrderBook::add_order(OrderId order_id, Price price, Quantity quantity, OrderSide side, OrderType type)
+    size_t OrderBook::memory_usage() const
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        return order_pool_.capacity() * sizeof(Order) + level_pool_.capacity() * sizeof(PriceLevel) + orders_.memory_usage();
+    }
+
+    bool OrderBook::add_order(OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now, OrderType type)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool added = add_order_internal(order_id, price, quantity, side, now, type);
+        publish_bbo();
+        return added;
+    }
 
-        if (orders_.find(order_id) != orders_.end())
+    bool OrderBook::add_order_internal(OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now, OrderType type)
+    {
+        if (orders_.find(order_id) != nullptr)
         {
             return false;
         }
@@ -28,18 +40,19 @@ namespace mm
         order->side = side;
         order->type = type;
         order->status = OrderStatus::ACTIVE;
-        order->timestamp = get_timestamp();
+        order->timestamp = now;
 
-        order->level = get_or_create_level(price, side);
+        order->level = get_or_create_level(price, side, now);
+        link_order(order->level, order);
 
-        orders_[order_id] = order;
+        orders_.insert(order_id, order);
 
-        update_level_stats(order->level, quantity, true);
+        update_level_stats(order->level, quantity, true, now);
 
         return true;
     }
 
-    bool OrderBook::cancel_order(OrderId order_id, Quantity quantity)
+    bool OrderBook::cancel_order(OrderId order_id, Timestamp now, Quantity quantity)
     {
         std::lock_guard<std::mutex> lock(mutex_);
 
@@ -49,31 +62,38 @@ namespace mm
             return false;
         }
 
-        Quantity cancel_qty = (quantity == 0) ? order->quantity - order->filled_quantity : quantity;
-        if (cancel_qty > order->quantity - order->filled_quantity)
-        {
-            cancel_qty = order->quantity - order->filled_quantity;
-        }
+        bool reduced = reduce_order_internal(order, quantity, now);
+        publish_bbo();
+        return reduced;
+    }
 
-        order->filled_quantity += cancel_qty;
-        if (order->filled_quantity >= order->quantity)
-        {
-            order->status = OrderStatus::FILLED;
-        }
+    // Removes quantity (0 = all remaining) from a resting order; the order and
+    // its level are released once nothing is left
+    bool OrderBook::reduce_order_internal(Order *order, Quantity quantity, Timestamp now)
+    {
+        Quantity remaining = order->quantity - order->filled_quantity;
+        Quantity reduce_qty = (quantity == 0 || quantity > remaining) ? remaining : quantity;
 
-        update_level_stats(order->level, cancel_qty, false);
+        order->filled_quantity += reduce_qty;
+        PriceLevel *level = order->level;
+        level->total_quantity -= reduce_qty;
+        level->last_update = now;
 
-        if (order->status == OrderStatus::FILLED)
+        if (order->filled_quantity >= order->quantity)
         {
-            remove_order_from_level(order);
-            orders_.erase(order_id);
+            order->status = OrderStatus::FILLED;
+            level->order_count--;
+            unlink_order(order);
+            order->level = nullptr;
+            remove_empty_level(level->price, order->side);
+            orders_.erase(order->id);
             order_pool_.deallocate(order);
         }
 
         return true;
     }
 
-    bool OrderBook::modify_order(OrderId order_id, Price new_price, Quantity new_quantity)
+    bool OrderBook::modify_order(OrderId order_id, Price new_price, Quantity new_quantity, Timestamp now)
     {
         std::lock_guard<std::mutex> lock(mutex_);
 
@@ -84,19 +104,28 @@ namespace mm
         }
 
         Quantity old_remaining = order->quantity - order->filled_quantity;
-        update_level_stats(order->level, old_remaining, false);
+        update_level_stats(order->level, old_remaining, false, now);
+        unlink_order(order);
+        if (new_price != order->price)
+        {
+            // Otherwise an emptied old level would linger as a zero-size best price
+            remove_empty_level(order->price, order->side);
+        }
 
         order->price = new_price;
         order->quantity = new_quantity;
-        order->timestamp = get_timestamp();
+        order->timestamp = now;
 
-        order->level = get_or_create_level(new_price, order->side);
-        update_level_stats(order->level, new_quantity - order->filled_quantity, true);
+        // A modified order loses its place and rejoins at the back
+        order->level = get_or_create_level(new_price, order->side, now);
+        link_order(order->level, order);
+        update_level_stats(order->level, new_quantity - order->filled_quantity, true, now);
+        publish_bbo();
 
         return true;
     }
 
-    bool OrderBook::execute_trade(Price price, Quantity quantity, OrderSide side)
+    bool OrderBook::execute_trade(Price price, Quantity quantity, OrderSide side, Timestamp now)
     {
         std::lock_guard<std::mutex> lock(mutex_);
 
@@ -119,29 +148,8 @@ namespace mm
                 }
 
                 Quantity execute_qty = std::min(remaining_qty, level->total_quantity);
-                level->total_quantity -= execute_qty;
                 remaining_qty -= execute_qty;
-
-                for (auto &order_pair : orders_)
-                {
-                    Order *order = order_pair.second;
-                    if (order->level == level && order->status == OrderStatus::ACTIVE)
-                    {
-                        Quantity order_execute = std::min(execute_qty, order->quantity - order->filled_quantity);
-                        order->filled_quantity += order_execute;
-                        execute_qty -= order_execute;
-
-                        if (order->filled_quantity >= order->quantity)
-                        {
-                            order->status = OrderStatus::FILLED;
-                            remove_order_from_level(order);
-                            order_pool_.deallocate(order);
-                        }
-
-                        if (execute_qty == 0)
-                            break;
-                    }
-                }
+                fill_level(level, execute_qty, now);
 
                 if (level->total_quantity == 0)
                 {
@@ -171,29 +179,8 @@ namespace mm
                 }
 
                 Quantity execute_qty = std::min(remaining_qty, level->total_quantity);
-                level->total_quantity -= execute_qty;
                 remaining_qty -= execute_qty;
-
-                for (auto &order_pair : orders_)
-                {
-                    Order *order = order_pair.second;
-                    if (order->level == level && order->status == OrderStatus::ACTIVE)
-                    {
-                        Quantity order_execute = std::min(execute_qty, order->quantity - order->filled_quantity);
-                        order->filled_quantity += order_execute;
-                        execute_qty -= order_execute;
-
-                        if (order->filled_quantity >= order->quantity)
-                        {
-                            order->status = OrderStatus::FILLED;
-                            remove_order_from_level(order);
-                            order_pool_.deallocate(order);
-                        }
-
-                        if (execute_qty == 0)
-                            break;
-                    }
-                }
+                fill_level(level, execute_qty, now);
 
                 if (level->total_quantity == 0)
                 {
@@ -207,15 +194,135 @@ namespace mm
             }
         }
 
+        publish_bbo();
+
         return remaining_qty < quantity;
     }
 
+    // Fills resting orders on one level oldest first; the caller drops the
+    // level once empty
+    void OrderBook::fill_level(PriceLevel *level, Quantity quantity, Timestamp now)
+    {
+        level->last_update = now;
+
+        Order *order = level->head;
+        while (order && quantity > 0)
+        {
+            Order *next = order->next;
+            Quantity order_execute = std::min(quantity, order->quantity - order->filled_quantity);
+            order->filled_quantity += order_execute;
+            level->total_quantity -= order_execute;
+            quantity -= order_execute;
+
+            if (order->filled_quantity >= order->quantity)
+            {
+                order->status = OrderStatus::FILLED;
+                unlink_order(order);
+                order->level = nullptr;
+                level->order_count--;
+                orders_.erase(order->id);
+                order_pool_.deallocate(order);
+            }
+            order = next;
+        }
+    }
+
+    bool OrderBook::apply(const BookUpdate &update)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool applied = apply_internal(update);
+        publish_bbo();
+        return applied;
+    }
+
+    bool OrderBook::apply_internal(const BookUpdate &update)
+    {
+        if (update.type == BookUpdateType::ADD)
+        {
+            return add_order_internal(update.order_id, update.price, update.quantity, update.side, update.timestamp, OrderType::LIMIT);
+        }
+
+        Order *order = find_order(update.order_id);
+        if (!order || order->status != OrderStatus::ACTIVE)
+        {
+            return false;
+        }
+
+        switch (update.type)
+        {
+        case BookUpdateType::EXECUTE:
+        case BookUpdateType::CANCEL:
+            return reduce_order_internal(order, update.quantity, update.timestamp);
+
+        case BookUpdateType::DELETE:
+            return reduce_order_internal(order, 0, update.timestamp);
+
+        case BookUpdateType::REPLACE:
+        {
+            OrderSide side = order->side;
+            reduce_order_internal(order, 0, update.timestamp);
+            return add_order_internal(update.new_order_id, update.price, update.quantity, side, update.timestamp, OrderType::LIMIT);
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    void OrderBook::publish_bbo_to(std::atomic<Price> *best_bid, std::atomic<Price> *best_ask)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bbo_bid_ = best_bid;
+        bbo_ask_ = best_ask;
+        publish_bbo();
+    }
+
+    // Caller holds mutex_
+    void OrderBook::publish_bbo()
+    {
+        if (bbo_bid_)
+        {
+            bbo_bid_->store(bids_.empty() ? 0 : bids_.begin()->first, std::memory_order_relaxed);
+            bbo_ask_->store(asks_.empty() ? 0 : asks_.begin()->first, std::memory_order_relaxed);
+        }
+    }
+
+    const Order *OrderBook::prefetch_order(OrderId order_id) const
+    {
+        const Order *order = orders_.find(order_id);
+        if (order)
+        {
+            __builtin_prefetch(order);
+        }
+        return order;
+    }
+
+    void OrderBook::prefetch_level(const Order *order)
+    {
+        if (order)
+        {
+            __builtin_prefetch(order->level);
+        }
+    }
+
     std::pair<Price, Quantity> OrderBook::get_best_bid() const
     {
         std::lock_guard<std::mutex> lock(mutex_);
         return get_best_bid_internal();
     }
 
+    Quantity OrderBook::get_level_quantity(Price price, OrderSide side) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (side == OrderSide::BUY)
+        {
+            auto it = bids_.find(price);
+            return it != bids_.end() ? it->second->total_quantity : 0;
+        }
+        auto it = asks_.find(price);
+        return it != asks_.end() ? it->second->total_quantity : 0;
+    }
+
     std::pair<Price, Quantity> OrderBook::get_best_ask() const
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -338,8 +445,7 @@ namespace mm
     {
         std::lock_guard<std::mutex> lock(mutex_);
 
-        auto it = orders_.find(order_id);
-        return (it != orders_.end()) ? it->second : nullptr;
+        return orders_.find(order_id);
     }
 
     OrderBook::Stats OrderBook::get_stats() const
@@ -349,11 +455,15 @@ namespace mm
         auto [best_bid_price, best_bid_qty] = get_best_bid_internal();
         auto [best_ask_price, best_ask_qty] = get_best_ask_internal();
 
+        size_t active_orders = 0;
+        orders_.for_each([&](OrderId, const Order *order)
+                         {
+            active_orders += order->status == OrderStatus::ACTIVE;
+            return true; });
+
         return Stats{
             .total_orders = orders_.size(),
-            .active_orders = static_cast<size_t>(std::count_if(orders_.begin(), orders_.end(),
-                                                               [](const auto &p)
-                                                               { return p.second->status == OrderStatus::ACTIVE; })),
+            .active_orders = active_orders,
             .bid_levels = bids_.size(),
             .ask_levels = asks_.size(),
             .best_bid = best_bid_price,
@@ -362,7 +472,7 @@ namespace mm
             .spread = get_spread_internal()};
     }
 
-    PriceLevel *OrderBook::get_or_create_level(Price price, OrderSide side)
+    PriceLevel *OrderBook::get_or_create_level(Price price, OrderSide side, Timestamp now)
     {
         if (side == OrderSide::BUY)
         {
@@ -376,7 +486,9 @@ namespace mm
             level->price = price;
             level->total_quantity = 0;
             level->order_count = 0;
-            level->last_update = get_timestamp();
+            level->last_update = now;
+            level->head = nullptr;
+            level->tail = nullptr;
 
             bids_[price] = level;
             return level;
@@ -393,7 +505,9 @@ namespace mm
             level->price = price;
             level->total_quantity = 0;
             level->order_count = 0;
-            level->last_update = get_timestamp();
+            level->last_update = now;
+            level->head = nullptr;
+            level->tail = nullptr;
 
             asks_[price] = level;
             return level;
@@ -422,7 +536,7 @@ namespace mm
         }
     }
 
-    void OrderBook::update_level_stats(PriceLevel *level, Quantity delta, bool add_order)
+    void OrderBook::update_level_stats(PriceLevel *level, Quantity delta, bool add_order, Timestamp now)
     {
         if (add_order)
         {
@@ -434,74 +548,199 @@ namespace mm
             level->total_quantity -= delta;
             level->order_count--;
         }
-        level->last_update = get_timestamp();
+        level->last_update = now;
     }
 
-    Order *OrderBook::find_order(OrderId order_id)
+    // Append to the back of level's queue
+    void OrderBook::link_order(PriceLevel *level, Order *order)
     {
-        auto it = orders_.find(order_id);
-        return (it != orders_.end()) ? it->second : nullptr;
+        order->prev = level->tail;
+        order->next = nullptr;
+        if (level->tail)
+        {
+            level->tail->next = order;
+        }
+        else
+        {
+            level->head = order;
+        }
+        level->tail = order;
     }
 
-    void OrderBook::remove_order_from_level(Order *order)
+    // Take an order out of its level's queue; order->level must still be set
+    void OrderBook::unlink_order(Order *order)
     {
-        if (order->level)
+        PriceLevel *level = order->level;
+        if (order->prev)
         {
-            update_level_stats(order->level, order->quantity - order->filled_quantity, false);
-            remove_empty_level(order->level->price, order->side);
-            order->level = nullptr;
+            order->prev->next = order->next;
+        }
+        else
+        {
+            level->head = order->next;
+        }
+        if (order->next)
+        {
+            order->next->prev = order->prev;
+        }
+        else
+        {
+            level->tail = order->prev;
         }
+        order->prev = nullptr;
+        order->next = nullptr;
+    }
+
+    Order *OrderBook::find_order(OrderId order_id)
+    {
+        return orders_.find(order_id);
     }
 
-    OrderBookManager::OrderBookManager() = default;
+    OrderBookManager::OrderBookManager(size_t orders_per_book, size_t levels_per_book)
+        : best_bids_(std::make_unique<std::atomic<Price>[]>(MAX_SYMBOLS)), best_asks_(std::make_unique<std::atomic<Price>[]>(MAX_SYMBOLS)),
+          orders_per_book_(orders_per_book), levels_per_book_(levels_per_book)
+    {
+    }
 
     OrderBook *OrderBookManager::get_order_book(SymbolId symbol)
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        return get_order_book_internal(symbol);
+    }
 
+    OrderBook *OrderBookManager::get_order_book_internal(SymbolId symbol)
+    {
         auto it = order_books_.find(symbol);
         if (it != order_books_.end())
         {
             return it->second.get();
         }
 
-        auto order_book = std::make_unique<OrderBook>(symbol);
+        auto order_book = std::make_unique<OrderBook>(symbol, orders_per_book_, levels_per_book_);
+        if (symbol < MAX_SYMBOLS)
+        {
+            order_book->publish_bbo_to(&best_bids_[symbol], &best_asks_[symbol]);
+        }
         OrderBook *ptr = order_book.get();
         order_books_[symbol] = std::move(order_book);
         return ptr;
     }
 
-    bool OrderBookManager::add_order(SymbolId symbol, OrderId order_id, Price price, Quantity quantity, OrderSide side, OrderType type)
+    bool OrderBookManager::add_order(SymbolId symbol, OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now, OrderType type)
     {
         OrderBook *order_book = get_order_book(symbol);
-        return order_book->add_order(order_id, price, quantity, side, type);
+        return order_book->add_order(order_id, price, quantity, side, now, type);
     }
 
-    bool OrderBookManager::cancel_order(SymbolId symbol, OrderId order_id, Quantity quantity)
+    bool OrderBookManager::cancel_order(SymbolId symbol, OrderId order_id, Timestamp now, Quantity quantity)
     {
         const OrderBook *order_book = get_order_book(symbol);
         if (!order_book)
             return false;
 
-        return const_cast<OrderBook *>(order_book)->cancel_order(order_id, quantity);
+        return const_cast<OrderBook *>(order_book)->cancel_order(order_id, now, quantity);
     }
 
-    bool OrderBookManager::modify_order(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity)
+    bool OrderBookManager::modify_order(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity, Timestamp now)
     {
         OrderBook *order_book = get_order_book(symbol);
         if (!order_book)
             return false;
 
-        return order_book->modify_order(order_id, new_price, new_quantity);
+        return order_book->modify_order(order_id, new_price, new_quantity, now);
     }
 
-    bool OrderBookManager::execute_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side)
+    bool OrderBookManager::execute_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, Timestamp now)
     {
         OrderBook *order_book = get_order_book(symbol);
         if (!order_book)
             return false;
 
-        return order_book->execute_trade(price, quantity, side);
+        return order_book->execute_trade(price, quantity, side, now);
+    }
+
+    size_t OrderBookManager::apply(const BookUpdate *updates, size_t count)
+    {
+        size_t applied = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            applied += get_order_book(updates[i].symbol)->apply(updates[i]);
+        }
+        return applied;
+    }
+
+    size_t OrderBookManager::apply_batch(const BookUpdate *updates, size_t count, bool prefetch)
+    {
+        size_t applied = 0;
+        OrderBook *books[APPLY_BATCH_SIZE];
+        const Order *orders[APPLY_BATCH_SIZE];
+        OrderBook *distinct[APPLY_BATCH_SIZE];
+
+        for (size_t base = 0; base < count; base += APPLY_BATCH_SIZE)
+        {
+            const BookUpdate *batch = updates + base;
+            size_t n = std::min(APPLY_BATCH_SIZE, count - base);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    books[i] = get_order_book_internal(batch[i].symbol);
+                }
+            }
+
+            // Strategy threads mutate the same books under their locks, so
+            // hold every book in the group from the first prefetch to the
+            // last mutation; taken in address order so two batch appliers
+            // cannot deadlock
+            size_t num_distinct = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (std::find(distinct, distinct + num_distinct, books[i]) == distinct + num_distinct)
+                {
+                    distinct[num_distinct++] = books[i];
+                }
+            }
+            std::sort(distinct, distinct + num_distinct, std::less<OrderBook *>());
+            std::unique_lock<std::mutex> locks[APPLY_BATCH_SIZE];
+            for (size_t k = 0; k < num_distinct; ++k)
+            {
+                locks[k] = std::unique_lock<std::mutex>(distinct[k]->mutex_);
+            }
+
+            if (prefetch)
+            {
+                // Stage 1: hash every reference and pull its table slot
+                for (size_t i = 0; i < n; ++i)
+                {
+                    books[i]->prefetch_order_slot(batch[i].order_id);
+                }
+
+                // Stage 2: slots are warm, pull the orders they point to
+                for (size_t i = 0; i < n; ++i)
+                {
+                    orders[i] = batch[i].type == BookUpdateType::ADD ? nullptr : books[i]->prefetch_order(batch[i].order_id);
+                }
+
+                // Stage 3: orders are warm, pull their price levels
+                for (size_t i = 0; i < n; ++i)
+                {
+                    OrderBook::prefetch_level(orders[i]);
+                }
+            }
+
+            // Stage 4: mutate with the misses already overlapped
+            for (size_t i = 0; i < n; ++i)
+            {
+                applied += books[i]->apply_internal(batch[i]);
+            }
+            for (size_t k = 0; k < num_distinct; ++k)
+            {
+                distinct[k]->publish_bbo();
+            }
+        }
+
+        return applied;
     }
 
     const OrderBook *OrderBookManager::get_order_book(SymbolId symbol) const
@@ -527,4 +766,16 @@ namespace mm
         return symbols;
     }
 
+    size_t OrderBookManager::memory_usage() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t total = 0;
+        for (const auto &[symbol, order_book] : order_books_)
+        {
+            total += order_book->memory_usage();
+        }
+        return total;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "parameter_sweep.hpp"
+#include "itch_parser.hpp"
+#include "position_tracker.hpp"
+#include "clock.hpp"
+#include "quote_kernel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace mm
+{
+
+    namespace
+    {
+        // A parameter set's view of one symbol: its resting quotes and inventory
+        struct SymbolOverlay
+        {
+            Price bid_price;
+            Price ask_price;
+            Price mark; // Last market mid, 0 until the book is two-sided
+            int64_t net_position;
+            Quantity bid_size;
+            Quantity ask_size;
+        };
+
+        struct Simulation
+        {
+            SkewedQuoteParams quote_params;
+            Quantity quote_size;
+            std::vector<SymbolOverlay> symbols;
+            SweepResult result;
+        };
+
+        inline void fill(Simulation &sim, SymbolOverlay &symbol, OrderSide side, Price price, Quantity quantity)
+        {
+            // Marked P&L moves by the edge to the mid; cash and position
+            // change but their marked sum does not otherwise
+            if (side == OrderSide::BUY)
+            {
+                symbol.net_position += quantity;
+                symbol.bid_size -= quantity;
+                sim.result.pnl += (symbol.mark - price) * static_cast<PnL>(quantity);
+            }
+            else
+            {
+                symbol.net_position -= quantity;
+                symbol.ask_size -= quantity;
+                sim.result.pnl += (price - symbol.mark) * static_cast<PnL>(quantity);
+            }
+            ++sim.result.fills;
+            sim.result.filled_quantity += quantity;
+            int64_t magnitude = symbol.net_position < 0 ? -symbol.net_position : symbol.net_position;
+            sim.result.max_position = std::max(sim.result.max_position, magnitude);
+        }
+
+        inline void on_event(Simulation &sim, const TapeEvent &event)
+        {
+            SymbolOverlay &symbol = sim.symbols[event.slot];
+
+            if (event.trade_quantity)
+            {
+                if (event.trade_side == OrderSide::BUY)
+                {
+                    if (symbol.bid_size && symbol.bid_price >= event.trade_price)
+                    {
+                        fill(sim, symbol, OrderSide::BUY, symbol.bid_price, std::min(event.trade_quantity, symbol.bid_size));
+                    }
+                }
+                else if (symbol.ask_size && symbol.ask_price <= event.trade_price)
+                {
+                    fill(sim, symbol, OrderSide::SELL, symbol.ask_price, std::min(event.trade_quantity, symbol.ask_size));
+                }
+            }
+
+            Price bid = 0, ask = 0;
+            Quantity bid_size = 0, ask_size = 0;
+            if (event.bbo.bid > 0 && event.bbo.ask > 0)
+            {
+                Price mid = (event.bbo.bid + event.bbo.ask) / 2;
+                sim.result.pnl += symbol.net_position * (mid - symbol.mark);
+                symbol.mark = mid;
+
+                skewed_quote(mid, symbol.net_position, sim.quote_params, bid, ask);
+                bid_size = bid < event.bbo.ask ? sim.quote_size : 0;
+                ask_size = ask > event.bbo.bid ? sim.quote_size : 0;
+            }
+
+            // Counted as the quote manager would send them: one update per
+            // event that changes either side
+            if (bid != symbol.bid_price || ask != symbol.ask_price || bid_size != symbol.bid_size || ask_size != symbol.ask_size)
+            {
+                ++sim.result.quote_updates;
+                symbol.bid_price = bid;
+                symbol.ask_price = ask;
+                symbol.bid_size = bid_size;
+                symbol.ask_size = ask_size;
+            }
+
+            if (sim.result.pnl > sim.result.peak_pnl)
+            {
+                sim.result.peak_pnl = sim.result.pnl;
+            }
+            else
+            {
+                sim.result.max_drawdown = std::max(sim.result.max_drawdown, sim.result.peak_pnl - sim.result.pnl);
+            }
+        }
+    }
+
+    FeedTape::FeedTape(size_t orders_per_book, size_t levels_per_book)
+        : books_(orders_per_book, levels_per_book), slot_of_(std::make_unique<uint32_t[]>(MAX_SYMBOLS)), updates_applied_(0)
+    {
+        std::fill(slot_of_.get(), slot_of_.get() + MAX_SYMBOLS, NO_SLOT);
+    }
+
+    bool FeedTape::load_itch_file(const std::string &filename, size_t memory_cap_bytes)
+    {
+        // The parser only decodes; each flushed batch goes straight onto the
+        // tape, so the day is never held decoded in full and the parser's
+        // memory cap sees the reference book grow. Positions and clock are unused.
+        PositionTracker positions;
+        EngineClock clock(ClockMode::REPLAY);
+        ITCHParser parser(books_, positions, clock);
+        parser.set_memory_cap(memory_cap_bytes);
+        parser.set_update_sink([this](const BookUpdate *updates, size_t count)
+                               { append(updates, count); });
+        return parser.parse_file(filename);
+    }
+
+    void FeedTape::append(const BookUpdate *updates, size_t count)
+    {
+        const OrderBookManager &books = books_;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const BookUpdate &update = updates[i];
+            if (update.symbol >= MAX_SYMBOLS)
+            {
+                continue;
+            }
+
+            Price trade_price = 0;
+            OrderSide trade_side = OrderSide::BUY;
+            Quantity trade_quantity = 0;
+            if (update.type == BookUpdateType::EXECUTE)
+            {
+                const OrderBook *book = books.get_order_book(update.symbol);
+                const Order *order = book ? book->get_order(update.order_id) : nullptr;
+                if (order)
+                {
+                    trade_price = order->price;
+                    trade_side = order->side;
+                    trade_quantity = std::min(update.quantity, order->quantity - order->filled_quantity);
+                }
+            }
+
+            books_.apply(&update, 1);
+            ++updates_applied_;
+
+            uint32_t &slot = slot_of_[update.symbol];
+            if (slot == NO_SLOT)
+            {
+                slot = static_cast<uint32_t>(symbols_.size());
+                symbols_.push_back(update.symbol);
+                last_bbo_.push_back(BestBidOffer{0, 0});
+            }
+
+            BestBidOffer bbo = books_.get_bbo(update.symbol);
+            if (trade_quantity == 0 && bbo == last_bbo_[slot])
+            {
+                continue;
+            }
+            last_bbo_[slot] = bbo;
+            events_.push_back(TapeEvent{update.timestamp, trade_price, bbo, trade_quantity, slot, update.symbol, trade_side});
+        }
+    }
+
+    ParameterSweep::ParameterSweep(const Config &config)
+        : config_(config)
+    {
+    }
+
+    SweepReport ParameterSweep::run(const FeedTape &tape, const std::vector<SweepParams> &params) const
+    {
+        std::vector<SkewedQuoteParams> quote_params;
+        quote_params.reserve(params.size());
+        for (const SweepParams &p : params)
+        {
+            quote_params.push_back(make_skewed_quote_params(p.min_spread, p.max_spread, p.max_inventory));
+        }
+
+        SweepReport report{};
+        report.results.resize(params.size());
+        if (params.empty())
+        {
+            return report;
+        }
+
+        const size_t per_pass = std::max<size_t>(1, config_.configs_per_pass);
+        const size_t passes = (params.size() + per_pass - 1) / per_pass;
+        size_t num_threads = config_.num_threads ? config_.num_threads : std::max(1u, std::thread::hardware_concurrency());
+        num_threads = std::min(num_threads, passes);
+        report.threads = num_threads;
+
+        // Passes are all the same length, so a shared counter balances them
+        std::atomic<size_t> next_pass{0};
+        auto worker = [&]()
+        {
+            std::vector<Simulation> sims(per_pass);
+            size_t pass;
+            while ((pass = next_pass.fetch_add(1, std::memory_order_relaxed)) < passes)
+            {
+                size_t first = pass * per_pass;
+                size_t count = std::min(per_pass, params.size() - first);
+                for (size_t k = 0; k < count; ++k)
+                {
+                    Simulation &sim = sims[k];
+                    sim.quote_params = quote_params[first + k];
+                    sim.quote_size = params[first + k].quote_size;
+                    sim.symbols.assign(tape.symbol_count(), SymbolOverlay{});
+                    sim.result = SweepResult{};
+                    sim.result.params = params[first + k];
+                }
+
+                const TapeEvent *events = tape.data();
+                for (size_t i = 0; i < tape.size(); ++i)
+                {
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        on_event(sims[k], events[i]);
+                    }
+                }
+
+                for (size_t k = 0; k < count; ++k)
+                {
+                    report.results[first + k] = sims[k].result;
+                }
+            }
+        };
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (size_t t = 1; t < num_threads; ++t)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        report.makespan_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+        return report;
+    }
+
+}
@@ -0,0 +1,250 @@
+#include "portfolio_var.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace mm
+{
+
+    namespace
+    {
+        constexpr size_t DOUBLES_PER_LINE = CACHE_LINE_SIZE / sizeof(double);
+
+        // Vectors are 64-byte aligned and zero past the last symbol, so
+        // loops may run to the next multiple of four
+        size_t padded(size_t count) { return (count + 3) & ~size_t(3); }
+
+        // y += a * x
+        inline void axpy(double a, const double *x, double *y, size_t n)
+        {
+            size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256d va = _mm256_set1_pd(a);
+            for (; i < n; i += 4)
+            {
+                _mm256_store_pd(y + i, _mm256_fmadd_pd(va, _mm256_load_pd(x + i), _mm256_load_pd(y + i)));
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                y[i] += a * x[i];
+            }
+        }
+
+        inline double dot(const double *x, const double *y, size_t n)
+        {
+            size_t i = 0;
+            double sum = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256d acc = _mm256_setzero_pd();
+            for (; i < n; i += 4)
+            {
+                acc = _mm256_fmadd_pd(_mm256_load_pd(x + i), _mm256_load_pd(y + i), acc);
+            }
+            __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+            sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+#endif
+            for (; i < n; ++i)
+            {
+                sum += x[i] * y[i];
+            }
+            return sum;
+        }
+
+        // row = decay * row + a * x, then return row . q, in one pass
+        inline double decay_update_dot(double *row, double decay, double a, const double *x, const double *q, size_t n)
+        {
+            size_t i = 0;
+            double sum = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256d vdecay = _mm256_set1_pd(decay);
+            __m256d va = _mm256_set1_pd(a);
+            __m256d acc = _mm256_setzero_pd();
+            for (; i < n; i += 4)
+            {
+                __m256d updated = _mm256_fmadd_pd(va, _mm256_load_pd(x + i), _mm256_mul_pd(vdecay, _mm256_load_pd(row + i)));
+                _mm256_store_pd(row + i, updated);
+                acc = _mm256_fmadd_pd(updated, _mm256_load_pd(q + i), acc);
+            }
+            __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+            sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+#endif
+            for (; i < n; ++i)
+            {
+                row[i] = decay * row[i] + a * x[i];
+                sum += row[i] * q[i];
+            }
+            return sum;
+        }
+    }
+
+    PortfolioVaR::PortfolioVaR(const PortfolioVaRConfig &config)
+        : config_(config), stride_(0), count_(0), stats_{0, 0}, variance_(0)
+    {
+        if (config_.capacity == 0 || config_.capacity > MAX_SYMBOLS)
+        {
+            throw std::invalid_argument("VaR universe capacity must be between 1 and MAX_SYMBOLS");
+        }
+
+        size_t lines_per_row = (config_.capacity + DOUBLES_PER_LINE - 1) / DOUBLES_PER_LINE;
+        stride_ = lines_per_row * DOUBLES_PER_LINE;
+
+        index_ = std::make_unique<uint32_t[]>(MAX_SYMBOLS);
+        std::fill(index_.get(), index_.get() + MAX_SYMBOLS, NO_INDEX);
+        symbols_ = std::make_unique<SymbolId[]>(config_.capacity);
+
+        // Value-initialised, so padding lanes start and stay zero
+        covariance_storage_ = std::make_unique<DoubleBlock[]>(config_.capacity * lines_per_row);
+        vector_storage_ = std::make_unique<DoubleBlock[]>(4 * lines_per_row);
+        covariance_ = covariance_storage_[0].values;
+        position_ = vector_storage_[0].values;
+        weighted_ = position_ + stride_;
+        change_ = weighted_ + stride_;
+        last_mid_ = change_ + stride_;
+    }
+
+    bool PortfolioVaR::add_symbol(SymbolId symbol)
+    {
+        return symbol < MAX_SYMBOLS && index_of(symbol) != NO_INDEX;
+    }
+
+    uint32_t PortfolioVaR::index_of(SymbolId symbol)
+    {
+        uint32_t index = index_[symbol];
+        if (index == NO_INDEX && count_ < config_.capacity)
+        {
+            // New rows and columns are already zero: no history yet
+            index = static_cast<uint32_t>(count_++);
+            index_[symbol] = index;
+            symbols_[index] = symbol;
+        }
+        return index;
+    }
+
+    void PortfolioVaR::on_fill(SymbolId symbol, OrderSide side, Quantity quantity)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+        uint32_t index = index_of(symbol);
+        if (index == NO_INDEX)
+        {
+            return;
+        }
+        apply_delta(index, side == OrderSide::BUY ? static_cast<double>(quantity) : -static_cast<double>(quantity));
+        ++stats_.fills;
+    }
+
+    void PortfolioVaR::set_position(SymbolId symbol, int64_t net_position)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+        uint32_t index = index_of(symbol);
+        if (index != NO_INDEX)
+        {
+            apply_delta(index, static_cast<double>(net_position) - position_[index]);
+        }
+    }
+
+    void PortfolioVaR::apply_delta(uint32_t index, double delta)
+    {
+        if (delta == 0)
+        {
+            return;
+        }
+        // Rank-1 change to q: the variance moves by the cross term and the
+        // symbol's own variance; w moves by the symbol's column (= its row)
+        const double *column = row(index);
+        variance_ += 2 * delta * weighted_[index] + delta * delta * column[index];
+        axpy(delta, column, weighted_, padded(count_));
+        position_[index] += delta;
+    }
+
+    void PortfolioVaR::observe(const Price *best_bids, const Price *best_asks)
+    {
+        for (size_t i = 0; i < count_; ++i)
+        {
+            record_mid(i, best_bids[symbols_[i]], best_asks[symbols_[i]]);
+        }
+        update_covariance();
+    }
+
+    void PortfolioVaR::observe(const std::atomic<Price> *best_bids, const std::atomic<Price> *best_asks)
+    {
+        for (size_t i = 0; i < count_; ++i)
+        {
+            record_mid(i, best_bids[symbols_[i]].load(std::memory_order_relaxed),
+                       best_asks[symbols_[i]].load(std::memory_order_relaxed));
+        }
+        update_covariance();
+    }
+
+    void PortfolioVaR::update_covariance()
+    {
+        // C = decay * C + (1 - decay) * r r', row by row, with w = C q
+        // rebuilt from the updated rows in the same pass
+        size_t n = padded(count_);
+        double weight = 1 - config_.decay;
+        for (size_t i = 0; i < count_; ++i)
+        {
+            weighted_[i] = decay_update_dot(row(i), config_.decay, weight * change_[i], change_, position_, n);
+        }
+        variance_ = dot(position_, weighted_, n);
+        ++stats_.observations;
+    }
+
+    double PortfolioVaR::full_variance() const
+    {
+        size_t n = padded(count_);
+        double sum = 0;
+        for (size_t i = 0; i < count_; ++i)
+        {
+            sum += position_[i] * dot(row(i), position_, n);
+        }
+        return sum;
+    }
+
+    PnL PortfolioVaR::value_at_risk() const
+    {
+        return static_cast<PnL>(std::llround(config_.z_score * std::sqrt(variance())));
+    }
+
+    PnL PortfolioVaR::value_at_risk_after(SymbolId symbol, int64_t net_delta) const
+    {
+        uint32_t index = symbol < MAX_SYMBOLS ? index_[symbol] : NO_INDEX;
+        if (index == NO_INDEX)
+        {
+            // No history for the symbol, so no variance from it yet
+            return value_at_risk();
+        }
+        double delta = static_cast<double>(net_delta);
+        double after = variance_ + 2 * delta * weighted_[index] + delta * delta * row(index)[index];
+        return static_cast<PnL>(std::llround(config_.z_score * std::sqrt(std::max(after, 0.0))));
+    }
+
+    double PortfolioVaR::covariance(SymbolId a, SymbolId b) const
+    {
+        if (a >= MAX_SYMBOLS || b >= MAX_SYMBOLS || index_[a] == NO_INDEX || index_[b] == NO_INDEX)
+        {
+            return 0;
+        }
+        return row(index_[a])[index_[b]];
+    }
+
+    int64_t PortfolioVaR::get_position(SymbolId symbol) const
+    {
+        if (symbol >= MAX_SYMBOLS || index_[symbol] == NO_INDEX)
+        {
+            return 0;
+        }
+        return static_cast<int64_t>(position_[index_[symbol]]);
+    }
+
+}
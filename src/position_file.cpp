@@ -0,0 +1,199 @@
+#include "position_file.hpp"
+#include "crc32.hpp"
+#include "position_tracker.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mm
+{
+
+    uint64_t position_record_layout()
+    {
+        // Offset and size of every field, in declaration order
+        const uint32_t fields[] = {
+            offsetof(PositionRecord, symbol), sizeof(PositionRecord::symbol),
+            offsetof(PositionRecord, long_quantity), sizeof(PositionRecord::long_quantity),
+            offsetof(PositionRecord, short_quantity), sizeof(PositionRecord::short_quantity),
+            offsetof(PositionRecord, crc), sizeof(PositionRecord::crc),
+            offsetof(PositionRecord, avg_long_price), sizeof(PositionRecord::avg_long_price),
+            offsetof(PositionRecord, avg_short_price), sizeof(PositionRecord::avg_short_price),
+            offsetof(PositionRecord, realized_pnl), sizeof(PositionRecord::realized_pnl),
+            offsetof(PositionRecord, unrealized_pnl), sizeof(PositionRecord::unrealized_pnl),
+            offsetof(PositionRecord, last_update), sizeof(PositionRecord::last_update),
+            offsetof(PositionRecord, fill_sequence), sizeof(PositionRecord::fill_sequence),
+            sizeof(PositionRecord)};
+        return (static_cast<uint64_t>(crc32c(fields, sizeof(fields))) << 32) | sizeof(fields) / sizeof(fields[0]);
+    }
+
+    namespace
+    {
+        uint32_t header_checksum(const PositionFileHeader &header)
+        {
+            return crc32c(&header, offsetof(PositionFileHeader, crc));
+        }
+    }
+
+    PositionFileHeader make_position_file_header(size_t record_count)
+    {
+        PositionFileHeader header{};
+        header.magic = POSITION_FILE_MAGIC;
+        header.version = POSITION_FILE_VERSION;
+        header.byte_order = POSITION_FILE_BYTE_ORDER;
+        header.header_size = POSITION_FILE_HEADER_SIZE;
+        header.record_size = sizeof(PositionRecord);
+        header.record_count = record_count;
+        header.layout = position_record_layout();
+        header.crc = header_checksum(header);
+        return header;
+    }
+
+    void validate_position_file_header(const PositionFileHeader &header, size_t file_size, const std::string &path)
+    {
+        if (header.magic != POSITION_FILE_MAGIC)
+        {
+            throw std::runtime_error("Not a position file: " + path);
+        }
+        if (header.crc != header_checksum(header))
+        {
+            throw std::runtime_error("Corrupt position file header: " + path);
+        }
+        if (header.byte_order != POSITION_FILE_BYTE_ORDER)
+        {
+            throw std::runtime_error("Position file written with another byte order: " + path);
+        }
+        if (header.version != POSITION_FILE_VERSION || header.header_size != POSITION_FILE_HEADER_SIZE ||
+            header.record_size != sizeof(PositionRecord) || header.layout != position_record_layout())
+        {
+            throw std::runtime_error("Position file layout mismatch (version " + std::to_string(header.version) +
+                                     ", expected " + std::to_string(POSITION_FILE_VERSION) + "): " + path);
+        }
+        if (header.record_count > MAX_SYMBOLS ||
+            file_size < POSITION_FILE_HEADER_SIZE + header.record_count * sizeof(PositionRecord))
+        {
+            throw std::runtime_error("Truncated position file: " + path);
+        }
+    }
+
+    bool is_position_file(const void *data, size_t size)
+    {
+        uint64_t magic = 0;
+        if (size >= sizeof(magic))
+        {
+            std::memcpy(&magic, data, sizeof(magic));
+        }
+        return magic == POSITION_FILE_MAGIC;
+    }
+
+    uint32_t position_record_checksum(const PositionRecord &record)
+    {
+        uint32_t crc = crc32c(&record, offsetof(PositionRecord, crc));
+        constexpr size_t tail = offsetof(PositionRecord, crc) + sizeof(PositionRecord::crc);
+        return crc32c(reinterpret_cast<const char *>(&record) + tail, sizeof(PositionRecord) - tail, crc);
+    }
+
+    PositionRecord to_position_record(const Position &position)
+    {
+        PositionRecord record{};
+        record.symbol = position.symbol;
+        record.long_quantity = position.long_quantity;
+        record.short_quantity = position.short_quantity;
+        record.avg_long_price = position.avg_long_price;
+        record.avg_short_price = position.avg_short_price;
+        record.realized_pnl = position.realized_pnl;
+        record.unrealized_pnl = position.unrealized_pnl;
+        record.last_update = position.last_update;
+        record.fill_sequence = position.fill_sequence;
+        record.crc = position_record_checksum(record);
+        return record;
+    }
+
+    Position from_position_record(const PositionRecord &record)
+    {
+        Position position;
+        position.symbol = record.symbol;
+        position.long_quantity = record.long_quantity;
+        position.short_quantity = record.short_quantity;
+        position.avg_long_price = record.avg_long_price;
+        position.avg_short_price = record.avg_short_price;
+        position.realized_pnl = record.realized_pnl;
+        position.unrealized_pnl = record.unrealized_pnl;
+        position.last_update = record.last_update;
+        position.fill_sequence = record.fill_sequence;
+        return position;
+    }
+
+    PositionFileView::PositionFileView(const std::string &path)
+        : path_(path), fd_(-1), mmap_ptr_(nullptr), mmap_size_(0), records_(nullptr), record_count_(0)
+    {
+        fd_ = open(path_.c_str(), O_RDONLY);
+        if (fd_ == -1)
+        {
+            throw std::runtime_error("Failed to open position file: " + path_);
+        }
+
+        struct stat st;
+        if (fstat(fd_, &st) == -1 || static_cast<size_t>(st.st_size) < POSITION_FILE_HEADER_SIZE)
+        {
+            close(fd_);
+            throw std::runtime_error("Not a position file: " + path_);
+        }
+
+        mmap_size_ = static_cast<size_t>(st.st_size);
+        mmap_ptr_ = mmap(nullptr, mmap_size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (mmap_ptr_ == MAP_FAILED)
+        {
+            close(fd_);
+            throw std::runtime_error("Failed to mmap position file");
+        }
+
+        try
+        {
+            const PositionFileHeader &header = *static_cast<const PositionFileHeader *>(mmap_ptr_);
+            validate_position_file_header(header, mmap_size_, path_);
+            record_count_ = header.record_count;
+        }
+        catch (...)
+        {
+            munmap(mmap_ptr_, mmap_size_);
+            close(fd_);
+            throw;
+        }
+        records_ = reinterpret_cast<const PositionRecord *>(static_cast<const char *>(mmap_ptr_) + POSITION_FILE_HEADER_SIZE);
+    }
+
+    PositionFileView::~PositionFileView()
+    {
+        munmap(mmap_ptr_, mmap_size_);
+        close(fd_);
+    }
+
+    const PositionRecord *PositionFileView::record(SymbolId symbol) const
+    {
+        if (symbol >= record_count_ || records_[symbol].symbol == 0)
+        {
+            return nullptr;
+        }
+        const PositionRecord &record = records_[symbol];
+        if (record.crc != position_record_checksum(record) || record.symbol != symbol)
+        {
+            throw std::runtime_error("Corrupt position record for symbol " + std::to_string(symbol) + ": " + path_);
+        }
+        return &record;
+    }
+
+    bool PositionFileView::get_position(SymbolId symbol, Position &out) const
+    {
+        const PositionRecord *found = record(symbol);
+        if (!found)
+        {
+            return false;
+        }
+        out = from_position_record(*found);
+        return true;
+    }
+
+}
@@ -0,0 +1,169 @@
+#include "position_shm.hpp"
+#include "position_tracker.hpp"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mm
+{
+
+    namespace
+    {
+        size_t slot_offset()
+        {
+            return (sizeof(SharedPositionHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        }
+
+        size_t segment_size()
+        {
+            return slot_offset() + MAX_SYMBOLS * sizeof(SharedPositionSlot);
+        }
+
+        uint64_t system_now_ns()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::system_clock::now().time_since_epoch())
+                                             .count());
+        }
+    }
+
+    SharedPositionPublisher::SharedPositionPublisher(const PositionTracker &tracker, const std::string &name,
+                                                     std::chrono::microseconds interval)
+        : tracker_(tracker), name_(name), mmap_ptr_(nullptr), mmap_size_(segment_size()), header_(nullptr), slots_(nullptr),
+          since_(0), reset_count_(0), interval_(interval), stop_(false)
+    {
+        int fd = shm_open(name_.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+        if (fd == -1)
+        {
+            throw std::runtime_error("Failed to create shared memory segment: " + name_);
+        }
+        if (ftruncate(fd, static_cast<off_t>(mmap_size_)) == -1)
+        {
+            close(fd);
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("Failed to size shared memory segment: " + name_);
+        }
+        mmap_ptr_ = mmap(nullptr, mmap_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mmap_ptr_ == MAP_FAILED)
+        {
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("Failed to mmap shared memory segment: " + name_);
+        }
+
+        // The segment is zero-filled; construct in place and publish the magic last
+        header_ = new (mmap_ptr_) SharedPositionHeader();
+        slots_ = reinterpret_cast<SharedPositionSlot *>(static_cast<char *>(mmap_ptr_) + slot_offset());
+        for (size_t i = 0; i < MAX_SYMBOLS; ++i)
+        {
+            new (&slots_[i]) SharedPositionSlot();
+        }
+        header_->version = POSITION_SHM_VERSION;
+        header_->byte_order = POSITION_FILE_BYTE_ORDER;
+        header_->slot_size = sizeof(SharedPositionSlot);
+        header_->slot_count = MAX_SYMBOLS;
+        header_->slot_offset = slot_offset();
+        header_->layout = position_record_layout();
+        header_->publisher_pid = getpid();
+
+        reset_count_ = tracker_.get_reset_count();
+        publish();
+        header_->magic.store(POSITION_SHM_MAGIC, std::memory_order_release);
+
+        if (interval_.count() > 0)
+        {
+            thread_ = std::thread(&SharedPositionPublisher::publish_loop, this);
+        }
+    }
+
+    SharedPositionPublisher::~SharedPositionPublisher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(thread_mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+
+        // Readers already mapped keep their view; new ones fail to open
+        munmap(mmap_ptr_, mmap_size_);
+        shm_unlink(name_.c_str());
+    }
+
+    size_t SharedPositionPublisher::publish()
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+
+        // reset() drops symbols without reporting them; clear and republish
+        bool wiped = false;
+        uint64_t reset_count = tracker_.get_reset_count();
+        if (reset_count != reset_count_)
+        {
+            uint32_t bound = header_->symbol_bound.load(std::memory_order_relaxed);
+            for (uint32_t symbol = 0; symbol < bound; ++symbol)
+            {
+                if (slots_[symbol].writer_value().symbol != 0)
+                {
+                    slots_[symbol].store(PositionRecord{});
+                }
+            }
+            header_->symbol_bound.store(0, std::memory_order_release);
+            reset_count_ = reset_count;
+            since_ = 0;
+            wiped = true;
+        }
+
+        since_ = tracker_.get_positions_changed_since(since_, changed_);
+        uint32_t bound = header_->symbol_bound.load(std::memory_order_relaxed);
+        for (const Position &position : changed_)
+        {
+            slots_[position.symbol].store(to_position_record(position));
+            bound = std::max<uint32_t>(bound, position.symbol + 1u);
+        }
+        header_->symbol_bound.store(bound, std::memory_order_release);
+
+        DrawdownStats drawdown = tracker_.get_drawdown();
+        SharedTotals totals{
+            .realized_pnl = tracker_.get_total_realized_pnl(),
+            .unrealized_pnl = tracker_.get_total_unrealized_pnl(),
+            .total_pnl = tracker_.get_total_pnl(),
+            .gross_exposure = tracker_.get_gross_exposure(),
+            .net_exposure = tracker_.get_net_exposure(),
+            .peak_pnl = drawdown.peak,
+            .drawdown = drawdown.drawdown,
+            .max_drawdown = drawdown.max_drawdown,
+            .trades = tracker_.get_next_trade_sequence(),
+            .active_symbols = tracker_.get_active_symbol_count()};
+        bool totals_changed = std::memcmp(&totals, &header_->totals.writer_value(), sizeof(totals)) != 0;
+        if (totals_changed)
+        {
+            header_->totals.store(totals);
+        }
+
+        if (wiped || totals_changed || !changed_.empty())
+        {
+            header_->publish_version.fetch_add(1, std::memory_order_release);
+        }
+        header_->heartbeat_ns.store(system_now_ns(), std::memory_order_release);
+        return changed_.size();
+    }
+
+    void SharedPositionPublisher::publish_loop()
+    {
+        std::unique_lock<std::mutex> lock(thread_mutex_);
+        while (!cv_.wait_for(lock, interval_, [&]()
+                             { return stop_; }))
+        {
+            lock.unlock();
+            publish();
+            lock.lock();
+        }
+    }
+
+}
@@ -0,0 +1,40 @@
+#include "position_shard.hpp"
+#include "position_tracker.hpp"
+
+namespace mm
+{
+
+    PositionShard::PositionShard(PositionTracker &owner)
+        : owner_(owner), ring_(std::make_unique<ShardFill[]>(RING_CAPACITY)),
+          net_(std::make_unique<std::atomic<int64_t>[]>(MAX_SYMBOLS)),
+          applied_(std::make_unique<std::atomic<int64_t>[]>(MAX_SYMBOLS)),
+          head_(0), tail_(0), drain_sequence_(0)
+    {
+    }
+
+    bool PositionShard::record_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id, Timestamp now)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return false;
+        }
+
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == RING_CAPACITY)
+        {
+            // Consolidation fell behind; fold our own fills in
+            std::lock_guard<std::mutex> lock(owner_.consolidation_mutex_);
+            owner_.drain_shard(*this);
+        }
+
+        // Delta first, so a fill is never in the ring without being in net_
+        std::atomic<int64_t> &net = net_[symbol];
+        int64_t signed_quantity = side == OrderSide::BUY ? quantity : -static_cast<int64_t>(quantity);
+        net.store(net.load(std::memory_order_relaxed) + signed_quantity, std::memory_order_relaxed);
+
+        ring_[head & (RING_CAPACITY - 1)] = ShardFill{price, order_id, now, quantity, symbol, side};
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+}
@@ -0,0 +1,113 @@
+#include "position_shm.hpp"
+#include "position_tracker.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mm
+{
+
+    namespace
+    {
+        // Attempts before a reader gives up on a slot the publisher keeps rewriting
+        constexpr int READ_ATTEMPTS = 64;
+
+        template <typename T>
+        bool bounded_load(const Seqlock<T> &lock, T &out)
+        {
+            for (int attempt = 0; attempt < READ_ATTEMPTS; ++attempt)
+            {
+                if (lock.try_load(out))
+                {
+                    return true;
+                }
+                cpu_relax();
+            }
+            return false;
+        }
+    }
+
+    SharedPositionReader::SharedPositionReader(const std::string &name)
+        : mmap_ptr_(nullptr), mmap_size_(0), header_(nullptr), slots_(nullptr)
+    {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd == -1)
+        {
+            throw std::runtime_error("No shared position segment: " + name);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(SharedPositionHeader))
+        {
+            close(fd);
+            throw std::runtime_error("Shared position segment not initialised: " + name);
+        }
+        mmap_size_ = static_cast<size_t>(st.st_size);
+        mmap_ptr_ = mmap(nullptr, mmap_size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mmap_ptr_ == MAP_FAILED)
+        {
+            throw std::runtime_error("Failed to mmap shared position segment: " + name);
+        }
+
+        header_ = static_cast<const SharedPositionHeader *>(mmap_ptr_);
+        const char *error = nullptr;
+        if (header_->magic.load(std::memory_order_acquire) != POSITION_SHM_MAGIC)
+        {
+            error = "Shared position segment not initialised: ";
+        }
+        else if (header_->version != POSITION_SHM_VERSION || header_->byte_order != POSITION_FILE_BYTE_ORDER ||
+                 header_->slot_size != sizeof(SharedPositionSlot) || header_->layout != position_record_layout() ||
+                 header_->slot_count > MAX_SYMBOLS ||
+                 mmap_size_ < header_->slot_offset + header_->slot_count * sizeof(SharedPositionSlot))
+        {
+            error = "Shared position segment layout mismatch: ";
+        }
+        if (error)
+        {
+            munmap(mmap_ptr_, mmap_size_);
+            throw std::runtime_error(error + name);
+        }
+        slots_ = reinterpret_cast<const SharedPositionSlot *>(static_cast<const char *>(mmap_ptr_) + header_->slot_offset);
+    }
+
+    SharedPositionReader::~SharedPositionReader()
+    {
+        munmap(mmap_ptr_, mmap_size_);
+    }
+
+    bool SharedPositionReader::get_position(SymbolId symbol, Position &out) const
+    {
+        PositionRecord record;
+        if (symbol >= header_->slot_count || !bounded_load(slots_[symbol], record) || record.symbol == 0)
+        {
+            return false;
+        }
+        out = from_position_record(record);
+        return true;
+    }
+
+    size_t SharedPositionReader::get_positions(std::vector<Position> &out) const
+    {
+        out.clear();
+        uint32_t bound = std::min(header_->symbol_bound.load(std::memory_order_acquire), header_->slot_count);
+        Position position;
+        for (uint32_t symbol = 0; symbol < bound; ++symbol)
+        {
+            if (get_position(static_cast<SymbolId>(symbol), position))
+            {
+                out.push_back(position);
+            }
+        }
+        return out.size();
+    }
+
+    bool SharedPositionReader::get_totals(SharedTotals &out) const
+    {
+        return bounded_load(header_->totals, out);
+    }
+
+}
@@ -1,5 +1,7 @@
 #include "position_tracker.hpp"
+#include "position_file.hpp"
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -9,106 +11,490 @@
 namespace mm
 {
 
-    PositionTracker::PositionTracker(const PositionLimits &limits)
-        : limits_(limits)
+    PositionTracker::PositionTracker(const PositionLimits &limits, const TradeJournal::Config &journal)
+        : slots_(std::make_unique<PositionSlot[]>(MAX_SYMBOLS)),
+          active_symbols_(std::make_unique<SymbolId[]>(MAX_SYMBOLS)),
+          active_count_(0), reset_count_(0), journal_(journal), limits_(limits), wal_(nullptr), lot_method_(LotMethod::FIFO), shard_count_(0), stop_consolidation_(false), version_(0), symbol_bound_(0)
     {
+        mark_state_.sequence = std::make_unique<std::atomic<uint32_t>[]>(MAX_SYMBOLS);
+        mark_state_.long_quantity = std::make_unique<int64_t[]>(MAX_SYMBOLS);
+        mark_state_.short_quantity = std::make_unique<int64_t[]>(MAX_SYMBOLS);
+        mark_state_.avg_long_price = std::make_unique<Price[]>(MAX_SYMBOLS);
+        mark_state_.avg_short_price = std::make_unique<Price[]>(MAX_SYMBOLS);
+        mark_state_.unrealized_pnl = std::make_unique<PnL[]>(MAX_SYMBOLS);
+        mark_state_.seen_sequence = std::make_unique<uint32_t[]>(MAX_SYMBOLS);
+        mark_state_.marks = std::make_unique<Price[]>(MAX_SYMBOLS);
+        mark_state_.bbo_bid = std::make_unique<Price[]>(MAX_SYMBOLS);
+        mark_state_.bbo_ask = std::make_unique<Price[]>(MAX_SYMBOLS);
+        mark_state_.marked_pnl = std::make_unique<PnL[]>(MAX_SYMBOLS);
+        mark_state_.changed = std::make_unique<uint64_t[]>((MAX_SYMBOLS + 63) / 64);
+
+        aggregates_.realized_pnl.store(0);
+        aggregates_.unrealized_pnl.store(0);
+        aggregates_.gross_exposure.store(0);
+        aggregates_.net_exposure.store(0);
     }
 
-    bool PositionTracker::record_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id)
+    PositionTracker::~PositionTracker()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        stop_consolidation();
+    }
 
-        trade_history_[symbol].emplace_back(symbol, price, quantity, side, order_id);
+    bool PositionTracker::record_trade(SymbolId symbol, Price price, Quantity quantity, OrderSide side, OrderId order_id, Timestamp now)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return false;
+        }
 
-        update_position(symbol, price, quantity, side);
+        PositionSlot &slot = slots_[symbol];
+        std::lock_guard<SpinLock> lock(slot.write_lock);
+        activate(symbol, slot);
 
-        PnL realized_pnl = calculate_realized_pnl(symbol, price, quantity, side);
-        positions_[symbol].realized_pnl += realized_pnl;
+        // Logged under the slot lock, so a symbol's fills reach the journal in order
+        uint64_t fill_sequence = wal_ ? wal_->append(symbol, price, quantity, side, order_id, now)
+                                      : slot.position.writer_value().fill_sequence;
+        apply_fill(symbol, slot, price, quantity, side, order_id, now, fill_sequence);
 
         return true;
     }
 
-    void PositionTracker::update_unrealized_pnl(SymbolId symbol, Price current_price)
+    PositionShard &PositionTracker::create_shard()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(consolidation_mutex_);
+        size_t index = shard_count_.load(std::memory_order_relaxed);
+        if (index == MAX_POSITION_SHARDS)
+        {
+            throw std::runtime_error("Too many position shards");
+        }
+        shards_[index].reset(new PositionShard(*this));
+        shard_count_.store(index + 1, std::memory_order_release);
+        return *shards_[index];
+    }
 
-        auto it = positions_.find(symbol);
-        if (it != positions_.end())
+    size_t PositionTracker::consolidate()
+    {
+        std::lock_guard<std::mutex> lock(consolidation_mutex_);
+        size_t applied = 0;
+        size_t count = shard_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
         {
-            it->second.unrealized_pnl = calculate_unrealized_pnl(it->second, current_price);
-            it->second.last_update = get_timestamp();
+            applied += drain_shard(*shards_[i]);
         }
+        return applied;
     }
 
-    void PositionTracker::update_all_unrealized_pnl(const std::map<SymbolId, Price> &current_prices)
+    size_t PositionTracker::drain_shard(PositionShard &shard)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        // Small batches keep merged readers from waiting on a long drain
+        constexpr uint64_t batch_size = 256;
+        uint64_t tail = shard.tail_.load(std::memory_order_relaxed);
+        uint64_t head = shard.head_.load(std::memory_order_acquire);
+        size_t applied = 0;
 
-        for (auto &[symbol, position] : positions_)
+        while (tail < head)
         {
-            auto price_it = current_prices.find(symbol);
-            if (price_it != current_prices.end())
+            uint64_t end = std::min(head, tail + batch_size);
+            uint64_t sequence = shard.drain_sequence_.load(std::memory_order_relaxed);
+            shard.drain_sequence_.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (; tail < end; ++tail)
             {
-                position.unrealized_pnl = calculate_unrealized_pnl(position, price_it->second);
-                position.last_update = get_timestamp();
+                const ShardFill &fill = shard.ring_[tail & (PositionShard::RING_CAPACITY - 1)];
+                record_trade(fill.symbol, fill.price, fill.quantity, fill.side, fill.order_id, fill.timestamp);
+                std::atomic<int64_t> &folded = shard.applied_[fill.symbol];
+                int64_t signed_quantity = fill.side == OrderSide::BUY ? fill.quantity : -static_cast<int64_t>(fill.quantity);
+                folded.store(folded.load(std::memory_order_relaxed) + signed_quantity, std::memory_order_relaxed);
+                ++applied;
             }
+
+            shard.drain_sequence_.store(sequence + 2, std::memory_order_release);
+            shard.tail_.store(tail, std::memory_order_release);
         }
+        return applied;
     }
 
-    const Position *PositionTracker::get_position(SymbolId symbol) const
+    void PositionTracker::start_consolidation(std::chrono::microseconds interval)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        stop_consolidation();
+        stop_consolidation_ = false;
+        consolidation_thread_ = std::thread([this, interval]()
+                                            {
+            std::unique_lock<std::mutex> lock(consolidation_thread_mutex_);
+            while (!consolidation_cv_.wait_for(lock, interval, [&]()
+                                               { return stop_consolidation_; }))
+            {
+                lock.unlock();
+                consolidate();
+                lock.lock();
+            } });
+    }
 
-        auto it = positions_.find(symbol);
-        return (it != positions_.end()) ? &it->second : nullptr;
+    void PositionTracker::stop_consolidation()
+    {
+        {
+            std::lock_guard<std::mutex> lock(consolidation_thread_mutex_);
+            stop_consolidation_ = true;
+        }
+        consolidation_cv_.notify_one();
+        if (consolidation_thread_.joinable())
+        {
+            consolidation_thread_.join();
+        }
+        consolidate();
     }
 
-    std::map<SymbolId, Position> PositionTracker::get_all_positions() const
+    bool PositionTracker::get_merged_position(SymbolId symbol, Position &out) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return positions_;
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return false;
+        }
+
+        // Seqlock read across the base slot and every shard's pending delta:
+        // retry if any shard folded fills in while we looked
+        const PositionSlot &slot = slots_[symbol];
+        size_t count = shard_count_.load(std::memory_order_acquire);
+        uint64_t sequences[MAX_POSITION_SHARDS];
+        bool active;
+        int64_t pending;
+        bool consistent = false;
+        while (!consistent)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                while ((sequences[i] = shards_[i]->drain_sequence_.load(std::memory_order_acquire)) & 1)
+                {
+                    cpu_relax();
+                }
+            }
+
+            active = slot.active.load(std::memory_order_acquire);
+            out = slot.position.load();
+            pending = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                pending += shards_[i]->net_[symbol].load(std::memory_order_relaxed) -
+                           shards_[i]->applied_[symbol].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            consistent = true;
+            for (size_t i = 0; i < count && consistent; ++i)
+            {
+                consistent = shards_[i]->drain_sequence_.load(std::memory_order_relaxed) == sequences[i];
+            }
+        }
+
+        if (!active)
+        {
+            if (pending == 0)
+            {
+                return false;
+            }
+            out = Position();
+            out.symbol = symbol;
+        }
+        if (pending != 0)
+        {
+            int64_t net = out.get_net_position() + pending;
+            bool was_long = out.long_quantity > 0;
+            bool was_short = out.short_quantity > 0;
+            out.long_quantity = net > 0 ? static_cast<Quantity>(net) : 0;
+            out.short_quantity = net < 0 ? static_cast<Quantity>(-net) : 0;
+            out.avg_long_price = net > 0 && was_long ? out.avg_long_price : 0;
+            out.avg_short_price = net < 0 && was_short ? out.avg_short_price : 0;
+        }
+        return true;
     }
 
-    PnL PositionTracker::get_total_realized_pnl() const
+    size_t PositionTracker::recover(const FillWal &wal)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        size_t applied = 0;
+        wal.replay([&](const FillRecord &record)
+                   {
+            if (record.symbol >= MAX_SYMBOLS)
+            {
+                return;
+            }
+
+            PositionSlot &slot = slots_[record.symbol];
+            std::lock_guard<SpinLock> lock(slot.write_lock);
+            if (record.sequence <= slot.position.writer_value().fill_sequence)
+            {
+                return; // Already in the snapshot
+            }
+            activate(record.symbol, slot);
+            apply_fill(record.symbol, slot, record.price, record.quantity, record.side, record.order_id,
+                       record.timestamp, record.sequence);
+            ++applied; });
+        return applied;
+    }
 
-        PnL total = 0;
-        for (const auto &[symbol, position] : positions_)
+    void PositionTracker::apply_fill(SymbolId symbol, PositionSlot &slot, Price price, Quantity quantity, OrderSide side,
+                                     OrderId order_id, Timestamp now, uint64_t fill_sequence)
+    {
+        Trade trade(symbol, price, quantity, side, order_id, now);
+        trade.sequence = journal_.append(trade);
+        if (!slot.recent_trades)
         {
-            total += position.realized_pnl;
+            // Allocated on the first fill, not on activation, so positions
+            // restored from disk cost nothing until they trade. The ring
+            // outlives reset(), so this allocates once per symbol.
+            slot.recent_trades = std::make_unique<Trade[]>(RECENT_TRADES_PER_SYMBOL);
         }
-        return total;
+        slot.recent_trades[slot.trade_count++ % RECENT_TRADES_PER_SYMBOL] = trade;
+
+        ensure_lots(slot);
+        PnL realized = slot.lots.fill(lot_pool_, lot_method_, price, quantity, side, order_id, now);
+        slot.position.write([&](Position &position)
+                            {
+            update_position(position, symbol, slot.lots, now);
+            position.realized_pnl += realized;
+            position.fill_sequence = fill_sequence; });
+        slot.mark_price = price;
+        update_aggregates(slot);
+        sync_mark_state(symbol, slot.position.writer_value());
+        mark_changed(symbol, slot);
     }
 
-    PnL PositionTracker::get_total_unrealized_pnl() const
+    void PositionTracker::update_unrealized_pnl(SymbolId symbol, Price current_price, Timestamp now)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
 
-        PnL total = 0;
-        for (const auto &[symbol, position] : positions_)
+        PositionSlot &slot = slots_[symbol];
+        std::lock_guard<SpinLock> lock(slot.write_lock);
+        if (slot.active.load(std::memory_order_relaxed))
         {
-            total += position.unrealized_pnl;
+            slot.position.write([&](Position &position)
+                                {
+                position.unrealized_pnl = calculate_unrealized_pnl(position, current_price);
+                position.last_update = now; });
+            slot.mark_price = current_price;
+            update_aggregates(slot);
+            sync_mark_state(symbol, slot.position.writer_value());
+            mark_changed(symbol, slot);
         }
-        return total;
     }
 
-    PnL PositionTracker::get_total_pnl() const
+    size_t PositionTracker::mark_to_market(const Price *best_bids, const Price *best_asks, Timestamp now)
     {
-        return get_total_realized_pnl() + get_total_unrealized_pnl();
+        std::lock_guard<std::mutex> pass_lock(mark_mutex_);
+        return mark_pass(best_bids, best_asks, symbol_bound_.load(std::memory_order_acquire), now);
     }
 
-    bool PositionTracker::check_position_limits(SymbolId symbol, Quantity quantity, OrderSide side) const
+    size_t PositionTracker::mark_to_market(const std::atomic<Price> *best_bids, const std::atomic<Price> *best_asks, Timestamp now)
+    {
+        std::lock_guard<std::mutex> pass_lock(mark_mutex_);
+        MarkState &state = mark_state_;
+        size_t count = symbol_bound_.load(std::memory_order_acquire);
+
+        // Book threads keep publishing; the kernel reads a plain snapshot
+        for (size_t i = 0; i < count; ++i)
+        {
+            state.bbo_bid[i] = best_bids[i].load(std::memory_order_relaxed);
+            state.bbo_ask[i] = best_asks[i].load(std::memory_order_relaxed);
+        }
+        return mark_pass(state.bbo_bid.get(), state.bbo_ask.get(), count, now);
+    }
+
+    // Caller holds mark_mutex_
+    size_t PositionTracker::mark_pass(const Price *best_bids, const Price *best_asks, size_t count, Timestamp now)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        MarkState &state = mark_state_;
+
+        // Row versions before the pass; a row that moves under us is redone below
+        for (size_t i = 0; i < count; ++i)
+        {
+            state.seen_sequence[i] = state.sequence[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
 
-        auto it = positions_.find(symbol);
-        if (it == positions_.end())
+        MarkToMarketInput input{state.long_quantity.get(), state.short_quantity.get(),
+                                state.avg_long_price.get(), state.avg_short_price.get(),
+                                state.unrealized_pnl.get(), best_bids, best_asks};
+        mark_to_market_kernel(input, count, state.marks.get(), state.marked_pnl.get(), state.changed.get());
+
+        // Publish only the positions whose P&L moved; totals move once at the end
+        Contribution delta{};
+        size_t updated = 0;
+        for (size_t word = 0; word < (count + 63) / 64; ++word)
+        {
+            uint64_t bits = state.changed[word];
+            while (bits)
+            {
+                SymbolId symbol = static_cast<SymbolId>(word * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+                bits &= bits - 1;
+
+                PositionSlot &slot = slots_[symbol];
+                std::lock_guard<SpinLock> lock(slot.write_lock);
+                if (!slot.active.load(std::memory_order_relaxed))
+                {
+                    continue;
+                }
+
+                Price mark = state.marks[symbol];
+                PnL pnl = state.marked_pnl[symbol];
+                uint32_t seen = state.seen_sequence[symbol];
+                if ((seen & 1) || state.sequence[symbol].load(std::memory_order_relaxed) != seen)
+                {
+                    pnl = calculate_unrealized_pnl(slot.position.writer_value(), mark); // Raced a fill
+                }
+
+                slot.position.write([&](Position &position)
+                                    {
+                    position.unrealized_pnl = pnl;
+                    position.last_update = now; });
+                slot.mark_price = mark;
+                accumulate_contribution(slot, delta);
+                sync_mark_state(symbol, slot.position.writer_value());
+                mark_changed(symbol, slot);
+                ++updated;
+            }
+        }
+        add_to_aggregates(delta);
+        sample_equity(now);
+
+        return updated;
+    }
+
+    void PositionTracker::update_all_unrealized_pnl(const std::map<SymbolId, Price> &current_prices, Timestamp now)
+    {
+        for (const auto &[symbol, price] : current_prices)
+        {
+            update_unrealized_pnl(symbol, price, now);
+        }
+        sample_equity(now);
+    }
+
+    bool PositionTracker::sample_equity(Timestamp now)
+    {
+        std::unique_lock<SpinLock> lock(equity_lock_, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return false;
+        }
+        equity_curve_.sample(get_total_pnl(), now);
+        return true;
+    }
+
+    bool PositionTracker::get_position(SymbolId symbol, Position &out) const
+    {
+        if (symbol >= MAX_SYMBOLS || !slots_[symbol].active.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        out = slots_[symbol].position.load();
+        return true;
+    }
+
+    size_t PositionTracker::get_positions(const SymbolId *symbols, size_t count, Position *out) const
+    {
+        // Sequence numbers for the whole subset; small subsets stay on the stack
+        constexpr size_t inline_count = 64;
+        uint64_t inline_seqs[inline_count];
+        std::vector<uint64_t> heap_seqs;
+        uint64_t *seqs = inline_seqs;
+        if (count > inline_count)
+        {
+            heap_seqs.resize(count);
+            seqs = heap_seqs.data();
+        }
+
+        // Copy every slot, then retry unless no writer touched any of them
+        bool consistent = false;
+        while (!consistent)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (symbols[i] < MAX_SYMBOLS)
+                {
+                    const Seqlock<Position> &position = slots_[symbols[i]].position;
+                    seqs[i] = position.begin_read();
+                    position.copy_to(out[i]);
+                }
+            }
+
+            consistent = true;
+            for (size_t i = 0; i < count && consistent; ++i)
+            {
+                consistent = symbols[i] >= MAX_SYMBOLS || slots_[symbols[i]].position.validate(seqs[i]);
+            }
+        }
+
+        size_t traded = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (symbols[i] < MAX_SYMBOLS && slots_[symbols[i]].active.load(std::memory_order_acquire))
+            {
+                ++traded;
+            }
+            else
+            {
+                out[i] = Position();
+                out[i].symbol = symbols[i];
+            }
+        }
+        return traded;
+    }
+
+    uint64_t PositionTracker::get_positions_changed_since(uint64_t since, std::vector<Position> &out) const
+    {
+        // Writes that race with this bump are restamped by mark_changed, so
+        // they show up in this poll or the next one
+        uint64_t version = version_.fetch_add(1, std::memory_order_seq_cst);
+
+        out.clear();
+        for_each_active([&](SymbolId, const PositionSlot &slot)
+                        {
+            if (slot.changed_version.load(std::memory_order_seq_cst) >= since)
+            {
+                out.push_back(slot.position.load());
+            } });
+
+        return version + 1;
+    }
+
+    size_t PositionTracker::get_open_lots(SymbolId symbol, Lot *out, size_t max) const
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return 0;
+        }
+        PositionSlot &slot = slots_[symbol];
+        std::lock_guard<SpinLock> lock(slot.write_lock);
+        if (slot.lots_pending && max > 0)
+        {
+            // Restored and not traded since: the single lot ensure_lots() would build
+            const Position &position = slot.position.writer_value();
+            bool is_long = position.long_quantity > 0;
+            out[0] = Lot{is_long ? position.avg_long_price : position.avg_short_price,
+                         is_long ? position.long_quantity : position.short_quantity, 0, position.last_update};
+            return 1;
+        }
+        return slot.lots.copy_to(out, max);
+    }
+
+    std::map<SymbolId, Position> PositionTracker::get_all_positions() const
+    {
+        std::map<SymbolId, Position> positions;
+        for_each_active([&](SymbolId symbol, const PositionSlot &slot)
+                        { positions.emplace(symbol, slot.position.load()); });
+        return positions;
+    }
+
+    bool PositionTracker::check_position_limits(SymbolId symbol, Quantity quantity, OrderSide side) const
+    {
+        if (symbol >= MAX_SYMBOLS || !slots_[symbol].active.load(std::memory_order_acquire))
         {
             return quantity <= limits_.max_position_size;
         }
 
-        const Position &pos = it->second;
+        const Position pos = slots_[symbol].position.load();
         int64_t net_position = pos.get_net_position();
 
         if (side == OrderSide::BUY)
@@ -137,8 +523,6 @@ namespace mm
 
     bool PositionTracker::check_risk_limits() const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
         PnL total_pnl = get_total_pnl();
 
         if (total_pnl < -limits_.max_daily_loss)
@@ -146,7 +530,9 @@ namespace mm
             return false;
         }
 
-        if (total_pnl < -limits_.max_drawdown)
+        // Drawdown from the sampled peak to the live total, so fills since
+        // the last sample count too
+        if (equity_curve_.peak() - total_pnl > limits_.max_drawdown)
         {
             return false;
         }
@@ -156,45 +542,71 @@ namespace mm
 
     std::vector<Trade> PositionTracker::get_trade_history(SymbolId symbol) const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return {};
+        }
 
-        auto it = trade_history_.find(symbol);
-        if (it != trade_history_.end())
+        // Oldest to newest out of the ring
+        std::vector<Trade> recent;
+        uint64_t count;
         {
-            return it->second;
+            PositionSlot &slot = slots_[symbol];
+            std::lock_guard<SpinLock> lock(slot.write_lock);
+            count = slot.trade_count;
+            uint64_t first = count > RECENT_TRADES_PER_SYMBOL ? count - RECENT_TRADES_PER_SYMBOL : 0;
+            recent.reserve(count - first);
+            for (uint64_t i = first; i < count; ++i)
+            {
+                recent.push_back(slot.recent_trades[i % RECENT_TRADES_PER_SYMBOL]);
+            }
         }
-        return {};
+        if (count <= RECENT_TRADES_PER_SYMBOL)
+        {
+            return recent;
+        }
+
+        // Older trades have left the ring; scan what the journal still maps
+        std::vector<Trade> trades;
+        journal_.for_each(0, journal_.size(), [&](uint64_t, const Trade &trade)
+                          {
+            if (trade.symbol == symbol)
+            {
+                trades.push_back(trade);
+            } });
+        return trades.size() >= recent.size() ? trades : recent;
     }
 
     std::vector<Trade> PositionTracker::get_all_trade_history() const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
+        // The journal is already in global sequence order
         std::vector<Trade> all_trades;
-        for (const auto &[symbol, trades] : trade_history_)
-        {
-            all_trades.insert(all_trades.end(), trades.begin(), trades.end());
-        }
-
-        std::sort(all_trades.begin(), all_trades.end(),
-                  [](const Trade &a, const Trade &b)
-                  { return a.timestamp < b.timestamp; });
-
+        uint64_t first = journal_.first_available();
+        uint64_t last = journal_.size();
+        all_trades.reserve(last > first ? last - first : 0);
+        journal_.for_each(first, last, [&](uint64_t, const Trade &trade)
+                          { all_trades.push_back(trade); });
         return all_trades;
     }
 
+    size_t PositionTracker::get_trade_history_page(uint64_t from_sequence, Trade *out, size_t max_trades) const
+    {
+        return journal_.read(from_sequence, out, max_trades);
+    }
+
     void PositionTracker::clear_trade_history()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        trade_history_.clear();
+        for_each_active([](SymbolId, PositionSlot &slot)
+                        {
+            std::lock_guard<SpinLock> lock(slot.write_lock);
+            slot.trade_count = 0; });
+        journal_.trim();
     }
 
     PositionTracker::Stats PositionTracker::get_stats() const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
         Stats stats{
-            .total_symbols = positions_.size(),
+            .total_symbols = active_count_.load(std::memory_order_acquire),
             .active_positions = 0,
             .total_realized_pnl = 0,
             .total_unrealized_pnl = 0,
@@ -202,8 +614,9 @@ namespace mm
             .max_position_size = 0,
             .largest_position_symbol = 0};
 
-        for (const auto &[symbol, position] : positions_)
-        {
+        for_each_active([&](SymbolId symbol, const PositionSlot &slot)
+                        {
+            const Position position = slot.position.load();
             if (!position.is_flat())
             {
                 stats.active_positions++;
@@ -217,8 +630,7 @@ namespace mm
             {
                 stats.max_position_size = total_size;
                 stats.largest_position_symbol = symbol;
-            }
-        }
+            } });
 
         stats.total_pnl = stats.total_realized_pnl + stats.total_unrealized_pnl;
 
@@ -227,80 +639,166 @@ namespace mm
 
     void PositionTracker::reset()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        positions_.clear();
-        trade_history_.clear();
+        std::lock_guard<std::mutex> activation_lock(activation_mutex_);
+
+        for_each_active([&](SymbolId symbol, PositionSlot &slot)
+                        {
+            std::lock_guard<SpinLock> lock(slot.write_lock);
+            slot.position.store(Position());
+            slot.trade_count = 0;
+            slot.mark_price = 0;
+            slot.contribution = Contribution{};
+            slot.lots.clear(lot_pool_);
+            slot.lots_pending = false;
+            sync_mark_state(symbol, Position());
+            slot.active.store(false, std::memory_order_release);
+            mark_changed(symbol, slot); });
+        active_count_.store(0, std::memory_order_release);
+        aggregates_.realized_pnl.store(0, std::memory_order_relaxed);
+        aggregates_.unrealized_pnl.store(0, std::memory_order_relaxed);
+        aggregates_.gross_exposure.store(0, std::memory_order_relaxed);
+        aggregates_.net_exposure.store(0, std::memory_order_relaxed);
+        journal_.trim();
+
+        std::lock_guard<SpinLock> equity_lock(equity_lock_);
+        equity_curve_.reset();
+        reset_count_.fetch_add(1, std::memory_order_release);
     }
 
-    void PositionTracker::update_position(SymbolId symbol, Price price, Quantity quantity, OrderSide side)
+    void PositionTracker::update_aggregates(PositionSlot &slot)
     {
-        Position &position = positions_[symbol];
-        position.symbol = symbol;
-        position.last_update = get_timestamp();
+        Contribution delta{};
+        accumulate_contribution(slot, delta);
+        add_to_aggregates(delta);
+    }
 
-        if (side == OrderSide::BUY)
+    void PositionTracker::accumulate_contribution(PositionSlot &slot, Contribution &delta)
+    {
+        const Position &position = slot.position.writer_value();
+        PnL net = position.get_net_position() * slot.mark_price;
+        Contribution now{position.realized_pnl, position.unrealized_pnl, net < 0 ? -net : net, net};
+        Contribution &was = slot.contribution;
+
+        delta.realized_pnl += now.realized_pnl - was.realized_pnl;
+        delta.unrealized_pnl += now.unrealized_pnl - was.unrealized_pnl;
+        delta.gross_exposure += now.gross_exposure - was.gross_exposure;
+        delta.net_exposure += now.net_exposure - was.net_exposure;
+        was = now;
+    }
+
+    void PositionTracker::add_to_aggregates(const Contribution &delta)
+    {
+        auto move = [](std::atomic<PnL> &total, PnL change)
         {
-            // Buying - increase long position
-            if (position.long_quantity == 0)
+            if (change != 0)
             {
-                position.avg_long_price = price;
+                total.fetch_add(change, std::memory_order_relaxed);
             }
-            else
-            {
-                // Weighted average price
-                Price total_value = position.avg_long_price * position.long_quantity + price * quantity;
-                position.avg_long_price = total_value / (position.long_quantity + quantity);
-            }
-            position.long_quantity += quantity;
+        };
+        move(aggregates_.realized_pnl, delta.realized_pnl);
+        move(aggregates_.unrealized_pnl, delta.unrealized_pnl);
+        move(aggregates_.gross_exposure, delta.gross_exposure);
+        move(aggregates_.net_exposure, delta.net_exposure);
+    }
+
+    void PositionTracker::sync_mark_state(SymbolId symbol, const Position &position)
+    {
+        MarkState &state = mark_state_;
+        uint32_t sequence = state.sequence[symbol].load(std::memory_order_relaxed);
+        state.sequence[symbol].store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        state.long_quantity[symbol] = position.long_quantity;
+        state.short_quantity[symbol] = position.short_quantity;
+        state.avg_long_price[symbol] = position.avg_long_price;
+        state.avg_short_price[symbol] = position.avg_short_price;
+        state.unrealized_pnl[symbol] = position.unrealized_pnl;
+
+        state.sequence[symbol].store(sequence + 2, std::memory_order_release);
+    }
+
+    void PositionTracker::enable_dirty_tracking()
+    {
+        dirty_bits_ = std::make_unique<std::atomic<uint64_t>[]>((MAX_SYMBOLS + 63) / 64);
+    }
+
+    void PositionTracker::mark_changed(SymbolId symbol, PositionSlot &slot)
+    {
+        // Store-then-recheck against the poll bump: if a poll advanced the
+        // version while we stamped, restamp so the next poll still sees us
+        uint64_t version = version_.load(std::memory_order_seq_cst);
+        slot.changed_version.store(version, std::memory_order_seq_cst);
+        uint64_t current = version_.load(std::memory_order_seq_cst);
+        if (current != version)
+        {
+            slot.changed_version.store(current, std::memory_order_seq_cst);
         }
-        else
+
+        if (dirty_bits_)
         {
-            // Selling - increase short position
-            if (position.short_quantity == 0)
-            {
-                position.avg_short_price = price;
-            }
-            else
-            {
-                // Weighted average price
-                Price total_value = position.avg_short_price * position.short_quantity + price * quantity;
-                position.avg_short_price = total_value / (position.short_quantity + quantity);
-            }
-            position.short_quantity += quantity;
+            dirty_bits_[symbol / 64].fetch_or(1ull << (symbol % 64), std::memory_order_release);
         }
     }
 
-    PnL PositionTracker::calculate_realized_pnl(SymbolId symbol, Price price, Quantity quantity, OrderSide side)
+    void PositionTracker::activate(SymbolId symbol, PositionSlot &slot)
     {
-        auto it = positions_.find(symbol);
-        if (it == positions_.end())
+        if (slot.active.load(std::memory_order_relaxed))
         {
-            return 0; // No existing position
+            return;
         }
 
-        const Position &position = it->second;
-        PnL pnl = 0;
-
-        if (side == OrderSide::BUY)
+        // First trade for this symbol: publish it to the active list
+        std::lock_guard<std::mutex> lock(activation_mutex_);
+        size_t index = active_count_.load(std::memory_order_relaxed);
+        active_symbols_[index] = symbol;
+        active_count_.store(index + 1, std::memory_order_release);
+        if (symbol >= symbol_bound_.load(std::memory_order_relaxed))
         {
-            // Buying - check if we have short position to cover
-            if (position.short_quantity > 0)
-            {
-                Quantity cover_qty = std::min(quantity, position.short_quantity);
-                pnl = (position.avg_short_price - price) * cover_qty; // Profit when covering short
-            }
+            symbol_bound_.store(symbol + 1, std::memory_order_release);
         }
-        else
+        slot.active.store(true, std::memory_order_release);
+    }
+
+    void PositionTracker::update_position(Position &position, SymbolId symbol, const LotQueue &lots, Timestamp now)
+    {
+        position.symbol = symbol;
+        position.last_update = now;
+
+        // Lots are all on one side, so at most one quantity is non-zero
+        bool is_long = lots.side() == OrderSide::BUY;
+        position.long_quantity = is_long ? lots.quantity() : 0;
+        position.short_quantity = is_long ? 0 : lots.quantity();
+        position.avg_long_price = is_long ? lots.average_price() : 0;
+        position.avg_short_price = is_long ? 0 : lots.average_price();
+    }
+
+    void PositionTracker::seed_lots(SymbolId symbol, PositionSlot &slot, Position &position)
+    {
+        slot.lots.clear(lot_pool_);
+        bool is_long = position.long_quantity >= position.short_quantity;
+        Quantity open = is_long ? position.long_quantity - position.short_quantity : position.short_quantity - position.long_quantity;
+        Price price = open == 0 ? 0 : is_long ? position.avg_long_price : position.avg_short_price;
+
+        position.symbol = symbol;
+        position.long_quantity = is_long ? open : 0;
+        position.short_quantity = is_long ? 0 : open;
+        position.avg_long_price = is_long ? price : 0;
+        position.avg_short_price = is_long ? 0 : price;
+        slot.lots_pending = open > 0;
+    }
+
+    void PositionTracker::ensure_lots(PositionSlot &slot)
+    {
+        if (!slot.lots_pending)
         {
-            // Selling - check if we have long position to sell
-            if (position.long_quantity > 0)
-            {
-                Quantity sell_qty = std::min(quantity, position.long_quantity);
-                pnl = (price - position.avg_long_price) * sell_qty; // Profit when selling long
-            }
+            return;
         }
-
-        return pnl;
+        const Position &position = slot.position.writer_value();
+        bool is_long = position.long_quantity > 0;
+        slot.lots.fill(lot_pool_, lot_method_, is_long ? position.avg_long_price : position.avg_short_price,
+                       is_long ? position.long_quantity : position.short_quantity, is_long ? OrderSide::BUY : OrderSide::SELL,
+                       0, position.last_update);
+        slot.lots_pending = false;
     }
 
     PnL PositionTracker::calculate_unrealized_pnl(const Position &position, Price current_price) const
@@ -322,17 +820,53 @@ namespace mm
         return pnl;
     }
 
-    MMapPositionTracker::MMapPositionTracker(const std::string &file_path, const PositionLimits &limits)
-        : PositionTracker(limits), file_path_(file_path), mmap_ptr_(nullptr), mmap_size_(0), fd_(-1)
+    MMapPositionTracker::MMapPositionTracker(const std::string &file_path, const PositionLimits &limits,
+                                             std::chrono::milliseconds sync_interval)
+        : PositionTracker(limits), file_path_(file_path), mmap_ptr_(nullptr), mmap_size_(0), fd_(-1),
+          records_(nullptr), legacy_(false), sync_interval_(sync_interval), stop_(false)
     {
-        init_mmap();
-        load();
+        enable_dirty_tracking();
+        try
+        {
+            init_mmap();
+            load();
+        }
+        catch (...)
+        {
+            if (mmap_ptr_ != nullptr)
+            {
+                munmap(mmap_ptr_, mmap_size_);
+            }
+            if (fd_ != -1)
+            {
+                close(fd_);
+            }
+            throw;
+        }
+        if (sync_interval_.count() > 0)
+        {
+            sync_thread_ = std::thread(&MMapPositionTracker::sync_loop, this);
+        }
     }
 
     MMapPositionTracker::~MMapPositionTracker()
     {
+        // Pending shard fills must reach the slots before the final flush
+        stop_consolidation();
+
+        {
+            std::lock_guard<std::mutex> lock(sync_mutex_);
+            stop_ = true;
+        }
+        sync_cv_.notify_one();
+        if (sync_thread_.joinable())
+        {
+            sync_thread_.join();
+        }
+
         if (mmap_ptr_ != nullptr)
         {
+            flush();
             munmap(mmap_ptr_, mmap_size_);
         }
         if (fd_ != -1)
@@ -341,46 +875,109 @@ namespace mm
         }
     }
 
-    void MMapPositionTracker::flush()
+    size_t MMapPositionTracker::flush()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(mmap_mutex_);
+        return flush_locked();
+    }
+
+    size_t MMapPositionTracker::flush_locked()
+    {
+        size_t written = 0;
+        size_t first = MAX_SYMBOLS;
+        size_t last = 0;
 
-        size_t required_size = positions_.size() * sizeof(Position);
-        if (required_size > mmap_size_)
+        for (size_t word = 0; word < (MAX_SYMBOLS + 63) / 64; ++word)
         {
-            resize_mmap(required_size);
+            uint64_t bits = dirty_bits_[word].exchange(0, std::memory_order_acquire);
+            while (bits)
+            {
+                size_t symbol = word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+
+                const PositionSlot &slot = slots_[symbol];
+                records_[symbol] = slot.active.load(std::memory_order_acquire) ? to_position_record(slot.position.load())
+                                                                                : PositionRecord{};
+                first = std::min(first, symbol);
+                last = symbol;
+                ++written;
+            }
         }
 
-        Position *mmap_positions = static_cast<Position *>(mmap_ptr_);
-        size_t i = 0;
-        for (const auto &[symbol, position] : positions_)
+        // Sync only the pages holding the slots just written
+        if (written > 0)
         {
-            mmap_positions[i++] = position;
+            static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t begin = (POSITION_FILE_HEADER_SIZE + first * sizeof(PositionRecord)) / page_size * page_size;
+            size_t end = POSITION_FILE_HEADER_SIZE + (last + 1) * sizeof(PositionRecord);
+            msync(static_cast<char *>(mmap_ptr_) + begin, end - begin, MS_SYNC);
         }
 
-        msync(mmap_ptr_, mmap_size_, MS_SYNC);
+        return written;
     }
 
     void MMapPositionTracker::load()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(mmap_mutex_);
 
-        if (mmap_size_ == 0)
+        reset();
+        if (legacy_)
         {
+            load_legacy();
             return;
         }
 
-        const Position *mmap_positions = static_cast<const Position *>(mmap_ptr_);
-        size_t position_count = mmap_size_ / sizeof(Position);
+        // Records are slot-indexed and checked in place; nothing is staged
+        for (size_t i = 1; i < MAX_SYMBOLS; ++i)
+        {
+            const PositionRecord &record = records_[i];
+            if (record.symbol == 0)
+            {
+                continue;
+            }
+            if (record.symbol != i || record.crc != position_record_checksum(record))
+            {
+                throw std::runtime_error("Corrupt position record for symbol " + std::to_string(i) + ": " + file_path_);
+            }
+            restore(static_cast<SymbolId>(i), from_position_record(record));
+        }
 
-        positions_.clear();
-        for (size_t i = 0; i < position_count; ++i)
+        // The file already matches memory
+        for (size_t word = 0; word < (MAX_SYMBOLS + 63) / 64; ++word)
         {
-            if (mmap_positions[i].symbol != 0)
+            dirty_bits_[word].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void MMapPositionTracker::restore(SymbolId symbol, const Position &loaded)
+    {
+        Position position = loaded;
+        PositionSlot &slot = slots_[symbol];
+        std::lock_guard<SpinLock> slot_lock(slot.write_lock);
+        activate(symbol, slot);
+        seed_lots(symbol, slot, position);
+        slot.position.store(position);
+        update_aggregates(slot);
+        sync_mark_state(symbol, position);
+        mark_changed(symbol, slot);
+    }
+
+    void MMapPositionTracker::load_legacy()
+    {
+        // Bare Position arrays, slot-indexed or packed; an empty file is a
+        // new one. Stage them, reformat the file, then write every slot.
+        std::vector<Position> positions(static_cast<const Position *>(mmap_ptr_),
+                                        static_cast<const Position *>(mmap_ptr_) + mmap_size_ / sizeof(Position));
+        format_file();
+        for (const Position &position : positions)
+        {
+            if (position.symbol != 0 && position.symbol < MAX_SYMBOLS)
             {
-                positions_[mmap_positions[i].symbol] = mmap_positions[i];
+                restore(position.symbol, position);
             }
         }
+        flush_locked();
+        msync(mmap_ptr_, mmap_size_, MS_SYNC);
     }
 
     void MMapPositionTracker::init_mmap()
@@ -394,47 +991,79 @@ namespace mm
         struct stat st;
         if (fstat(fd_, &st) == -1)
         {
-            close(fd_);
             throw std::runtime_error("Failed to get file stats");
         }
 
-        mmap_size_ = st.st_size;
-        if (mmap_size_ == 0)
+        size_t file_size = static_cast<size_t>(st.st_size);
+        if (file_size == 0)
+        {
+            legacy_ = true;
+            return;
+        }
+
+        map_file(file_size);
+        legacy_ = !is_position_file(mmap_ptr_, mmap_size_);
+        if (legacy_)
         {
-            mmap_size_ = 1024 * 1024; // 1MB initial size
-            if (ftruncate(fd_, mmap_size_) == -1)
+            if (file_size % sizeof(Position) != 0)
             {
-                close(fd_);
-                throw std::runtime_error("Failed to resize file");
+                throw std::runtime_error("Not a position file: " + file_path_);
             }
+            return;
         }
 
-        mmap_ptr_ = mmap(nullptr, mmap_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
-        if (mmap_ptr_ == MAP_FAILED)
+        const PositionFileHeader &header = *static_cast<const PositionFileHeader *>(mmap_ptr_);
+        validate_position_file_header(header, mmap_size_, file_path_);
+        if (header.record_count != MAX_SYMBOLS)
         {
-            close(fd_);
-            throw std::runtime_error("Failed to mmap position file");
+            throw std::runtime_error("Position file holds " + std::to_string(header.record_count) + " symbols, expected " +
+                                     std::to_string(MAX_SYMBOLS) + ": " + file_path_);
         }
+        records_ = reinterpret_cast<PositionRecord *>(static_cast<char *>(mmap_ptr_) + POSITION_FILE_HEADER_SIZE);
     }
 
-    void MMapPositionTracker::resize_mmap(size_t new_size)
+    void MMapPositionTracker::map_file(size_t size)
     {
         if (mmap_ptr_ != nullptr)
         {
             munmap(mmap_ptr_, mmap_size_);
+            mmap_ptr_ = nullptr;
+        }
+        mmap_size_ = size;
+        mmap_ptr_ = mmap(nullptr, mmap_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mmap_ptr_ == MAP_FAILED)
+        {
+            mmap_ptr_ = nullptr;
+            throw std::runtime_error("Failed to mmap position file");
         }
+    }
 
-        if (ftruncate(fd_, new_size) == -1)
+    void MMapPositionTracker::format_file()
+    {
+        // One slot per SymbolId after the header, so the file never grows after this
+        size_t size = POSITION_FILE_HEADER_SIZE + MAX_SYMBOLS * sizeof(PositionRecord);
+        if (ftruncate(fd_, 0) == -1 || ftruncate(fd_, static_cast<off_t>(size)) == -1)
         {
             throw std::runtime_error("Failed to resize file");
         }
+        map_file(size);
 
-        mmap_size_ = new_size;
-        mmap_ptr_ = mmap(nullptr, mmap_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
-        if (mmap_ptr_ == MAP_FAILED)
+        PositionFileHeader header = make_position_file_header(MAX_SYMBOLS);
+        std::memcpy(mmap_ptr_, &header, sizeof(header));
+        records_ = reinterpret_cast<PositionRecord *>(static_cast<char *>(mmap_ptr_) + POSITION_FILE_HEADER_SIZE);
+        legacy_ = false;
+    }
+
+    void MMapPositionTracker::sync_loop()
+    {
+        std::unique_lock<std::mutex> lock(sync_mutex_);
+        while (!sync_cv_.wait_for(lock, sync_interval_, [&]()
+                                  { return stop_; }))
         {
-            throw std::runtime_error("Failed to remap position file");
+            lock.unlock();
+            flush();
+            lock.lock();
         }
     }
 
-}
\ No newline at end of file
+}
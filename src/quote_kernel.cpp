@@ -0,0 +1,78 @@
+#include "quote_kernel.hpp"
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace mm
+{
+
+    namespace
+    {
+#if defined(__AVX2__)
+        // Arithmetic right shift of 64-bit lanes, which AVX2 lacks
+        inline __m256i srai_epi64(__m256i x, int bits)
+        {
+            __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), x);
+            return _mm256_or_si256(_mm256_srli_epi64(x, bits), _mm256_slli_epi64(sign, 64 - bits));
+        }
+
+        inline __m256i clamp_epi64(__m256i x, __m256i low, __m256i high)
+        {
+            x = _mm256_blendv_epi8(x, high, _mm256_cmpgt_epi64(x, high));
+            return _mm256_blendv_epi8(x, low, _mm256_cmpgt_epi64(low, x));
+        }
+#endif
+    }
+
+    SkewedQuoteParams make_skewed_quote_params(Price min_spread, Price max_spread, Quantity max_inventory)
+    {
+        if (max_inventory == 0 || min_spread < 0 || max_spread < min_spread)
+        {
+            throw std::invalid_argument("Skewed quotes need max_inventory > 0 and 0 <= min_spread <= max_spread");
+        }
+        SkewedQuoteParams params;
+        params.min_spread = min_spread;
+        params.mid_coefficient = (max_spread << QUOTE_FIXED_POINT_BITS) / (2 * static_cast<int64_t>(max_inventory));
+        params.spread_coefficient = ((max_spread - min_spread) << QUOTE_FIXED_POINT_BITS) / static_cast<int64_t>(max_inventory);
+        if (params.mid_coefficient > INT32_MAX || params.spread_coefficient > INT32_MAX)
+        {
+            throw std::invalid_argument("Spread per share of inventory too large for fixed-point quotes");
+        }
+        return params;
+    }
+
+    void skewed_quote_kernel(const Price *fair_value, const int64_t *inventory, size_t count,
+                             const SkewedQuoteParams &params, Price *bid, Price *ask)
+    {
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256i low = _mm256_set1_epi64x(-QUOTE_INVENTORY_LIMIT);
+        const __m256i high = _mm256_set1_epi64x(QUOTE_INVENTORY_LIMIT);
+        const __m256i mid_coefficient = _mm256_set1_epi64x(params.mid_coefficient);
+        const __m256i spread_coefficient = _mm256_set1_epi64x(params.spread_coefficient);
+        const __m256i min_spread = _mm256_set1_epi64x(params.min_spread);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i inv = clamp_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(inventory + i)), low, high);
+            // Clamped inventory fits the low 32 bits, which is all the
+            // 32x32->64 multiplies read
+            __m256i offset = srai_epi64(_mm256_mul_epi32(inv, mid_coefficient), QUOTE_FIXED_POINT_BITS);
+            __m256i widen = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_abs_epi32(inv), spread_coefficient), QUOTE_FIXED_POINT_BITS);
+            __m256i half = _mm256_srli_epi64(_mm256_add_epi64(min_spread, widen), 1);
+            __m256i mid = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(fair_value + i)), offset);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(bid + i), _mm256_sub_epi64(mid, half));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(ask + i), _mm256_add_epi64(mid, half));
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            skewed_quote(fair_value[i], inventory[i], params, bid[i], ask[i]);
+        }
+    }
+
+}
@@ -0,0 +1,192 @@
+#include "quote_manager.hpp"
+#include "order_book.hpp"
+#include "risk_gate.hpp"
+#include "fill_simulator.hpp"
+#include <algorithm>
+
+namespace mm
+{
+
+    QuoteManager::QuoteManager(OrderId first_order_id, const QuoteManagerConfig &config)
+        : config_(config), risk_gate_(nullptr), simulator_(nullptr), next_order_id_(first_order_id), stats_{0, 0, 0, 0, 0},
+          quotes_(std::make_unique<SymbolQuotes[]>(MAX_SYMBOLS))
+    {
+    }
+
+    void QuoteManager::update(OrderBookManager &order_books, SymbolId symbol, const QuoteTarget &target, Timestamp now)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+        SymbolQuotes &quotes = quotes_[symbol];
+        update_side(order_books, symbol, OrderSide::BUY, quotes.bid, target.bid_price, target.bid_size, now);
+        update_side(order_books, symbol, OrderSide::SELL, quotes.ask, target.ask_price, target.ask_size, now);
+    }
+
+    void QuoteManager::update_side(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order,
+                                   Price price, Quantity size, Timestamp now)
+    {
+        bool wanted = price > 0 && size > 0;
+        if (!order.order_id)
+        {
+            if (wanted)
+            {
+                place(order_books, symbol, side, order, price, size, now);
+            }
+            return;
+        }
+        if (!wanted)
+        {
+            cancel(order_books, symbol, side, order, now);
+            return;
+        }
+
+        Price price_diff = order.price > price ? order.price - price : price - order.price;
+        Quantity remaining = order.remaining();
+        Quantity size_diff = remaining > size ? remaining - size : size - remaining;
+        if (price_diff <= config_.price_tolerance && size_diff <= config_.size_tolerance)
+        {
+            ++stats_.unchanged;
+            return;
+        }
+
+        if (config_.amend_in_place)
+        {
+            if (amend(order_books, symbol, side, order, price, size, now))
+            {
+                return;
+            }
+        }
+        else
+        {
+            cancel(order_books, symbol, side, order, now);
+        }
+        place(order_books, symbol, side, order, price, size, now);
+    }
+
+    bool QuoteManager::place(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order,
+                             Price price, Quantity size, Timestamp now)
+    {
+        if (risk_gate_ && risk_gate_->check(symbol, price, size, side, now) != RiskCheck::PASSED)
+        {
+            ++stats_.rejected;
+            return false;
+        }
+        OrderId order_id = next_order_id_++;
+        bool added = simulator_ ? simulator_->add_order(symbol, order_id, price, size, side, now)
+                                : order_books.add_order(symbol, order_id, price, size, side, now);
+        if (!added)
+        {
+            if (risk_gate_)
+            {
+                risk_gate_->on_cancel(symbol, side, size);
+            }
+            ++stats_.rejected;
+            return false;
+        }
+        order = WorkingOrder{order_id, price, size, 0};
+        ++stats_.new_orders;
+        return true;
+    }
+
+    // False if the order is no longer in the book, leaving the side empty
+    // for the caller to re-enter
+    bool QuoteManager::amend(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order,
+                             Price price, Quantity size, Timestamp now)
+    {
+        if (risk_gate_)
+        {
+            // The amended order replaces the old one's pending quantity
+            risk_gate_->on_cancel(symbol, side, order.remaining());
+            if (risk_gate_->check(symbol, price, size, side, now) != RiskCheck::PASSED)
+            {
+                ++stats_.rejected;
+                send_cancel(order_books, symbol, order.order_id, now);
+                ++stats_.cancels;
+                order = WorkingOrder{};
+                return true;
+            }
+        }
+
+        // The book keeps the filled part in the order's quantity
+        Quantity quantity = order.filled + size;
+        bool modified = simulator_ ? simulator_->modify_order(symbol, order.order_id, price, quantity, now)
+                                   : order_books.modify_order(symbol, order.order_id, price, quantity, now);
+        if (!modified)
+        {
+            if (risk_gate_)
+            {
+                risk_gate_->on_cancel(symbol, side, size);
+            }
+            order = WorkingOrder{};
+            return false;
+        }
+        order.price = price;
+        order.quantity = quantity;
+        ++stats_.amends;
+        return true;
+    }
+
+    void QuoteManager::cancel(OrderBookManager &order_books, SymbolId symbol, OrderSide side, WorkingOrder &order, Timestamp now)
+    {
+        send_cancel(order_books, symbol, order.order_id, now);
+        if (risk_gate_)
+        {
+            risk_gate_->on_cancel(symbol, side, order.remaining());
+        }
+        order = WorkingOrder{};
+        ++stats_.cancels;
+    }
+
+    void QuoteManager::send_cancel(OrderBookManager &order_books, SymbolId symbol, OrderId order_id, Timestamp now)
+    {
+        if (simulator_)
+        {
+            simulator_->cancel_order(symbol, order_id, now);
+        }
+        else
+        {
+            order_books.cancel_order(symbol, order_id, now);
+        }
+    }
+
+    void QuoteManager::on_fill(SymbolId symbol, OrderSide side, Quantity quantity)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+        if (risk_gate_)
+        {
+            risk_gate_->on_fill(symbol, side, quantity);
+        }
+        WorkingOrder &order = side == OrderSide::BUY ? quotes_[symbol].bid : quotes_[symbol].ask;
+        if (!order.order_id)
+        {
+            return;
+        }
+        order.filled += std::min(quantity, order.remaining());
+        if (order.remaining() == 0)
+        {
+            order = WorkingOrder{};
+        }
+    }
+
+    void QuoteManager::cancel_all(OrderBookManager &order_books, Timestamp now)
+    {
+        for (size_t symbol = 0; symbol < MAX_SYMBOLS; ++symbol)
+        {
+            SymbolQuotes &quotes = quotes_[symbol];
+            if (quotes.bid.order_id)
+            {
+                cancel(order_books, static_cast<SymbolId>(symbol), OrderSide::BUY, quotes.bid, now);
+            }
+            if (quotes.ask.order_id)
+            {
+                cancel(order_books, static_cast<SymbolId>(symbol), OrderSide::SELL, quotes.ask, now);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,189 @@
+#include "replay_driver.hpp"
+#include "clock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace mm
+{
+
+    namespace
+    {
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<size_t> tasks; // Day indices, largest file first
+        };
+    }
+
+    MultiDayReplayDriver::MultiDayReplayDriver(const Config &config)
+        : config_(config)
+    {
+    }
+
+    ReplayReport MultiDayReplayDriver::run(const std::vector<std::string> &day_files)
+    {
+        ReplayReport report{};
+        report.days.resize(day_files.size());
+        if (day_files.empty())
+        {
+            return report;
+        }
+
+        std::vector<uintmax_t> sizes(day_files.size(), 0);
+        for (size_t i = 0; i < day_files.size(); ++i)
+        {
+            std::error_code ec;
+            uintmax_t size = std::filesystem::file_size(day_files[i], ec);
+            sizes[i] = ec ? 0 : size;
+        }
+
+        // Longest-processing-time-first: deal days out round-robin in size order
+        std::vector<size_t> order(day_files.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return sizes[a] > sizes[b]; });
+
+        size_t num_threads = config_.num_threads ? config_.num_threads : std::max(1u, std::thread::hardware_concurrency());
+        num_threads = std::min(num_threads, day_files.size());
+
+        std::vector<WorkQueue> queues(num_threads);
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            queues[i % num_threads].tasks.push_back(order[i]);
+        }
+
+        // Owners take their own largest day; an idle worker steals the largest
+        // day still queued anywhere, which keeps the schedule close to LPT
+        auto next_task = [&](size_t self, size_t &task) -> bool
+        {
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].tasks.empty())
+                {
+                    task = queues[self].tasks.front();
+                    queues[self].tasks.pop_front();
+                    return true;
+                }
+            }
+
+            while (true)
+            {
+                size_t victim = num_threads;
+                uintmax_t victim_size = 0;
+                for (size_t q = 0; q < num_threads; ++q)
+                {
+                    std::lock_guard<std::mutex> lock(queues[q].mutex);
+                    if (!queues[q].tasks.empty() && (victim == num_threads || sizes[queues[q].tasks.front()] > victim_size))
+                    {
+                        victim = q;
+                        victim_size = sizes[queues[q].tasks.front()];
+                    }
+                }
+                if (victim == num_threads)
+                {
+                    return false;
+                }
+
+                std::lock_guard<std::mutex> lock(queues[victim].mutex);
+                if (!queues[victim].tasks.empty())
+                {
+                    task = queues[victim].tasks.front();
+                    queues[victim].tasks.pop_front();
+                    return true;
+                }
+            }
+        };
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        auto worker = [&](size_t self)
+        {
+            size_t task;
+            while (next_task(self, task))
+            {
+                report.days[task] = replay_day(day_files[task]);
+                report.days[task].worker = self;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (size_t t = 1; t < num_threads; ++t)
+        {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        report.makespan_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+        for (const auto &day : report.days)
+        {
+            const auto &s = day.parser_stats;
+            report.totals.total_messages += s.total_messages;
+            report.totals.add_orders += s.add_orders;
+            report.totals.executions += s.executions;
+            report.totals.cancels += s.cancels;
+            report.totals.deletes += s.deletes;
+            report.totals.replaces += s.replaces;
+            report.totals.trades += s.trades;
+            report.totals.errors += s.errors;
+            report.totals.processing_time_ms += s.processing_time_ms;
+            report.total_realized_pnl += day.position_stats.total_realized_pnl;
+            report.total_unrealized_pnl += day.position_stats.total_unrealized_pnl;
+            report.failed_days += !day.success;
+            report.peak_memory_usage_bytes = std::max(report.peak_memory_usage_bytes, day.memory_usage_bytes);
+        }
+
+        return report;
+    }
+
+    DayReplayResult MultiDayReplayDriver::replay_day(const std::string &filename) const
+    {
+        DayReplayResult result{};
+        result.filename = filename;
+
+        std::error_code ec;
+        result.file_size = std::filesystem::file_size(filename, ec);
+        if (ec)
+        {
+            result.success = false;
+            result.error_message = "Failed to stat day file: " + ec.message();
+            return result;
+        }
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        OrderBookManager order_books(config_.orders_per_book, config_.levels_per_book);
+        PositionTracker position_tracker(config_.limits);
+        EngineClock clock(ClockMode::REPLAY);
+        ITCHParser parser(order_books, position_tracker, clock);
+        parser.set_memory_cap(config_.memory_cap_bytes);
+
+        result.success = parser.parse_file(filename);
+        if (!result.success)
+        {
+            result.error_message = parser.memory_cap_exceeded() ? "Memory cap exceeded" : "Failed to parse day file";
+        }
+
+        result.parser_stats = parser.get_stats();
+        result.position_stats = position_tracker.get_stats();
+        result.active_symbols = order_books.order_book_count();
+        result.memory_usage_bytes = order_books.memory_usage();
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        result.wall_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+        return result;
+    }
+
+}
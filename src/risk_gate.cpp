@@ -0,0 +1,83 @@
+#include "risk_gate.hpp"
+#include <algorithm>
+
+namespace mm
+{
+
+    PreTradeRiskGate::PreTradeRiskGate(const RiskGateLimits &limits)
+        : limits_(limits), stats_{0, 0}, states_(std::make_unique<SymbolRiskState[]>(MAX_SYMBOLS))
+    {
+    }
+
+    void PreTradeRiskGate::on_fill(SymbolId symbol, OrderSide side, Quantity quantity)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+
+        SymbolRiskState &s = states_[symbol];
+        if (side == OrderSide::BUY)
+        {
+            s.position += quantity;
+            s.pending_buy = std::max<int64_t>(0, s.pending_buy - quantity);
+        }
+        else
+        {
+            s.position -= quantity;
+            s.pending_sell = std::max<int64_t>(0, s.pending_sell - quantity);
+        }
+    }
+
+    void PreTradeRiskGate::on_cancel(SymbolId symbol, OrderSide side, Quantity quantity)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+
+        // Quantity may include a part that already filled; never go negative
+        int64_t &pending = side == OrderSide::BUY ? states_[symbol].pending_buy : states_[symbol].pending_sell;
+        pending = std::max<int64_t>(0, pending - quantity);
+    }
+
+    void PreTradeRiskGate::update_bbo(SymbolId symbol, Price best_bid, Price best_ask)
+    {
+        if (symbol < MAX_SYMBOLS)
+        {
+            states_[symbol].best_bid = best_bid;
+            states_[symbol].best_ask = best_ask;
+        }
+    }
+
+    void PreTradeRiskGate::set_position(SymbolId symbol, int64_t net_position)
+    {
+        if (symbol < MAX_SYMBOLS)
+        {
+            states_[symbol].position = net_position;
+        }
+    }
+
+    const char *PreTradeRiskGate::to_string(RiskCheck result)
+    {
+        switch (result)
+        {
+        case RiskCheck::PASSED:
+            return "PASSED";
+        case RiskCheck::POSITION_LIMIT:
+            return "POSITION_LIMIT";
+        case RiskCheck::PENDING_LIMIT:
+            return "PENDING_LIMIT";
+        case RiskCheck::NOTIONAL_LIMIT:
+            return "NOTIONAL_LIMIT";
+        case RiskCheck::PRICE_BAND:
+            return "PRICE_BAND";
+        case RiskCheck::ORDER_RATE:
+            return "ORDER_RATE";
+        case RiskCheck::INVALID_SYMBOL:
+            return "INVALID_SYMBOL";
+        }
+        return "UNKNOWN";
+    }
+
+}
@@ -10,7 +10,7 @@ namespace mm
 {
 
     ScenarioRunner::ScenarioRunner(OrderBookManager &order_books, PositionTracker &position_tracker)
-        : order_books_(order_books), position_tracker_(position_tracker), matching_enabled_(false)
+        : order_books_(order_books), position_tracker_(position_tracker), matching_enabled_(false), clock_(ClockMode::REPLAY)
     {
     }
 
@@ -25,6 +25,8 @@ namespace mm
 
         auto start_time = std::chrono::high_resolution_clock::now();
 
+        clock_.reset();
+
         try
         {
             auto commands = parse_scenario_file(filename);
@@ -36,6 +38,8 @@ namespace mm
                     continue;
                 }
 
+                clock_.advance(command.line_number);
+
                 if (!execute_command(command))
                 {
                     result.passed = false;
@@ -370,7 +374,7 @@ namespace mm
         Price price = parse_number<Price>(args[2]);
         Quantity quantity = parse_number<Quantity>(args[3]);
 
-        return order_books_.add_order(symbol_id, order_id, price, quantity, OrderSide::BUY);
+        return order_books_.add_order(symbol_id, order_id, price, quantity, OrderSide::BUY, clock_.now());
     }
 
     bool ScenarioRunner::execute_add_limit_sell(const std::vector<std::string> &args)
@@ -383,7 +387,7 @@ namespace mm
         Price price = parse_number<Price>(args[2]);
         Quantity quantity = parse_number<Quantity>(args[3]);
 
-        return order_books_.add_order(symbol_id, order_id, price, quantity, OrderSide::SELL);
+        return order_books_.add_order(symbol_id, order_id, price, quantity, OrderSide::SELL, clock_.now());
     }
 
     bool ScenarioRunner::execute_add_market_buy(const std::vector<std::string> &args)
@@ -405,8 +409,8 @@ namespace mm
                 auto [ask_price, ask_qty] = order_book->get_best_ask();
                 if (ask_price > 0)
                 {
-                    order_books_.execute_trade(symbol_id, ask_price, quantity, OrderSide::BUY);
-                    position_tracker_.record_trade(symbol_id, ask_price, quantity, OrderSide::BUY, order_id);
+                    order_books_.execute_trade(symbol_id, ask_price, quantity, OrderSide::BUY, clock_.now());
+                    position_tracker_.record_trade(symbol_id, ask_price, quantity, OrderSide::BUY, order_id, clock_.now());
                 }
             }
         }
@@ -433,8 +437,8 @@ namespace mm
                 auto [bid_price, bid_qty] = order_book->get_best_bid();
                 if (bid_price > 0)
                 {
-                    order_books_.execute_trade(symbol_id, bid_price, quantity, OrderSide::SELL);
-                    position_tracker_.record_trade(symbol_id, bid_price, quantity, OrderSide::SELL, order_id);
+                    order_books_.execute_trade(symbol_id, bid_price, quantity, OrderSide::SELL, clock_.now());
+                    position_tracker_.record_trade(symbol_id, bid_price, quantity, OrderSide::SELL, order_id, clock_.now());
                 }
             }
         }
@@ -516,8 +520,8 @@ namespace mm
                 if (bid_price > 0)
                 {
                     Price execution_price = bid_price + slippage;
-                    order_books_.execute_trade(symbol_id, execution_price, quantity, OrderSide::BUY);
-                    position_tracker_.record_trade(symbol_id, execution_price, quantity, OrderSide::BUY, order_id);
+                    order_books_.execute_trade(symbol_id, execution_price, quantity, OrderSide::BUY, clock_.now());
+                    position_tracker_.record_trade(symbol_id, execution_price, quantity, OrderSide::BUY, order_id, clock_.now());
                 }
             }
         }
@@ -545,8 +549,8 @@ namespace mm
                 if (ask_price > 0)
                 {
                     Price execution_price = ask_price - slippage;
-                    order_books_.execute_trade(symbol_id, execution_price, quantity, OrderSide::SELL);
-                    position_tracker_.record_trade(symbol_id, execution_price, quantity, OrderSide::SELL, order_id);
+                    order_books_.execute_trade(symbol_id, execution_price, quantity, OrderSide::SELL, clock_.now());
+                    position_tracker_.record_trade(symbol_id, execution_price, quantity, OrderSide::SELL, order_id, clock_.now());
                 }
             }
         }
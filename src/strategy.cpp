@@ -1,51 +1,81 @@
 #include "strategy.hpp"
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 namespace mm
 {
 
-    FixedSpreadStrategy::FixedSpreadStrategy(const Config &cfg)
-        : config_(cfg)
+    namespace
     {
-        for (size_t i = 0; i < MAX_STRATEGY_SYMBOLS; ++i)
+        // Separate order id ranges, so both strategies can quote into one book
+        constexpr OrderId FIXED_SPREAD_FIRST_ORDER_ID = OrderId(1) << 40;
+        constexpr OrderId INVENTORY_SKEWED_FIRST_ORDER_ID = OrderId(2) << 40;
+        constexpr OrderId ADAPTIVE_SPREAD_FIRST_ORDER_ID = OrderId(3) << 40;
+        constexpr OrderId MEAN_REVERSION_FIRST_ORDER_ID = OrderId(4) << 40;
+        constexpr OrderId MOMENTUM_FIRST_ORDER_ID = OrderId(5) << 40;
+
+        // Mid of a two-sided book, 0 otherwise
+        inline Price book_mid(const BestBidOffer &bbo)
+        {
+            return bbo.bid > 0 && bbo.ask > 0 ? (bbo.bid + bbo.ask) / 2 : 0;
+        }
+
+        // Quotes spread wide around fair_value, leaving out a side that would
+        // cross the book rather than take liquidity
+        inline QuoteTarget passive_quote(Price fair_value, Price spread, Quantity size, const BestBidOffer &bbo)
         {
-            state_[i] = SymbolState{0, 0, 0, 0, 0};
+            Price bid = fair_value - spread / 2;
+            Price ask = fair_value + spread / 2;
+            bool bid_crosses = bbo.ask > 0 && bid >= bbo.ask;
+            bool ask_crosses = bbo.bid > 0 && ask <= bbo.bid;
+            return QuoteTarget{bid, bid_crosses ? 0 : size, ask, ask_crosses ? 0 : size};
         }
     }
 
-    void FixedSpreadStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &, Timestamp)
+    void validate_strategy_symbols(const std::vector<SymbolId> &symbols)
     {
-        for (size_t i = 0; i < config_.num_symbols; ++i)
+        for (SymbolId symbol : symbols)
         {
-            SymbolId symbol = config_.symbols[i];
-            auto &s = state_[i];
-            Price mid = config_.base_price;
-            Price bid = mid - config_.spread / 2;
-            Price ask = mid + config_.spread / 2;
-            Quantity qty = config_.quote_size;
-
-            if (s.bid_order_id)
-            {
-                order_books.cancel_order(symbol, s.bid_order_id);
-            }
-            if (s.ask_order_id)
+            if (symbol >= MAX_SYMBOLS)
             {
-                order_books.cancel_order(symbol, s.ask_order_id);
+                throw std::invalid_argument("Strategy symbol " + std::to_string(symbol) + " is not below MAX_SYMBOLS");
             }
+        }
+    }
 
-            s.bid_order_id = 10000 + i * 2 + 1;
-            s.ask_order_id = 10000 + i * 2 + 2;
-            order_books.add_order(symbol, s.bid_order_id, bid, qty, OrderSide::BUY);
-            order_books.add_order(symbol, s.ask_order_id, ask, qty, OrderSide::SELL);
-            s.last_bid = bid;
-            s.last_ask = ask;
-            s.last_qty = qty;
+    FixedSpreadStrategy::FixedSpreadStrategy(const Config &cfg)
+        : MarketMakingStrategy(FIXED_SPREAD_FIRST_ORDER_ID, cfg.quoting), config_(cfg)
+    {
+    }
+
+    void FixedSpreadStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &, Timestamp now)
+    {
+        for (size_t i = 0; i < config_.symbols.size(); ++i)
+        {
+            quote(order_books, i, now);
         }
     }
 
-    void FixedSpreadStrategy::on_trade(SymbolId, Price, Quantity, OrderSide, Timestamp)
+    void FixedSpreadStrategy::on_book_update(SymbolId, size_t slot, const BestBidOffer &, OrderBookManager &order_books,
+                                             PositionTracker &, Timestamp now)
+    {
+        quote(order_books, slot, now);
+    }
+
+    void FixedSpreadStrategy::quote(OrderBookManager &order_books, size_t slot, Timestamp now)
+    {
+        Price mid = config_.base_price;
+        Price bid = mid - config_.spread / 2;
+        Price ask = mid + config_.spread / 2;
+        Quantity qty = config_.quote_size;
+        quotes_.update(order_books, config_.symbols[slot], QuoteTarget{bid, qty, ask, qty}, now);
+    }
+
+    void FixedSpreadStrategy::on_trade(SymbolId symbol, Price, Quantity qty, OrderSide side, Timestamp)
     {
+        on_quote_fill(symbol, side, qty);
     }
 
     void FixedSpreadStrategy::on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp)
@@ -53,54 +83,248 @@ namespace mm
     }
 
     InventorySkewedStrategy::InventorySkewedStrategy(const Config &cfg)
-        : config_(cfg)
+        : MarketMakingStrategy(INVENTORY_SKEWED_FIRST_ORDER_ID, cfg.quoting), config_(cfg),
+          params_(make_skewed_quote_params(cfg.min_spread, cfg.max_spread, cfg.max_inventory))
     {
-        for (size_t i = 0; i < MAX_STRATEGY_SYMBOLS; ++i)
+        size_t n = config_.symbols.size();
+        fair_value_.assign(n, config_.base_price);
+        inventory_.assign(n, 0);
+        bid_.assign(n, 0);
+        ask_.assign(n, 0);
+        dirty_.assign(n, 0);
+        dirty_slots_.reserve(n);
+        batch_fair_value_.resize(n);
+        batch_inventory_.resize(n);
+        batch_bid_.resize(n);
+        batch_ask_.resize(n);
+        snapshot_.resize(n);
+    }
+
+    void InventorySkewedStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp now)
+    {
+        // One consistent read of every quoted symbol's inventory per cycle
+        size_t n = config_.symbols.size();
+        positions.get_positions(config_.symbols.data(), n, snapshot_.data());
+        for (size_t i = 0; i < n; ++i)
         {
-            state_[i] = SymbolState{0, 0, 0, 0, 0, 0};
+            inventory_[i] = snapshot_[i].get_net_position();
         }
+
+        skewed_quote_kernel(fair_value_.data(), inventory_.data(), n, params_, bid_.data(), ask_.data());
+        Quantity qty = config_.quote_size;
+        for (size_t i = 0; i < n; ++i)
+        {
+            quotes_.update(order_books, config_.symbols[i], QuoteTarget{bid_[i], qty, ask_[i], qty}, now);
+        }
+    }
+
+    void InventorySkewedStrategy::on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &, OrderBookManager &,
+                                                 PositionTracker &positions, Timestamp)
+    {
+        Position position;
+        positions.get_position(symbol, position);
+        inventory_[slot] = position.get_net_position();
+        if (!dirty_[slot])
+        {
+            dirty_[slot] = 1;
+            dirty_slots_.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    void InventorySkewedStrategy::on_dispatch_end(OrderBookManager &order_books, PositionTracker &, Timestamp now)
+    {
+        size_t count = dirty_slots_.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t slot = dirty_slots_[i];
+            batch_fair_value_[i] = fair_value_[slot];
+            batch_inventory_[i] = inventory_[slot];
+        }
+
+        skewed_quote_kernel(batch_fair_value_.data(), batch_inventory_.data(), count, params_,
+                            batch_bid_.data(), batch_ask_.data());
+
+        Quantity qty = config_.quote_size;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t slot = dirty_slots_[i];
+            bid_[slot] = batch_bid_[i];
+            ask_[slot] = batch_ask_[i];
+            dirty_[slot] = 0;
+            quotes_.update(order_books, config_.symbols[slot], QuoteTarget{bid_[slot], qty, ask_[slot], qty}, now);
+        }
+        dirty_slots_.clear();
+    }
+
+    void InventorySkewedStrategy::on_trade(SymbolId symbol, Price, Quantity qty, OrderSide side, Timestamp)
+    {
+        on_quote_fill(symbol, side, qty);
+    }
+
+    void InventorySkewedStrategy::on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp)
+    {
+    }
+
+    AdaptiveSpreadStrategy::AdaptiveSpreadStrategy(const Config &cfg)
+        : MarketMakingStrategy(ADAPTIVE_SPREAD_FIRST_ORDER_ID, cfg.quoting), config_(cfg)
+    {
+        if (cfg.min_spread < 0 || cfg.max_spread < cfg.min_spread || cfg.volatility_multiplier < 0)
+        {
+            throw std::invalid_argument("Adaptive spread needs 0 <= min_spread <= max_spread and a non-negative multiplier");
+        }
+        validate_strategy_symbols(cfg.symbols);
+        mid_.assign(config_.symbols.size(), 0);
+        volatility_.assign(config_.symbols.size(), EwmaStats(cfg.ewma_alpha));
+    }
+
+    Price AdaptiveSpreadStrategy::get_spread(size_t slot) const
+    {
+        double spread = double(config_.min_spread) + config_.volatility_multiplier * volatility_[slot].stddev();
+        return spread < double(config_.max_spread) ? static_cast<Price>(spread) : config_.max_spread;
     }
 
-    void InventorySkewedStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &positions, Timestamp)
+    void AdaptiveSpreadStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &, Timestamp now)
     {
-        for (size_t i = 0; i < config_.num_symbols; ++i)
+        for (size_t i = 0; i < config_.symbols.size(); ++i)
         {
-            SymbolId symbol = config_.symbols[i];
-            auto &s = state_[i];
-            const Position *pos = positions.get_position(symbol);
-            Quantity inv = pos ? pos->get_net_position() : 0;
-            s.inventory = inv;
-            double skew = double(inv) / double(config_.max_inventory);
-            Price mid = config_.base_price - Price(skew * double(config_.max_spread) / 2);
-            Price spread = config_.min_spread + Price(std::abs(skew) * double(config_.max_spread - config_.min_spread));
-            Price bid = mid - spread / 2;
-            Price ask = mid + spread / 2;
-            Quantity qty = config_.quote_size;
+            quote(order_books, i, order_books.get_bbo(config_.symbols[i]), now);
+        }
+    }
 
-            if (s.bid_order_id)
+    void AdaptiveSpreadStrategy::on_book_update(SymbolId, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                                                PositionTracker &, Timestamp now)
+    {
+        Price mid = book_mid(bbo);
+        if (mid)
+        {
+            if (mid_[slot])
             {
-                order_books.cancel_order(symbol, s.bid_order_id);
+                volatility_[slot].update(double(mid - mid_[slot]));
             }
-            if (s.ask_order_id)
+            mid_[slot] = mid;
+        }
+        quote(order_books, slot, bbo, now);
+    }
+
+    void AdaptiveSpreadStrategy::quote(OrderBookManager &order_books, size_t slot, const BestBidOffer &bbo, Timestamp now)
+    {
+        Price fair_value = mid_[slot] ? mid_[slot] : config_.base_price;
+        quotes_.update(order_books, config_.symbols[slot], passive_quote(fair_value, get_spread(slot), config_.quote_size, bbo), now);
+    }
+
+    void AdaptiveSpreadStrategy::on_trade(SymbolId symbol, Price, Quantity qty, OrderSide side, Timestamp)
+    {
+        on_quote_fill(symbol, side, qty);
+    }
+
+    void AdaptiveSpreadStrategy::on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp)
+    {
+    }
+
+    MeanReversionStrategy::MeanReversionStrategy(const Config &cfg)
+        : MarketMakingStrategy(MEAN_REVERSION_FIRST_ORDER_ID, cfg.quoting), config_(cfg)
+    {
+        if (cfg.spread < 0 || !(cfg.reversion >= 0.0 && cfg.reversion <= 1.0))
+        {
+            throw std::invalid_argument("Mean reversion needs a non-negative spread and reversion in [0, 1]");
+        }
+        validate_strategy_symbols(cfg.symbols);
+        fair_value_.assign(config_.symbols.size(), config_.base_price);
+        mids_.assign(config_.symbols.size(), RollingWindow(cfg.window));
+    }
+
+    void MeanReversionStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &, Timestamp now)
+    {
+        for (size_t i = 0; i < config_.symbols.size(); ++i)
+        {
+            quote(order_books, i, order_books.get_bbo(config_.symbols[i]), now);
+        }
+    }
+
+    void MeanReversionStrategy::on_book_update(SymbolId, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                                               PositionTracker &, Timestamp now)
+    {
+        Price mid = book_mid(bbo);
+        if (mid)
+        {
+            RollingWindow &mids = mids_[slot];
+            mids.push(mid);
+            fair_value_[slot] = mid + static_cast<Price>(config_.reversion * (mids.mean() - double(mid)));
+        }
+        quote(order_books, slot, bbo, now);
+    }
+
+    void MeanReversionStrategy::quote(OrderBookManager &order_books, size_t slot, const BestBidOffer &bbo, Timestamp now)
+    {
+        quotes_.update(order_books, config_.symbols[slot], passive_quote(fair_value_[slot], config_.spread, config_.quote_size, bbo), now);
+    }
+
+    void MeanReversionStrategy::on_trade(SymbolId symbol, Price, Quantity qty, OrderSide side, Timestamp)
+    {
+        on_quote_fill(symbol, side, qty);
+    }
+
+    void MeanReversionStrategy::on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp)
+    {
+    }
+
+    MomentumStrategy::MomentumStrategy(const Config &cfg)
+        : MarketMakingStrategy(MOMENTUM_FIRST_ORDER_ID, cfg.quoting), config_(cfg)
+    {
+        if (cfg.spread < 0 || cfg.skew < 0)
+        {
+            throw std::invalid_argument("Momentum needs a non-negative spread and skew");
+        }
+        validate_strategy_symbols(cfg.symbols);
+        fair_value_.assign(config_.symbols.size(), config_.base_price);
+        ranges_.assign(config_.symbols.size(), RollingMinMax(cfg.window));
+    }
+
+    void MomentumStrategy::update_quotes(OrderBookManager &order_books, PositionTracker &, Timestamp now)
+    {
+        for (size_t i = 0; i < config_.symbols.size(); ++i)
+        {
+            quote(order_books, i, order_books.get_bbo(config_.symbols[i]), now);
+        }
+    }
+
+    void MomentumStrategy::on_book_update(SymbolId, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                                          PositionTracker &, Timestamp now)
+    {
+        Price mid = book_mid(bbo);
+        if (mid)
+        {
+            RollingMinMax &range = ranges_[slot];
+            range.push(mid);
+            Price fair_value = mid;
+            if (range.max() > range.min())
             {
-                order_books.cancel_order(symbol, s.ask_order_id);
+                // The window includes this mid, so a new extreme equals it
+                if (mid == range.max())
+                {
+                    fair_value += config_.skew;
+                }
+                else if (mid == range.min())
+                {
+                    fair_value -= config_.skew;
+                }
             }
-
-            s.bid_order_id = 20000 + i * 2 + 1;
-            s.ask_order_id = 20000 + i * 2 + 2;
-            order_books.add_order(symbol, s.bid_order_id, bid, qty, OrderSide::BUY);
-            order_books.add_order(symbol, s.ask_order_id, ask, qty, OrderSide::SELL);
-            s.last_bid = bid;
-            s.last_ask = ask;
-            s.last_qty = qty;
+            fair_value_[slot] = fair_value;
         }
+        quote(order_books, slot, bbo, now);
     }
 
-    void InventorySkewedStrategy::on_trade(SymbolId, Price, Quantity, OrderSide, Timestamp)
+    void MomentumStrategy::quote(OrderBookManager &order_books, size_t slot, const BestBidOffer &bbo, Timestamp now)
     {
+        quotes_.update(order_books, config_.symbols[slot], passive_quote(fair_value_[slot], config_.spread, config_.quote_size, bbo), now);
     }
 
-    void InventorySkewedStrategy::on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp)
+    void MomentumStrategy::on_trade(SymbolId symbol, Price, Quantity qty, OrderSide side, Timestamp)
+    {
+        on_quote_fill(symbol, side, qty);
+    }
+
+    void MomentumStrategy::on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp)
     {
     }
 
@@ -0,0 +1,101 @@
+#include "strategy_dispatcher.hpp"
+#include "strategy.hpp"
+#include <algorithm>
+
+namespace mm
+{
+
+    StrategyDispatcher::StrategyDispatcher()
+        : first_subscription_(std::make_unique<uint32_t[]>(MAX_SYMBOLS)),
+          dispatched_(std::make_unique<BestBidOffer[]>(MAX_SYMBOLS)),
+          dirty_(std::make_unique<uint8_t[]>(MAX_SYMBOLS)),
+          stats_{0, 0, 0, 0}
+    {
+        std::fill(first_subscription_.get(), first_subscription_.get() + MAX_SYMBOLS, NO_SUBSCRIPTION);
+        pending_.reserve(MAX_SYMBOLS);
+        changed_.reserve(MAX_SYMBOLS);
+    }
+
+    void StrategyDispatcher::add_strategy(MarketMakingStrategy *strategy)
+    {
+        if (std::find(strategies_.begin(), strategies_.end(), strategy) != strategies_.end())
+        {
+            return;
+        }
+        strategies_.push_back(strategy);
+        for (size_t slot = 0; slot < strategy->symbol_count(); ++slot)
+        {
+            SymbolId symbol = strategy->symbol_at(slot);
+            if (symbol >= MAX_SYMBOLS)
+            {
+                continue;
+            }
+            subscriptions_.push_back(Subscription{strategy, static_cast<uint32_t>(slot), first_subscription_[symbol]});
+            first_subscription_[symbol] = static_cast<uint32_t>(subscriptions_.size() - 1);
+        }
+    }
+
+    void StrategyDispatcher::on_fill(SymbolId symbol, Price price, Quantity quantity, OrderSide side, Timestamp now)
+    {
+        if (symbol >= MAX_SYMBOLS)
+        {
+            return;
+        }
+        for (uint32_t i = first_subscription_[symbol]; i != NO_SUBSCRIPTION; i = subscriptions_[i].next)
+        {
+            subscriptions_[i].strategy->on_trade(symbol, price, quantity, side, now);
+        }
+        if (dirty_[symbol] == CLEAN)
+        {
+            pending_.push_back(symbol);
+        }
+        dirty_[symbol] = FILLED;
+    }
+
+    size_t StrategyDispatcher::dispatch(OrderBookManager &order_books, PositionTracker &positions, Timestamp now)
+    {
+        size_t callbacks = 0;
+        changed_.clear();
+        for (SymbolId symbol : pending_)
+        {
+            uint8_t dirty = dirty_[symbol];
+            dirty_[symbol] = CLEAN;
+
+            BestBidOffer bbo = order_books.get_bbo(symbol);
+            if (dirty != FILLED && bbo == dispatched_[symbol])
+            {
+                continue;
+            }
+            changed_.push_back(symbol);
+
+            for (uint32_t i = first_subscription_[symbol]; i != NO_SUBSCRIPTION; i = subscriptions_[i].next)
+            {
+                subscriptions_[i].strategy->on_book_update(symbol, subscriptions_[i].slot, bbo, order_books, positions, now);
+                ++callbacks;
+            }
+        }
+
+        if (callbacks > 0)
+        {
+            for (MarketMakingStrategy *strategy : strategies_)
+            {
+                strategy->on_dispatch_end(order_books, positions, now);
+            }
+        }
+
+        // The strategies' own requotes may have moved the BBO; they have
+        // already reacted to that, so it is not a change next time
+        for (SymbolId symbol : changed_)
+        {
+            dispatched_[symbol] = order_books.get_bbo(symbol);
+        }
+
+        stats_.touched += pending_.size();
+        stats_.changed += changed_.size();
+        stats_.callbacks += callbacks;
+        ++stats_.dispatches;
+        pending_.clear();
+        return callbacks;
+    }
+
+}
@@ -0,0 +1,194 @@
+#include "trade_journal.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace mm
+{
+
+    namespace
+    {
+        // One past the highest segment file already in directory, 0 if none
+        uint64_t next_segment_file(const std::string &directory)
+        {
+            uint64_t next = 0;
+            std::error_code ec;
+            for (const auto &entry : std::filesystem::directory_iterator(directory, ec))
+            {
+                unsigned long long number;
+                char tail;
+                std::string name = entry.path().filename().string();
+                if (std::sscanf(name.c_str(), "trades-%llu.lo%c", &number, &tail) == 2 && tail == 'g')
+                {
+                    next = std::max<uint64_t>(next, number + 1);
+                }
+            }
+            return next;
+        }
+    }
+
+    TradeJournal::TradeJournal(const Config &config)
+        : directory_(config.directory),
+          first_file_(config.directory.empty() ? 0 : next_segment_file(config.directory)),
+          records_per_segment_(std::max<size_t>(config.records_per_segment, 1)),
+          num_segments_(std::max<size_t>(config.segments, 2)),
+          segments_(std::make_unique<Segment[]>(num_segments_)),
+          next_index_(0), current_(nullptr), committed_(0), floor_(0),
+          wanted_segment_(1), stop_(false)
+    {
+        prepare(0);
+        current_ = segments_[0].records;
+        preparer_ = std::thread(&TradeJournal::preparer_loop, this);
+    }
+
+    TradeJournal::~TradeJournal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(prepare_mutex_);
+            stop_ = true;
+        }
+        prepare_cv_.notify_one();
+        preparer_.join();
+
+        size_t bytes = records_per_segment_ * sizeof(Trade);
+        for (size_t i = 0; i < num_segments_; ++i)
+        {
+            if (segments_[i].records != nullptr)
+            {
+                munmap(segments_[i].records, bytes);
+            }
+        }
+    }
+
+    uint64_t TradeJournal::append(const Trade &trade)
+    {
+        std::lock_guard<SpinLock> lock(append_lock_);
+
+        uint64_t index = next_index_++;
+        size_t offset = index % records_per_segment_;
+        if (offset == 0 && index != 0)
+        {
+            rotate(index / records_per_segment_);
+        }
+
+        current_[offset] = trade;
+        current_[offset].sequence = index;
+        committed_.store(index + 1, std::memory_order_release);
+        return index;
+    }
+
+    uint64_t TradeJournal::first_available() const
+    {
+        // The writer's segment and the ones before it, minus the slot the
+        // background thread may be recycling for the next segment
+        uint64_t current = size() / records_per_segment_;
+        uint64_t oldest = current + 2 > num_segments_ ? current + 2 - num_segments_ : 0;
+        return std::max(floor_.load(std::memory_order_acquire), oldest * records_per_segment_);
+    }
+
+    void TradeJournal::rotate(uint64_t number)
+    {
+        Segment &segment = segments_[number % num_segments_];
+        if (segment.number.load(std::memory_order_acquire) != number)
+        {
+            prepare(number); // Background thread fell behind
+        }
+        current_ = segment.records;
+
+        {
+            std::lock_guard<std::mutex> lock(prepare_mutex_);
+            wanted_segment_ = number + 1;
+        }
+        prepare_cv_.notify_one();
+    }
+
+    void TradeJournal::prepare(uint64_t number)
+    {
+        std::unique_lock<std::shared_mutex> lock(segments_mutex_);
+
+        Segment &segment = segments_[number % num_segments_];
+        if (segment.number.load(std::memory_order_relaxed) == number)
+        {
+            return;
+        }
+
+        size_t bytes = records_per_segment_ * sizeof(Trade);
+        segment.number.store(~0ull, std::memory_order_release);
+        if (segment.records != nullptr)
+        {
+            munmap(segment.records, bytes);
+            segment.records = nullptr;
+        }
+
+        void *ptr;
+        if (directory_.empty())
+        {
+            ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+            if (ptr == MAP_FAILED)
+            {
+                throw std::runtime_error("Failed to map trade journal segment");
+            }
+        }
+        else
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/trades-%010llu.log", static_cast<unsigned long long>(first_file_ + number));
+            std::string path = directory_ + name;
+
+            int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+            if (fd == -1)
+            {
+                throw std::runtime_error("Failed to open trade journal segment: " + path);
+            }
+            if (ftruncate(fd, bytes) == -1)
+            {
+                close(fd);
+                throw std::runtime_error("Failed to size trade journal segment: " + path);
+            }
+            ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (ptr == MAP_FAILED)
+            {
+                throw std::runtime_error("Failed to map trade journal segment: " + path);
+            }
+            // Take the write faults here rather than on the append path
+            std::memset(ptr, 0, bytes);
+        }
+
+        segment.records = static_cast<Trade *>(ptr);
+        segment.number.store(number, std::memory_order_release);
+    }
+
+    void TradeJournal::preparer_loop()
+    {
+        uint64_t prepared = 0;
+        std::unique_lock<std::mutex> lock(prepare_mutex_);
+        while (true)
+        {
+            prepare_cv_.wait(lock, [&]()
+                             { return stop_ || wanted_segment_ != prepared; });
+            if (stop_)
+            {
+                return;
+            }
+
+            uint64_t number = wanted_segment_;
+            lock.unlock();
+            try
+            {
+                prepare(number);
+            }
+            catch (const std::exception &)
+            {
+                // Leave it to rotate(), which retries and reports the error
+            }
+            lock.lock();
+            prepared = number;
+        }
+    }
+
+}
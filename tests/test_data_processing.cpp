@@ -1,8 +1,19 @@
 #include "itch_parser.hpp"
 #include "scenario_runner.hpp"
+#include "replay_driver.hpp"
 #include "order_book.hpp"
 #include "position_tracker.hpp"
+#include "clock.hpp"
+#include "strategy.hpp"
+#include "strategy_dispatcher.hpp"
+#include "quote_kernel.hpp"
+#include "policy_strategy.hpp"
+#include "parameter_sweep.hpp"
+#include "rolling_stats.hpp"
 #include "types.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <iostream>
 #include <chrono>
 #include <filesystem>
@@ -21,8 +32,9 @@ void test_itch_parser_small_sample()
     limits.max_long_position = 50000;
     limits.max_short_position = 50000;
     PositionTracker position_tracker(limits);
+    EngineClock clock(ClockMode::REPLAY);
 
-    ITCHParser parser(order_books, position_tracker);
+    ITCHParser parser(order_books, position_tracker, clock);
 
     std::string itch_file = "data/sample.itch";
     if (!std::filesystem::exists(itch_file))
@@ -56,7 +68,7 @@ void test_itch_parser_small_sample()
         if (offset + 2 > bytes_read)
             break;
 
-        uint16_t message_length = (buffer[offset] << 8) | buffer[offset + 1];
+        size_t message_length = 2 + ((buffer[offset] << 8) | buffer[offset + 1]);
         if (offset + message_length > bytes_read)
             break;
 
@@ -67,6 +79,7 @@ void test_itch_parser_small_sample()
 
         offset += message_length;
     }
+    parser.flush();
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
@@ -83,6 +96,7 @@ void test_itch_parser_small_sample()
     std::cout << "  Replaces: " << stats.replaces << std::endl;
     std::cout << "  Trades: " << stats.trades << std::endl;
     std::cout << "  Errors: " << stats.errors << std::endl;
+    std::cout << "  Feed Time: " << clock.now() << " ns since midnight" << std::endl;
     std::cout << "  Processing Time: " << duration.count() << " microseconds" << std::endl;
     std::cout << "  Throughput: " << (messages_processed * 1000000.0 / duration.count()) << " messages/second" << std::endl;
 
@@ -110,6 +124,46 @@ void test_itch_parser_small_sample()
     }
 }
 
+void test_multi_day_replay_driver()
+{
+    std::cout << "\n=== Testing Multi-Day Replay Driver ===" << std::endl;
+
+    std::string itch_file = "data/sample.itch";
+    if (!std::filesystem::exists(itch_file))
+    {
+        std::cout << "ITCH file not found, skipping test." << std::endl;
+        return;
+    }
+
+    // The same day twice on two workers must give identical, deterministic results
+    MultiDayReplayDriver::Config config;
+    config.num_threads = 2;
+    MultiDayReplayDriver driver(config);
+    ReplayReport report = driver.run({itch_file, itch_file, "data/missing.itch"});
+
+    assert(report.days.size() == 3);
+    assert(report.days[0].success && report.days[1].success);
+    assert(!report.days[2].success);
+    assert(report.failed_days == 1);
+    assert(report.days[0].parser_stats.total_messages == report.days[1].parser_stats.total_messages);
+    assert(report.days[0].position_stats.total_realized_pnl == report.days[1].position_stats.total_realized_pnl);
+    assert(report.totals.total_messages == 2 * report.days[0].parser_stats.total_messages);
+
+    std::cout << "  Days: " << report.days.size() << " (" << report.failed_days << " failed)" << std::endl;
+    std::cout << "  Total Messages: " << report.totals.total_messages << std::endl;
+    std::cout << "  Makespan: " << report.makespan_ms << " ms" << std::endl;
+
+    MultiDayReplayDriver::Config capped;
+    capped.memory_cap_bytes = 1024 * 1024;
+    MultiDayReplayDriver capped_driver(capped);
+    ReplayReport capped_report = capped_driver.run({itch_file});
+
+    assert(!capped_report.days[0].success);
+    assert(capped_report.days[0].error_message == "Memory cap exceeded");
+    std::cout << "  Capped Day: " << capped_report.days[0].error_message << " after "
+              << capped_report.days[0].parser_stats.total_messages << " messages" << std::endl;
+}
+
 void test_scenario_runner_individual()
 {
     std::cout << "\n=== Testing Individual Scenarios ===" << std::endl;
@@ -263,6 +317,7 @@ void test_memory_efficiency()
     limits.max_long_position = 500000;
     limits.max_short_position = 500000;
     PositionTracker position_tracker(limits);
+    EngineClock clock(ClockMode::LIVE);
 
     const int num_orders = 100000;
     std::random_device rd;
@@ -281,11 +336,11 @@ void test_memory_efficiency()
         Quantity qty = qty_dist(gen);
         OrderSide side = (i % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
 
-        order_book.add_order(order_id, price, qty, side);
+        order_book.add_order(order_id, price, qty, side, clock.now());
 
         if (i % 1000 == 0)
         {
-            position_tracker.record_trade(1, price, qty, side, order_id);
+            position_tracker.record_trade(1, price, qty, side, order_id, clock.now());
         }
     }
 
@@ -310,6 +365,657 @@ void test_memory_efficiency()
     std::cout << "    Total P&L: " << price_to_dollars(position_stats.total_pnl) << std::endl;
 }
 
+namespace
+{
+    // Records callbacks; quotes one tick inside the BBO it was given
+    class RecordingStrategy : public MarketMakingStrategy
+    {
+    public:
+        RecordingStrategy(OrderId first_order_id, std::vector<SymbolId> symbols)
+            : MarketMakingStrategy(first_order_id, QuoteManagerConfig()), symbols_(std::move(symbols)) {}
+
+        void update_quotes(OrderBookManager &, PositionTracker &, Timestamp) override {}
+        void on_trade(SymbolId symbol, Price, Quantity, OrderSide, Timestamp) override { trades.push_back(symbol); }
+        void on_position_update(SymbolId, const Position &, const PositionTracker::Stats &, Timestamp) override {}
+        void on_book_update(SymbolId symbol, size_t slot, const BestBidOffer &bbo, OrderBookManager &order_books,
+                            PositionTracker &, Timestamp now) override
+        {
+            assert(symbols_[slot] == symbol);
+            updates.push_back(symbol);
+            last_bbo = bbo;
+            if (requote && bbo.bid > 0 && bbo.ask > bbo.bid + 2)
+            {
+                quotes_.update(order_books, symbol, QuoteTarget{bbo.bid + 1, 10, bbo.ask - 1, 10}, now);
+            }
+        }
+        size_t symbol_count() const override { return symbols_.size(); }
+        SymbolId symbol_at(size_t slot) const override { return symbols_[slot]; }
+
+        std::vector<SymbolId> updates;
+        std::vector<SymbolId> trades;
+        BestBidOffer last_bbo{0, 0};
+        bool requote = false;
+
+    private:
+        std::vector<SymbolId> symbols_;
+    };
+
+    BookUpdate feed_add(SymbolId symbol, OrderId order_id, OrderSide side, Price price)
+    {
+        BookUpdate add{};
+        add.type = BookUpdateType::ADD;
+        add.side = side;
+        add.symbol = symbol;
+        add.quantity = 100;
+        add.order_id = order_id;
+        add.price = price;
+        return add;
+    }
+}
+
+void test_strategy_dispatcher()
+{
+    std::cout << "Testing strategy dispatcher..." << std::endl;
+
+    OrderBookManager books(1000, 100);
+    PositionTracker positions;
+    RecordingStrategy first(OrderId(1) << 40, {3, 5});
+    RecordingStrategy second(OrderId(2) << 40, {5});
+    StrategyDispatcher dispatcher;
+    dispatcher.add_strategy(&first);
+    dispatcher.add_strategy(&second);
+
+    // A packet that sets symbol 3's BBO reaches only its subscriber, once
+    std::vector<BookUpdate> packet = {feed_add(3, 1, OrderSide::BUY, 9900), feed_add(3, 2, OrderSide::SELL, 10100),
+                                      feed_add(3, 3, OrderSide::BUY, 9800), feed_add(9, 4, OrderSide::BUY, 9900)};
+    books.apply(packet.data(), packet.size());
+    dispatcher.touch(packet.data(), packet.size());
+    size_t dispatched = dispatcher.dispatch(books, positions, 1);
+    assert(dispatched == 1);
+    assert(first.updates == std::vector<SymbolId>{3});
+    assert(first.last_bbo == (BestBidOffer{9900, 10100}));
+    assert(second.updates.empty());
+
+    // Depth below the top does not dispatch; symbols nobody quotes are not even examined
+    packet = {feed_add(3, 5, OrderSide::BUY, 9700), feed_add(9, 6, OrderSide::BUY, 9950)};
+    books.apply(packet.data(), packet.size());
+    dispatcher.touch(packet.data(), packet.size());
+    dispatched = dispatcher.dispatch(books, positions, 2);
+    assert(dispatched == 0);
+    assert(dispatcher.get_stats().touched == 2);
+
+    // A fill dispatches its symbol to every subscriber even with an unchanged BBO
+    dispatcher.on_fill(5, 10000, 10, OrderSide::BUY, 3);
+    dispatcher.touch(5);
+    assert(first.trades == std::vector<SymbolId>{5} && second.trades == std::vector<SymbolId>{5});
+    dispatched = dispatcher.dispatch(books, positions, 3);
+    assert(dispatched == 2);
+    assert(second.updates == std::vector<SymbolId>{5});
+
+    // A strategy's own requote moves the BBO but does not dispatch again
+    first.requote = true;
+    packet = {feed_add(3, 7, OrderSide::BUY, 9910)};
+    books.apply(packet.data(), packet.size());
+    dispatcher.touch(packet.data(), packet.size());
+    dispatched = dispatcher.dispatch(books, positions, 4);
+    assert(dispatched == 1);
+    assert(books.get_bbo(3) == (BestBidOffer{9911, 10099}));
+    assert(books.get_bbo(static_cast<SymbolId>(MAX_SYMBOLS)) == (BestBidOffer{0, 0}));
+    dispatcher.touch(3);
+    dispatched = dispatcher.dispatch(books, positions, 5);
+    assert(dispatched == 0);
+    (void)dispatched;
+    assert(first.updates.size() == 3);
+
+    std::cout << "Strategy dispatcher test passed!" << std::endl;
+}
+
+void test_inventory_skewed_quotes()
+{
+    std::cout << "\nTesting inventory-skewed quote kernel..." << std::endl;
+
+    const Price base_price = price_from_dollars(100.00);
+    const Price min_spread = price_from_dollars(0.05);
+    const Price max_spread = price_from_dollars(0.20);
+    constexpr Quantity max_inventory = 1000;
+    SkewedQuoteParams params = make_skewed_quote_params(min_spread, max_spread, max_inventory);
+
+    // Kernel lanes and tail agree with the model to within rounding
+    std::mt19937 gen(5);
+    constexpr size_t count = 1003;
+    std::vector<Price> fair(count), bids(count), asks(count);
+    std::vector<int64_t> inventory(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        fair[i] = base_price + static_cast<Price>(gen() % 1000);
+        inventory[i] = static_cast<int64_t>(gen() % 4001) - 2000;
+    }
+    inventory[0] = int64_t(1) << 40; // Clamped
+    inventory[1] = -(int64_t(1) << 40);
+    skewed_quote_kernel(fair.data(), inventory.data(), count, params, bids.data(), asks.data());
+    for (size_t i = 0; i < count; ++i)
+    {
+        int64_t inv = std::clamp(inventory[i], -QUOTE_INVENTORY_LIMIT, QUOTE_INVENTORY_LIMIT);
+        double skew = double(inv) / max_inventory;
+        double mid = double(fair[i]) - skew * double(max_spread) / 2;
+        double half = (double(min_spread) + std::abs(skew) * double(max_spread - min_spread)) / 2;
+        assert(std::abs(double(bids[i]) - (mid - half)) <= 2.0 + std::abs(skew) * 1e-3);
+        assert(std::abs(double(asks[i]) - (mid + half)) <= 2.0 + std::abs(skew) * 1e-3);
+        assert(asks[i] - bids[i] >= min_spread - 1);
+    }
+    bool thrown = false;
+    try
+    {
+        make_skewed_quote_params(min_spread, max_spread, 0);
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // A strategy well past the old 16-symbol limit; long and short
+    // inventories skew in opposite directions
+    constexpr size_t num_symbols = 300;
+    OrderBookManager books(16, 8);
+    PositionTracker positions;
+    InventorySkewedStrategy::Config config{};
+    config.base_price = base_price;
+    config.min_spread = min_spread;
+    config.max_spread = max_spread;
+    config.quote_size = 100;
+    config.max_inventory = max_inventory;
+    for (size_t i = 0; i < num_symbols; ++i)
+    {
+        config.symbols.push_back(static_cast<SymbolId>(i + 1));
+    }
+    InventorySkewedStrategy strategy(config);
+    StrategyDispatcher dispatcher;
+    dispatcher.add_strategy(&strategy);
+
+    positions.record_trade(10, base_price, 500, OrderSide::BUY, 1, 1);
+    positions.record_trade(20, base_price, 500, OrderSide::SELL, 2, 1);
+    strategy.update_quotes(books, positions, 1);
+
+    auto expect = [&](SymbolId symbol)
+    {
+        Position position;
+        positions.get_position(symbol, position);
+        int64_t inv = position.get_net_position();
+        Price fair_value = base_price, bid, ask;
+        skewed_quote_kernel(&fair_value, &inv, 1, params, &bid, &ask);
+        return BestBidOffer{bid, ask};
+    };
+    for (SymbolId symbol = 1; symbol <= num_symbols; ++symbol)
+    {
+        assert(books.get_bbo(symbol) == expect(symbol));
+    }
+    assert(books.get_bbo(10).bid < books.get_bbo(1).bid);
+    assert(books.get_bbo(20).ask > books.get_bbo(1).ask);
+
+    // Fills re-quote through the dispatcher, all dirty symbols in one kernel pass
+    for (SymbolId symbol : {SymbolId(3), SymbolId(150), SymbolId(299)})
+    {
+        Price bid = books.get_bbo(symbol).bid;
+        books.execute_trade(symbol, bid, 50, OrderSide::SELL, 2);
+        positions.record_trade(symbol, bid, 50, OrderSide::BUY, 100 + symbol, 2);
+        dispatcher.on_fill(symbol, bid, 50, OrderSide::BUY, 2);
+    }
+    uint64_t amends = strategy.get_quote_stats().amends;
+    size_t dispatched = dispatcher.dispatch(books, positions, 3);
+    assert(dispatched == 3);
+    (void)dispatched;
+    assert(strategy.get_quote_stats().amends == amends + 6);
+    for (SymbolId symbol = 1; symbol <= num_symbols; ++symbol)
+    {
+        assert(books.get_bbo(symbol) == expect(symbol));
+    }
+
+    std::cout << "Inventory-skewed quote kernel test passed!" << std::endl;
+}
+
+void test_policy_strategy()
+{
+    std::cout << "\nTesting policy-composed strategies..." << std::endl;
+
+    const Price base_price = price_from_dollars(100.00);
+    const Price spread = price_from_dollars(0.10);
+
+    // Policies on their own
+    MidFairValue mid_fair_value(MidFairValue::Config{base_price});
+    assert(mid_fair_value.fair_value(0, BestBidOffer{0, 0}) == base_price);
+    assert(mid_fair_value.fair_value(0, BestBidOffer{base_price - 200, base_price + 400}) == base_price + 100);
+    InventoryLimitedSize limited_size(InventoryLimitedSize::Config{100, 120});
+    Quantity bid_size, ask_size;
+    limited_size.sizes(0, bid_size, ask_size);
+    assert(bid_size == 100 && ask_size == 100);
+    limited_size.sizes(50, bid_size, ask_size);
+    assert(bid_size == 70 && ask_size == 100);
+    limited_size.sizes(-200, bid_size, ask_size);
+    assert(bid_size == 100 && ask_size == 0);
+
+    // The composed skewed strategy quotes exactly as InventorySkewedStrategy
+    constexpr size_t num_symbols = 40;
+    PositionTracker positions;
+    std::vector<SymbolId> symbols;
+    for (size_t i = 0; i < num_symbols; ++i)
+    {
+        SymbolId symbol = static_cast<SymbolId>(i + 1);
+        symbols.push_back(symbol);
+        positions.record_trade(symbol, base_price, static_cast<Quantity>(i * 37 % 900 + 1),
+                               (i & 1) ? OrderSide::BUY : OrderSide::SELL, i + 1, 1);
+    }
+    InventorySkewedStrategy::Config legacy_config{};
+    legacy_config.base_price = base_price;
+    legacy_config.min_spread = price_from_dollars(0.05);
+    legacy_config.max_spread = price_from_dollars(0.20);
+    legacy_config.quote_size = 100;
+    legacy_config.max_inventory = 1000;
+    legacy_config.symbols = symbols;
+    InventorySkewedStrategy legacy(legacy_config);
+    OrderBookManager legacy_books(16, 8);
+    legacy.update_quotes(legacy_books, positions, 2);
+
+    InventorySkewedPolicyStrategy::Config policy_config{};
+    policy_config.fair_value.base_price = base_price;
+    policy_config.spread = InventorySkewSpread::Config{legacy_config.min_spread, legacy_config.max_spread, legacy_config.max_inventory};
+    policy_config.size.quote_size = legacy_config.quote_size;
+    policy_config.symbols = symbols;
+    QuoteManager policy_quotes(1);
+    InventorySkewedPolicyStrategy policy(policy_config, policy_quotes);
+    OrderBookManager policy_books(16, 8);
+    policy.update_quotes(policy_books, positions, 2);
+    for (SymbolId symbol : symbols)
+    {
+        assert(policy_books.get_bbo(symbol) == legacy_books.get_bbo(symbol));
+    }
+    assert(policy_quotes.get_stats().new_orders == legacy.get_quote_stats().new_orders);
+
+    // Behind the virtual interface the adapter is driven by the dispatcher
+    // like any other strategy
+    using MidQuoter = PolicyStrategy<MidFairValue, FixedSpread, InventoryLimitedSize>;
+    MidQuoter::Config mid_config{};
+    mid_config.fair_value.fallback_price = base_price;
+    mid_config.spread.spread = spread;
+    mid_config.size = InventoryLimitedSize::Config{100, 120};
+    mid_config.symbols = {SymbolId(500)};
+    StrategyAdapter<MidQuoter> adapter(mid_config, OrderId(1) << 40);
+    MarketMakingStrategy *strategy = &adapter;
+    PositionTracker mid_positions;
+    OrderBookManager books(16, 8);
+    books.add_order(500, 1, base_price - 1000, 300, OrderSide::BUY, 1);
+    books.add_order(500, 2, base_price + 1000, 300, OrderSide::SELL, 1);
+    StrategyDispatcher dispatcher;
+    dispatcher.add_strategy(strategy);
+    dispatcher.touch(500);
+    size_t dispatched = dispatcher.dispatch(books, mid_positions, 2);
+    assert(dispatched == 1);
+    assert(books.get_bbo(500) == (BestBidOffer{base_price - spread / 2, base_price + spread / 2}));
+
+    Price bid = books.get_bbo(500).bid;
+    books.execute_trade(500, bid, 50, OrderSide::SELL, 3);
+    mid_positions.record_trade(500, bid, 50, OrderSide::BUY, 1, 3);
+    dispatcher.on_fill(500, bid, 50, OrderSide::BUY, 3);
+    dispatched = dispatcher.dispatch(books, mid_positions, 4);
+    assert(dispatched == 1);
+    (void)dispatched;
+    assert(adapter.get_quote_stats().amends == 1);
+    assert(books.get_order_book(500)->get_best_bid() == std::make_pair(bid, Quantity(70)));
+
+    bool thrown = false;
+    mid_config.symbols = {static_cast<SymbolId>(MAX_SYMBOLS)};
+    try
+    {
+        StrategyAdapter<MidQuoter> bad(mid_config, OrderId(2) << 40);
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Policy-composed strategy test passed!" << std::endl;
+}
+
+void test_parameter_sweep()
+{
+    std::cout << "\nTesting parameter sweep..." << std::endl;
+
+    const Price bid = price_from_dollars(99.99);
+    const Price ask = price_from_dollars(100.01);
+    auto update = [](BookUpdateType type, OrderId order_id, Price price, Quantity quantity, OrderSide side, Timestamp now)
+    {
+        BookUpdate u{};
+        u.type = type;
+        u.side = side;
+        u.symbol = 3;
+        u.quantity = quantity;
+        u.order_id = order_id;
+        u.price = price;
+        u.timestamp = now;
+        return u;
+    };
+
+    // Only updates that trade or move the BBO reach the tape
+    FeedTape tape(64, 16);
+    std::vector<BookUpdate> updates = {
+        update(BookUpdateType::ADD, 1, bid, 500, OrderSide::BUY, 1),
+        update(BookUpdateType::ADD, 2, ask, 500, OrderSide::SELL, 2),
+        update(BookUpdateType::ADD, 3, bid - 100, 500, OrderSide::BUY, 3),
+        update(BookUpdateType::EXECUTE, 1, 0, 100, OrderSide::BUY, 4),
+        update(BookUpdateType::CANCEL, 1, 0, 50, OrderSide::BUY, 5),
+    };
+    tape.append(updates.data(), updates.size());
+    assert(tape.updates_applied() == 5);
+    assert(tape.size() == 3);
+    assert(tape.symbol_count() == 1 && tape.symbol_at(0) == 3);
+    assert(tape[0].bbo == (BestBidOffer{bid, 0}));
+    assert(tape[1].bbo == (BestBidOffer{bid, ask}) && tape[1].trade_quantity == 0);
+    assert(tape[2].trade_price == bid && tape[2].trade_quantity == 100 && tape[2].trade_side == OrderSide::BUY);
+
+    // Joining the bid gets filled alongside the market; a wider quote does not
+    const Price max_spread = price_from_dollars(0.10);
+    std::vector<SweepParams> params = {
+        SweepParams{price_from_dollars(0.02), max_spread, 1000, 100},
+        SweepParams{price_from_dollars(0.04), max_spread, 1000, 100},
+    };
+    ParameterSweep single(ParameterSweep::Config{});
+    SweepReport report = single.run(tape, params);
+    assert(report.results.size() == 2);
+    const SweepResult &tight = report.results[0];
+    assert(tight.fills == 1 && tight.filled_quantity == 100);
+    assert(tight.pnl == 100 * (price_from_dollars(100.00) - bid));
+    assert(tight.max_position == 100);
+    assert(report.results[1].fills == 0 && report.results[1].pnl == 0);
+
+    // A random day: results do not depend on threads or grouping
+    std::mt19937 gen(11);
+    FeedTape random_tape(256, 64);
+    std::vector<BookUpdate> day;
+    std::vector<OrderId> live;
+    OrderId next_id = 1;
+    for (Timestamp now = 1; now <= 20000; ++now)
+    {
+        if (live.size() < 50 || gen() % 3 == 0)
+        {
+            OrderSide side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+            Price offset = static_cast<Price>(1 + gen() % 10) * 100;
+            BookUpdate u = update(BookUpdateType::ADD, next_id, side == OrderSide::BUY ? bid - offset : ask + offset,
+                                  100 + gen() % 400, side, now);
+            u.symbol = static_cast<SymbolId>(1 + (next_id - 1) % 8);
+            live.push_back(next_id++);
+            day.push_back(u);
+            continue;
+        }
+        size_t k = gen() % live.size();
+        BookUpdate u = update(gen() % 2 ? BookUpdateType::EXECUTE : BookUpdateType::DELETE, live[k], 0, 100, OrderSide::BUY, now);
+        u.symbol = static_cast<SymbolId>(1 + (live[k] - 1) % 8);
+        day.push_back(u);
+        live[k] = live.back();
+        live.pop_back();
+    }
+    random_tape.append(day.data(), day.size());
+    assert(random_tape.size() > 1000);
+
+    params.clear();
+    for (Price min_spread : {100, 200, 400})
+    {
+        for (Quantity max_inventory : {200u, 1000u})
+        {
+            for (Quantity quote_size : {50u, 200u})
+            {
+                params.push_back(SweepParams{min_spread, 1000, max_inventory, quote_size});
+            }
+        }
+    }
+    ParameterSweep::Config parallel_config;
+    parallel_config.num_threads = 4;
+    parallel_config.configs_per_pass = 5;
+    ParameterSweep parallel(parallel_config);
+    ParameterSweep::Config serial_config;
+    serial_config.num_threads = 1;
+    serial_config.configs_per_pass = 1;
+    ParameterSweep serial(serial_config);
+    SweepReport a = parallel.run(random_tape, params);
+    SweepReport b = serial.run(random_tape, params);
+    assert(a.threads == 3 && b.threads == 1);
+    uint64_t total_fills = 0;
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        assert(a.results[i].params.min_spread == params[i].min_spread);
+        assert(a.results[i].pnl == b.results[i].pnl);
+        assert(a.results[i].max_drawdown == b.results[i].max_drawdown);
+        assert(a.results[i].fills == b.results[i].fills);
+        assert(a.results[i].quote_updates == b.results[i].quote_updates);
+        assert(a.results[i].peak_pnl - a.results[i].pnl <= a.results[i].max_drawdown);
+        total_fills += a.results[i].fills;
+    }
+    assert(total_fills > 0);
+
+    // Bad parameters are rejected before anything runs
+    bool thrown = false;
+    try
+    {
+        serial.run(random_tape, {SweepParams{200, 100, 1000, 100}});
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Decoding streams onto the tape, so the memory cap stops a day partway
+    const std::string itch_file = "data/sample.itch";
+    if (std::filesystem::exists(itch_file))
+    {
+        FeedTape capped_tape;
+        bool loaded = capped_tape.load_itch_file(itch_file, 1024 * 1024);
+        assert(!loaded && capped_tape.updates_applied() > 0);
+        (void)loaded;
+    }
+
+    std::cout << "Parameter sweep test passed!" << std::endl;
+}
+
+void test_rolling_stats()
+{
+    std::cout << "\nTesting rolling statistics..." << std::endl;
+
+    // Each estimator against a recomputation over the full history
+    std::mt19937 gen(17);
+    constexpr size_t window = 37;
+    constexpr double alpha = 0.1;
+    EwmaStats ewma(alpha);
+    RollingWindow rolling(window);
+    RollingMinMax range(window);
+    std::vector<int64_t> history;
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        // A drifting random walk with runs, so the extremes keep changing
+        int64_t x = (history.empty() ? price_from_dollars(100.00) : history.back()) + static_cast<int64_t>(gen() % 201) - (i % 400 < 200 ? 90 : 110);
+        history.push_back(x);
+        ewma.update(double(x));
+        rolling.push(x);
+        range.push(x);
+
+        double weight = 1.0, weight_sum = 0.0, mean = 0.0;
+        for (size_t j = history.size(); j-- > 0;)
+        {
+            double w = j == 0 ? weight : weight * alpha;
+            mean += w * double(history[j]);
+            weight_sum += w;
+            weight *= 1.0 - alpha;
+        }
+        assert(std::abs(ewma.mean() - mean / weight_sum) < 1e-6 * std::abs(mean));
+
+        size_t first = history.size() > window ? history.size() - window : 0;
+        int64_t sum = 0, lo = history[first], hi = history[first];
+        for (size_t j = first; j < history.size(); ++j)
+        {
+            sum += history[j];
+            lo = std::min(lo, history[j]);
+            hi = std::max(hi, history[j]);
+        }
+        size_t n = history.size() - first;
+        double window_mean = double(sum) / n, squares = 0.0;
+        for (size_t j = first; j < history.size(); ++j)
+        {
+            squares += (double(history[j]) - window_mean) * (double(history[j]) - window_mean);
+        }
+        assert(rolling.size() == n && range.size() == n);
+        assert(rolling.sum() == sum);
+        assert(std::abs(rolling.mean() - window_mean) < 1e-6);
+        assert(std::abs(rolling.variance() - squares / n) < 1e-6 * (1.0 + squares / n));
+        assert(range.min() == lo && range.max() == hi);
+    }
+
+    // Steady input has no EWMA variance; reset starts over
+    EwmaStats steady(0.5);
+    for (int i = 0; i < 10; ++i)
+    {
+        steady.update(5.0);
+    }
+    assert(steady.mean() == 5.0 && steady.variance() == 0.0);
+    rolling.reset();
+    range.reset();
+    rolling.push(-7);
+    range.push(-7);
+    assert(rolling.sum() == -7 && rolling.variance() == 0.0);
+    assert(range.min() == -7 && range.max() == -7);
+
+    bool thrown = false;
+    try
+    {
+        EwmaStats bad(0.0);
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Rolling statistics test passed!" << std::endl;
+}
+
+void test_signal_strategies()
+{
+    std::cout << "\nTesting adaptive spread, mean reversion and momentum strategies..." << std::endl;
+
+    const Price base_price = price_from_dollars(100.00);
+    const SymbolId symbol = 9;
+    PositionTracker positions;
+    auto two_sided = [](Price mid)
+    {
+        return BestBidOffer{mid - 500, mid + 500};
+    };
+
+    // Volatile mids widen the adaptive spread up to its cap; calm ones let it narrow
+    AdaptiveSpreadStrategy::Config adaptive_config{};
+    adaptive_config.base_price = base_price;
+    adaptive_config.min_spread = price_from_dollars(0.02);
+    adaptive_config.max_spread = price_from_dollars(0.50);
+    adaptive_config.volatility_multiplier = 2.0;
+    adaptive_config.ewma_alpha = 0.2;
+    adaptive_config.quote_size = 100;
+    adaptive_config.symbols = {symbol};
+    AdaptiveSpreadStrategy adaptive(adaptive_config);
+    OrderBookManager adaptive_books(16, 8);
+    adaptive.update_quotes(adaptive_books, positions, 1);
+    assert(adaptive_books.get_bbo(symbol) == (BestBidOffer{base_price - 100, base_price + 100}));
+    for (int i = 0; i < 20; ++i)
+    {
+        adaptive.on_book_update(symbol, 0, two_sided(base_price + (i & 1) * 800), adaptive_books, positions, 2 + i);
+    }
+    Price wide = adaptive.get_spread(0);
+    assert(wide > price_from_dollars(0.10) && wide <= adaptive_config.max_spread);
+    for (int i = 0; i < 40; ++i)
+    {
+        adaptive.on_book_update(symbol, 0, two_sided(base_price), adaptive_books, positions, 30 + i);
+    }
+    assert(adaptive.get_spread(0) < wide / 4);
+    assert(adaptive.get_quote_stats().new_orders == 2);
+
+    // Mean reversion leans back toward the rolling mean after a jump
+    MeanReversionStrategy::Config reversion_config{};
+    reversion_config.base_price = base_price;
+    reversion_config.spread = price_from_dollars(0.04);
+    reversion_config.window = 10;
+    reversion_config.reversion = 0.5;
+    reversion_config.quote_size = 100;
+    reversion_config.symbols = {symbol};
+    MeanReversionStrategy reversion(reversion_config);
+    OrderBookManager reversion_books(16, 8);
+    for (int i = 0; i < 10; ++i)
+    {
+        reversion.on_book_update(symbol, 0, two_sided(base_price), reversion_books, positions, 1 + i);
+    }
+    assert(reversion.get_fair_value(0) == base_price);
+    const Price jump = price_from_dollars(0.20);
+    reversion.on_book_update(symbol, 0, two_sided(base_price + jump), reversion_books, positions, 11);
+    Price mean = base_price + jump / 10;
+    assert(reversion.get_fair_value(0) == base_price + jump - (base_price + jump - mean) / 2);
+    // Its ask would cross the market's bid, so only the bid is quoted
+    assert(reversion_books.get_bbo(symbol) == (BestBidOffer{reversion.get_fair_value(0) - reversion_config.spread / 2, 0}));
+
+    // Momentum leans with a breakout and back to the mid inside the range
+    MomentumStrategy::Config momentum_config{};
+    momentum_config.base_price = base_price;
+    momentum_config.spread = price_from_dollars(0.04);
+    momentum_config.window = 5;
+    momentum_config.skew = price_from_dollars(0.01);
+    momentum_config.quote_size = 100;
+    momentum_config.symbols = {symbol};
+    MomentumStrategy momentum(momentum_config);
+    OrderBookManager momentum_books(16, 8);
+    momentum.on_book_update(symbol, 0, two_sided(base_price), momentum_books, positions, 1);
+    assert(momentum.get_fair_value(0) == base_price);
+    momentum.on_book_update(symbol, 0, two_sided(base_price + 300), momentum_books, positions, 2);
+    assert(momentum.get_fair_value(0) == base_price + 300 + momentum_config.skew);
+    momentum.on_book_update(symbol, 0, two_sided(base_price + 100), momentum_books, positions, 3);
+    assert(momentum.get_fair_value(0) == base_price + 100);
+    momentum.on_book_update(symbol, 0, two_sided(base_price - 100), momentum_books, positions, 4);
+    assert(momentum.get_fair_value(0) == base_price - 100 - momentum_config.skew);
+    // base_price + 300 leaves the 5-mid window, so a smaller rise is a new high
+    momentum.on_book_update(symbol, 0, two_sided(base_price), momentum_books, positions, 5);
+    momentum.on_book_update(symbol, 0, two_sided(base_price), momentum_books, positions, 6);
+    momentum.on_book_update(symbol, 0, two_sided(base_price + 200), momentum_books, positions, 7);
+    assert(momentum.get_fair_value(0) == base_price + 200 + momentum_config.skew);
+
+    // A symbol past the dense BBO arrays is rejected at construction
+    const std::vector<SymbolId> out_of_range = {symbol, static_cast<SymbolId>(MAX_SYMBOLS)};
+    adaptive_config.symbols = out_of_range;
+    reversion_config.symbols = out_of_range;
+    momentum_config.symbols = out_of_range;
+    int rejected = 0;
+    try
+    {
+        AdaptiveSpreadStrategy bad(adaptive_config);
+    }
+    catch (const std::invalid_argument &)
+    {
+        ++rejected;
+    }
+    try
+    {
+        MeanReversionStrategy bad(reversion_config);
+    }
+    catch (const std::invalid_argument &)
+    {
+        ++rejected;
+    }
+    try
+    {
+        MomentumStrategy bad(momentum_config);
+    }
+    catch (const std::invalid_argument &)
+    {
+        ++rejected;
+    }
+    assert(rejected == 3);
+
+    std::cout << "Adaptive spread, mean reversion and momentum test passed!" << std::endl;
+}
+
 int main()
 {
     std::cout << "Memory Market Maker - Data Processing Tests" << std::endl;
@@ -319,12 +1025,26 @@ int main()
     {
         test_itch_parser_small_sample();
 
+        test_multi_day_replay_driver();
+
         test_scenario_runner_individual();
 
         test_scenario_runner_performance();
 
         test_memory_efficiency();
 
+        test_strategy_dispatcher();
+
+        test_inventory_skewed_quotes();
+
+        test_policy_strategy();
+
+        test_parameter_sweep();
+
+        test_rolling_stats();
+
+        test_signal_strategies();
+
         std::cout << "\n=== All data processing tests completed! ===" << std::endl;
     }
     catch (const std::exception &e)
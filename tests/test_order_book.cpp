@@ -1,4 +1,7 @@
 #include "order_book.hpp"
+#include "quote_manager.hpp"
+#include "risk_gate.hpp"
+#include "fill_simulator.hpp"
 #include <cassert>
 #include <iostream>
 
@@ -10,8 +13,8 @@ void test_order_book_basic()
 
     OrderBook order_book(1);
 
-    assert(order_book.add_order(1, price_from_dollars(100.00), 1000, OrderSide::BUY));
-    assert(order_book.add_order(2, price_from_dollars(100.10), 1000, OrderSide::SELL));
+    assert(order_book.add_order(1, price_from_dollars(100.00), 1000, OrderSide::BUY, 1));
+    assert(order_book.add_order(2, price_from_dollars(100.10), 1000, OrderSide::SELL, 2));
 
     auto [bid_price, bid_qty] = order_book.get_best_bid();
     auto [ask_price, ask_qty] = order_book.get_best_ask();
@@ -20,6 +23,7 @@ void test_order_book_basic()
     assert(bid_qty == 1000);
     assert(ask_price == price_from_dollars(100.10));
     assert(ask_qty == 1000);
+    assert(order_book.get_order(2)->timestamp == 2);
 
     Price mid_price = order_book.get_mid_price();
     Price spread = order_book.get_spread();
@@ -36,10 +40,10 @@ void test_order_book_execution()
 
     OrderBook order_book(1);
 
-    order_book.add_order(1, price_from_dollars(100.00), 1000, OrderSide::BUY);
-    order_book.add_order(2, price_from_dollars(100.10), 1000, OrderSide::SELL);
+    order_book.add_order(1, price_from_dollars(100.00), 1000, OrderSide::BUY, 1);
+    order_book.add_order(2, price_from_dollars(100.10), 1000, OrderSide::SELL, 2);
 
-    bool executed = order_book.execute_trade(price_from_dollars(100.00), 500, OrderSide::SELL);
+    bool executed = order_book.execute_trade(price_from_dollars(100.00), 500, OrderSide::SELL, 3);
     assert(executed);
 
     auto [bid_price, bid_qty] = order_book.get_best_bid();
@@ -48,12 +52,356 @@ void test_order_book_execution()
     std::cout << "Order book execution test passed!" << std::endl;
 }
 
+void test_order_book_time_priority()
+{
+    std::cout << "Testing order book time priority..." << std::endl;
+
+    OrderBook order_book(1);
+    const Price bid = price_from_dollars(100.00);
+
+    // The earlier order fills first, whatever the ids
+    order_book.add_order(7, bid, 300, OrderSide::BUY, 1);
+    order_book.add_order(3, bid, 200, OrderSide::BUY, 2);
+    bool executed = order_book.execute_trade(bid, 300, OrderSide::SELL, 3);
+    assert(executed);
+    assert(order_book.get_order(7) == nullptr);
+    assert(order_book.get_order(3) && order_book.get_order(3)->filled_quantity == 0);
+
+    // A modified order goes behind orders that arrived before the modify
+    order_book.add_order(9, bid, 100, OrderSide::BUY, 4);
+    order_book.modify_order(3, bid, 200, 5);
+    executed = order_book.execute_trade(bid, 150, OrderSide::SELL, 6);
+    assert(executed);
+    (void)executed;
+    assert(order_book.get_order(9) == nullptr);
+    assert(order_book.get_order(3) && order_book.get_order(3)->filled_quantity == 50);
+    assert(order_book.get_best_bid() == std::make_pair(bid, Quantity(150)));
+
+    std::cout << "Order book time priority test passed!" << std::endl;
+}
+
+void test_order_book_batch_apply()
+{
+    std::cout << "Testing batched feed apply..." << std::endl;
+
+    std::vector<BookUpdate> updates;
+    for (OrderId id = 1; id <= 40; ++id)
+    {
+        BookUpdate add{};
+        add.type = BookUpdateType::ADD;
+        add.side = (id % 2) ? OrderSide::BUY : OrderSide::SELL;
+        add.symbol = static_cast<SymbolId>(id % 3 + 1);
+        add.quantity = 100;
+        add.order_id = id;
+        add.price = (id % 2) ? price_from_dollars(99.00) + static_cast<Price>(id) : price_from_dollars(101.00) + static_cast<Price>(id);
+        add.timestamp = id;
+        updates.push_back(add);
+    }
+    for (OrderId id = 1; id <= 40; id += 4)
+    {
+        BookUpdate execute{};
+        execute.type = BookUpdateType::EXECUTE;
+        execute.symbol = static_cast<SymbolId>(id % 3 + 1);
+        execute.order_id = id;
+        execute.quantity = 40;
+        updates.push_back(execute);
+
+        BookUpdate remove{};
+        remove.type = BookUpdateType::DELETE;
+        remove.symbol = static_cast<SymbolId>((id + 1) % 3 + 1);
+        remove.order_id = id + 1;
+        updates.push_back(remove);
+
+        BookUpdate replace{};
+        replace.type = BookUpdateType::REPLACE;
+        replace.symbol = static_cast<SymbolId>((id + 2) % 3 + 1);
+        replace.order_id = id + 2;
+        replace.new_order_id = id + 1000;
+        replace.quantity = 70;
+        replace.price = price_from_dollars(98.00);
+        updates.push_back(replace);
+    }
+
+    OrderBookManager single;
+    OrderBookManager batched;
+    size_t applied_single = single.apply(updates.data(), updates.size());
+    size_t applied_batched = batched.apply_batch(updates.data(), updates.size());
+    OrderBookManager plain;
+    size_t applied_plain = plain.apply_batch(updates.data(), updates.size(), false);
+    assert(applied_single == updates.size());
+    assert(applied_batched == applied_single);
+    assert(applied_plain == applied_single);
+    assert(plain.get_order_book(1)->get_bids() == single.get_order_book(1)->get_bids());
+    (void)applied_plain;
+
+    for (SymbolId symbol = 1; symbol <= 3; ++symbol)
+    {
+        auto a = single.get_order_book(symbol)->get_stats();
+        auto b = batched.get_order_book(symbol)->get_stats();
+        assert(a.total_orders == b.total_orders);
+        assert(a.best_bid == b.best_bid && a.best_ask == b.best_ask);
+        assert(single.get_order_book(symbol)->get_bids() == batched.get_order_book(symbol)->get_bids());
+        // Dense BBO arrays track every book
+        assert(single.best_bids()[symbol] == a.best_bid && single.best_asks()[symbol] == a.best_ask);
+        assert(batched.best_bids()[symbol] == b.best_bid && batched.best_asks()[symbol] == b.best_ask);
+        (void)a;
+        (void)b;
+    }
+
+    const Order *executed = batched.get_order_book(2)->get_order(1);
+    assert(executed && executed->filled_quantity == 40);
+    assert(batched.get_order_book(3)->get_order(2) == nullptr);
+    (void)executed;
+
+    std::cout << "Batched feed apply test passed!" << std::endl;
+}
+
+void test_order_table_erase()
+{
+    std::cout << "Testing order table erase..." << std::endl;
+
+    OrderTable table(16);
+    std::vector<Order> orders(5000);
+    for (OrderId id = 0; id < orders.size(); ++id)
+    {
+        bool inserted = table.insert(id * 7919, &orders[id]);
+        assert(inserted);
+        (void)inserted;
+    }
+    for (OrderId id = 0; id < orders.size(); id += 2)
+    {
+        bool erased = table.erase(id * 7919);
+        assert(erased);
+        (void)erased;
+    }
+    for (OrderId id = 0; id < orders.size(); ++id)
+    {
+        assert(table.find(id * 7919) == ((id % 2) ? &orders[id] : nullptr));
+    }
+    assert(table.size() == orders.size() / 2);
+
+    std::cout << "Order table erase test passed!" << std::endl;
+}
+
+void test_quote_manager()
+{
+    std::cout << "Testing quote manager..." << std::endl;
+
+    OrderBookManager books(1000, 100);
+    PreTradeRiskGate gate;
+    QuoteManager quotes(1);
+    quotes.set_risk_gate(&gate);
+    const SymbolId symbol = 7;
+    const Price bid = price_from_dollars(99.95);
+    const Price ask = price_from_dollars(100.05);
+
+    // First update enters both sides, an identical one sends nothing
+    quotes.update(books, symbol, QuoteTarget{bid, 100, ask, 100}, 1);
+    assert(quotes.get_stats().new_orders == 2);
+    OrderId bid_id = quotes.working(symbol, OrderSide::BUY).order_id;
+    quotes.update(books, symbol, QuoteTarget{bid, 100, ask, 100}, 2);
+    assert(quotes.get_stats().operations() == 2);
+    assert(quotes.get_stats().unchanged == 2);
+    assert(quotes.working(symbol, OrderSide::BUY).order_id == bid_id);
+    assert(gate.get_state(symbol).pending_buy == 100);
+
+    // A repriced bid is amended in place; the old level does not linger
+    const Price better_bid = bid + 100;
+    quotes.update(books, symbol, QuoteTarget{better_bid, 200, ask, 100}, 3);
+    assert(quotes.get_stats().amends == 1);
+    assert(quotes.working(symbol, OrderSide::BUY).order_id == bid_id);
+    const OrderBook *book = books.get_order_book(symbol);
+    assert(book->get_best_bid() == std::make_pair(better_bid, Quantity(200)));
+    assert(book->level_count() == 2);
+    assert(gate.get_state(symbol).pending_buy == 200);
+
+    // A partial fill is topped back up to the target remaining size
+    books.execute_trade(symbol, better_bid, 50, OrderSide::SELL, 4);
+    quotes.on_fill(symbol, OrderSide::BUY, 50);
+    assert(quotes.working(symbol, OrderSide::BUY).remaining() == 150);
+    quotes.update(books, symbol, QuoteTarget{better_bid, 200, ask, 100}, 5);
+    assert(book->get_best_bid() == std::make_pair(better_bid, Quantity(200)));
+    assert(quotes.working(symbol, OrderSide::BUY).remaining() == 200);
+
+    // A fully filled side is re-entered under a new id
+    books.execute_trade(symbol, ask, 100, OrderSide::BUY, 6);
+    quotes.on_fill(symbol, OrderSide::SELL, 100);
+    assert(quotes.working(symbol, OrderSide::SELL).order_id == 0);
+    uint64_t new_orders = quotes.get_stats().new_orders;
+    quotes.update(books, symbol, QuoteTarget{better_bid, 200, ask, 100}, 7);
+    assert(quotes.get_stats().new_orders == new_orders + 1);
+    assert(book->get_best_ask() == std::make_pair(ask, Quantity(100)));
+
+    // An order that left the book without us is detected and replaced
+    books.cancel_order(symbol, quotes.working(symbol, OrderSide::BUY).order_id, 8);
+    quotes.update(books, symbol, QuoteTarget{bid, 200, ask, 100}, 9);
+    assert(quotes.get_stats().new_orders == new_orders + 2);
+    assert(book->get_best_bid() == std::make_pair(bid, Quantity(200)));
+    assert(gate.get_state(symbol).pending_buy == 200);
+
+    // Dropping a side cancels it
+    quotes.update(books, symbol, QuoteTarget{bid, 200, 0, 0}, 10);
+    assert(book->get_best_ask().first == 0);
+    assert(gate.get_state(symbol).pending_sell == 0);
+    quotes.cancel_all(books, 11);
+    assert(book->empty());
+    assert(gate.get_state(symbol).pending_buy == 0);
+
+    // Hysteresis leaves small moves alone; cancel/replace mode sends two operations per change
+    QuoteManagerConfig config;
+    config.price_tolerance = 100;
+    config.size_tolerance = 10;
+    config.amend_in_place = false;
+    QuoteManager lazy(1000, config);
+    lazy.update(books, symbol, QuoteTarget{bid, 100, ask, 100}, 12);
+    lazy.update(books, symbol, QuoteTarget{bid + 100, 110, ask - 100, 90}, 13);
+    assert(lazy.get_stats().unchanged == 2);
+    lazy.update(books, symbol, QuoteTarget{bid + 200, 100, ask, 100}, 14);
+    assert(lazy.get_stats().cancels == 1);
+    assert(lazy.get_stats().new_orders == 3);
+    assert(book->get_best_bid() == std::make_pair(bid + 200, Quantity(100)));
+    assert(book->order_count() == 2);
+
+    std::cout << "Quote manager test passed!" << std::endl;
+}
+
+void test_fill_simulator()
+{
+    std::cout << "Testing queue fill simulator..." << std::endl;
+
+    OrderBookManager market(1000, 100);
+    QueueFillSimulator sim(market);
+    auto feed = [&](BookUpdateType type, SymbolId symbol, OrderId order_id, Price price, Quantity quantity,
+                    OrderSide side, Timestamp now)
+    {
+        BookUpdate update{};
+        update.type = type;
+        update.side = side;
+        update.symbol = symbol;
+        update.quantity = quantity;
+        update.order_id = order_id;
+        update.price = price;
+        update.timestamp = now;
+        sim.apply(&update, 1);
+    };
+
+    // Joins behind the 300 resting at its price; an order arriving later queues behind it
+    const SymbolId symbol = 3;
+    const Price bid = price_from_dollars(99.99);
+    feed(BookUpdateType::ADD, symbol, 1, bid, 100, OrderSide::BUY, 1);
+    feed(BookUpdateType::ADD, symbol, 2, bid, 200, OrderSide::BUY, 2);
+    sim.add_order(symbol, 100, bid, 50, OrderSide::BUY, 3);
+    assert(sim.get_queue_ahead(100) == 300);
+    feed(BookUpdateType::ADD, symbol, 3, bid, 100, OrderSide::BUY, 4);
+    assert(sim.get_queue_ahead(100) == 300);
+
+    // Cancels and executions ahead move it up without filling it
+    feed(BookUpdateType::CANCEL, symbol, 2, 0, 50, OrderSide::BUY, 5);
+    assert(sim.get_queue_ahead(100) == 250);
+    feed(BookUpdateType::EXECUTE, symbol, 1, 0, 100, OrderSide::BUY, 6);
+    assert(sim.get_queue_ahead(100) == 150);
+    feed(BookUpdateType::DELETE, symbol, 2, 0, 0, OrderSide::BUY, 7);
+    assert(sim.get_queue_ahead(100) == 0);
+    assert(sim.get_fills().empty());
+
+    // An execution of the order behind it means it traded first
+    feed(BookUpdateType::EXECUTE, symbol, 3, 0, 60, OrderSide::BUY, 8);
+    assert(sim.get_fills().size() == 1);
+    assert(sim.get_fills()[0].order_id == 100 && sim.get_fills()[0].side == OrderSide::BUY && sim.get_fills()[0].price == bid);
+    assert(sim.get_fills()[0].quantity == 50 && sim.get_fills()[0].timestamp == 8);
+    assert(sim.get_stats().working_orders == 0);
+    bool cancelled = sim.cancel_order(symbol, 100, 9);
+    assert(!cancelled);
+    (void)cancelled;
+    assert(market.get_order_book(symbol)->get_best_bid() == std::make_pair(bid, Quantity(40)));
+    sim.clear_fills();
+
+    // An execution at a worse price sweeps it whole
+    const Price ask = price_from_dollars(100.02);
+    feed(BookUpdateType::ADD, symbol, 4, ask + 100, 200, OrderSide::SELL, 10);
+    sim.add_order(symbol, 101, ask, 30, OrderSide::SELL, 11);
+    assert(sim.get_queue_ahead(101) == 0);
+    feed(BookUpdateType::EXECUTE, symbol, 4, 0, 10, OrderSide::SELL, 12);
+    assert(sim.get_fills().size() == 1 && sim.get_fills()[0].quantity == 30 && sim.get_fills()[0].price == ask);
+    sim.clear_fills();
+
+    // An incoming order through its price trades with it; the rest stays working
+    const SymbolId other = 4;
+    sim.add_order(other, 102, price_from_dollars(100.00), 100, OrderSide::BUY, 13);
+    feed(BookUpdateType::ADD, other, 5, price_from_dollars(100.00), 40, OrderSide::SELL, 14);
+    assert(sim.get_fills().size() == 1 && sim.get_fills()[0].quantity == 40);
+    feed(BookUpdateType::ADD, other, 6, price_from_dollars(100.01), 40, OrderSide::SELL, 15);
+    assert(sim.get_fills().size() == 1);
+    assert(sim.get_stats().working_orders == 1);
+    sim.clear_fills();
+
+    // One incoming order crossing two of ours fills the better price first,
+    // and only as far as its own quantity goes
+    const SymbolId swept = 7;
+    sim.add_order(swept, 105, price_from_dollars(100.00), 50, OrderSide::BUY, 16);
+    sim.add_order(swept, 106, price_from_dollars(100.01), 50, OrderSide::BUY, 16);
+    feed(BookUpdateType::ADD, swept, 11, price_from_dollars(100.00), 70, OrderSide::SELL, 16);
+    assert(sim.get_fills().size() == 2);
+    assert(sim.get_fills()[0].order_id == 106 && sim.get_fills()[0].quantity == 50);
+    assert(sim.get_fills()[1].order_id == 105 && sim.get_fills()[1].quantity == 20);
+    cancelled = sim.cancel_order(swept, 105, 16);
+    assert(cancelled);
+    sim.clear_fills();
+
+    // Cutting size keeps its place; growing it or moving goes to the back
+    const SymbolId third = 5;
+    feed(BookUpdateType::ADD, third, 7, bid, 100, OrderSide::BUY, 16);
+    sim.add_order(third, 103, bid, 100, OrderSide::BUY, 17);
+    feed(BookUpdateType::ADD, third, 8, bid, 100, OrderSide::BUY, 18);
+    sim.modify_order(third, 103, bid, 80, 19);
+    assert(sim.get_queue_ahead(103) == 100);
+    sim.modify_order(third, 103, bid, 120, 20);
+    assert(sim.get_queue_ahead(103) == 200);
+    sim.modify_order(third, 103, bid - 100, 120, 21);
+    assert(sim.get_queue_ahead(103) == 0);
+    sim.cancel_order(third, 103, 22);
+    bool modified = sim.modify_order(third, 103, bid, 100, 23);
+    assert(!modified);
+    (void)modified;
+
+    // A market order stamped the instant we joined counts as ahead
+    const SymbolId fourth = 6;
+    sim.add_order(fourth, 104, bid, 100, OrderSide::BUY, 24);
+    feed(BookUpdateType::ADD, fourth, 9, bid, 100, OrderSide::BUY, 24);
+    feed(BookUpdateType::EXECUTE, fourth, 9, 0, 10, OrderSide::BUY, 25);
+    assert(sim.get_fills().empty());
+
+    // A quote manager sends its orders to the simulator, not the book
+    const SymbolId quoted = 8;
+    QuoteManager quotes(1000);
+    quotes.set_fill_simulator(&sim);
+    quotes.update(market, quoted, QuoteTarget{bid, 100, ask, 100}, 26);
+    assert(quotes.get_stats().new_orders == 2);
+    assert(market.get_bbo(quoted) == (BestBidOffer{0, 0}));
+    feed(BookUpdateType::ADD, quoted, 10, bid, 100, OrderSide::SELL, 27);
+    assert(sim.get_fills().size() == 1 && sim.get_fills()[0].order_id == quotes.working(quoted, OrderSide::BUY).order_id);
+    quotes.on_fill(quoted, OrderSide::BUY, sim.get_fills()[0].quantity);
+    sim.clear_fills();
+    quotes.update(market, quoted, QuoteTarget{bid, 100, ask, 100}, 28);
+    assert(quotes.get_stats().new_orders == 3);
+    assert(sim.get_queue_ahead(quotes.working(quoted, OrderSide::SELL).order_id) == 0);
+    quotes.cancel_all(market, 29);
+    assert(sim.get_stats().working_orders == 2); // Symbols 4 and 6 above
+
+    std::cout << "Queue fill simulator test passed!" << std::endl;
+}
+
 int main()
 {
     try
     {
         test_order_book_basic();
         test_order_book_execution();
+        test_order_book_time_priority();
+        test_order_book_batch_apply();
+        test_order_table_erase();
+        test_quote_manager();
+        test_fill_simulator();
         std::cout << "All order book tests passed!" << std::endl;
         return 0;
     }
@@ -1,6 +1,19 @@
 #include "position_tracker.hpp"
+#include "crc32.hpp"
+#include "position_shm.hpp"
+#include "risk_gate.hpp"
+#include "portfolio_var.hpp"
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
 using namespace mm;
 
@@ -15,20 +28,23 @@ void test_position_tracker_basic()
 
     PositionTracker tracker(limits);
 
-    assert(tracker.record_trade(1, price_from_dollars(100.00), 1000, OrderSide::BUY, 1));
+    assert(tracker.record_trade(1, price_from_dollars(100.00), 1000, OrderSide::BUY, 1, 1));
 
-    const Position *pos = tracker.get_position(1);
-    assert(pos != nullptr);
-    assert(pos->long_quantity == 1000);
-    assert(pos->short_quantity == 0);
-    assert(pos->avg_long_price == price_from_dollars(100.00));
+    Position pos;
+    assert(tracker.get_position(1, pos));
+    assert(pos.long_quantity == 1000);
+    assert(pos.short_quantity == 0);
+    assert(pos.avg_long_price == price_from_dollars(100.00));
 
-    assert(tracker.record_trade(1, price_from_dollars(100.10), 500, OrderSide::SELL, 2));
+    assert(tracker.record_trade(1, price_from_dollars(100.10), 500, OrderSide::SELL, 2, 2));
 
-    pos = tracker.get_position(1);
-    assert(pos->long_quantity == 1000);
-    assert(pos->short_quantity == 500);
-    assert(pos->avg_short_price == price_from_dollars(100.10));
+    // The sell closes part of the long instead of opening a short
+    assert(tracker.get_position(1, pos));
+    assert(pos.long_quantity == 500);
+    assert(pos.short_quantity == 0);
+    assert(pos.avg_long_price == price_from_dollars(100.00));
+    assert(pos.last_update == 2);
+    assert(!tracker.get_position(2, pos));
 
     std::cout << "Basic position tracker test passed!" << std::endl;
 }
@@ -40,26 +56,1045 @@ void test_position_tracker_pnl()
     PositionLimits limits;
     PositionTracker tracker(limits);
 
-    tracker.record_trade(1, price_from_dollars(100.00), 1000, OrderSide::BUY, 1);
+    tracker.record_trade(1, price_from_dollars(100.00), 1000, OrderSide::BUY, 1, 1);
 
-    tracker.record_trade(1, price_from_dollars(100.10), 500, OrderSide::SELL, 2);
+    tracker.record_trade(1, price_from_dollars(100.10), 500, OrderSide::SELL, 2, 2);
 
     PnL realized_pnl = tracker.get_total_realized_pnl();
     PnL expected_pnl = (price_from_dollars(100.10) - price_from_dollars(100.00)) * 500;
     assert(realized_pnl == expected_pnl);
 
-    tracker.update_unrealized_pnl(1, price_from_dollars(100.05));
+    tracker.update_unrealized_pnl(1, price_from_dollars(100.05), 3);
     PnL unrealized_pnl = tracker.get_total_unrealized_pnl();
 
     std::cout << "Position tracker P&L test passed!" << std::endl;
 }
 
+void test_lot_matching()
+{
+    std::cout << "Testing lot-level realized P&L..." << std::endl;
+
+    // FIFO: the sell closes the 10.00 lot first, then part of the 12.00 lot
+    PositionTracker fifo;
+    fifo.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+    fifo.record_trade(1, price_from_dollars(12.00), 100, OrderSide::BUY, 2, 2);
+    fifo.record_trade(1, price_from_dollars(11.00), 150, OrderSide::SELL, 3, 3);
+
+    Position pos;
+    assert(fifo.get_position(1, pos));
+    assert(pos.realized_pnl == price_from_dollars(1.00) * 100 - price_from_dollars(1.00) * 50);
+    assert(pos.long_quantity == 50 && pos.short_quantity == 0);
+    assert(pos.avg_long_price == price_from_dollars(12.00));
+
+    Lot lots[4];
+    assert(fifo.get_open_lots(1, lots, 4) == 1);
+    assert(lots[0].order_id == 2 && lots[0].quantity == 50);
+
+    // LIFO closes the 12.00 lot first
+    PositionTracker lifo;
+    lifo.set_lot_method(LotMethod::LIFO);
+    lifo.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+    lifo.record_trade(1, price_from_dollars(12.00), 100, OrderSide::BUY, 2, 2);
+    lifo.record_trade(1, price_from_dollars(11.00), 150, OrderSide::SELL, 3, 3);
+    assert(lifo.get_position(1, pos));
+    assert(pos.realized_pnl == -price_from_dollars(1.00) * 100 + price_from_dollars(1.00) * 50);
+    assert(pos.avg_long_price == price_from_dollars(10.00));
+
+    // Crossing through flat closes every lot and opens the other side
+    fifo.record_trade(1, price_from_dollars(13.00), 80, OrderSide::SELL, 4, 4);
+    assert(fifo.get_position(1, pos));
+    assert(pos.long_quantity == 0 && pos.short_quantity == 30);
+    assert(pos.avg_short_price == price_from_dollars(13.00));
+    assert(pos.realized_pnl == price_from_dollars(1.00) * 100 - price_from_dollars(1.00) * 50 + price_from_dollars(1.00) * 50);
+
+    // A round trip back to flat realizes everything, across many segments
+    PositionTracker round_trip;
+    PnL expected = 0;
+    for (OrderId i = 0; i < 10 * LOTS_PER_SEGMENT; ++i)
+    {
+        round_trip.record_trade(2, price_from_dollars(20.00) + static_cast<Price>(i), 10, OrderSide::SELL, i, i);
+        expected += (price_from_dollars(20.00) + static_cast<Price>(i) - price_from_dollars(19.00)) * 10;
+    }
+    round_trip.record_trade(2, price_from_dollars(19.00), 10 * 10 * LOTS_PER_SEGMENT, OrderSide::BUY, 999, 999);
+    assert(round_trip.get_position(2, pos) && pos.is_flat());
+    assert(pos.realized_pnl == expected);
+    assert(round_trip.get_open_lots(2, lots, 4) == 0);
+
+    std::cout << "Lot matching test passed!" << std::endl;
+}
+
+void test_position_tracker_concurrent_reads()
+{
+    PositionTracker tracker;
+    constexpr Quantity num_trades = 20000;
+
+    // Each trade bumps long_quantity and last_update together, so any
+    // snapshot where they disagree was torn
+    std::atomic<bool> done{false};
+    const SymbolId both[] = {1, 2};
+    std::thread writer([&]()
+                       {
+        for (Quantity i = 1; i <= num_trades; ++i)
+        {
+            tracker.record_trade(1, price_from_dollars(100.00), 1, OrderSide::BUY, i, i);
+            tracker.record_trade(2, price_from_dollars(50.00), 1, OrderSide::SELL, i, i);
+        }
+        done.store(true); });
+
+    size_t snapshots = 0;
+    while (!done.load() || snapshots == 0)
+    {
+        for (const auto &[symbol, position] : tracker.get_all_positions())
+        {
+            assert(position.symbol == symbol);
+            assert(position.get_total_position() == position.last_update);
+        }
+
+        // Both symbols are written once per iteration, so a consistent cut
+        // never has them more than one trade apart
+        Position cut[2];
+        tracker.get_positions(both, 2, cut);
+        assert(cut[0].last_update >= cut[1].last_update && cut[0].last_update - cut[1].last_update <= 1);
+        ++snapshots;
+    }
+    writer.join();
+
+    Position pos;
+    assert(tracker.get_position(1, pos) && pos.long_quantity == num_trades);
+    assert(tracker.get_position(2, pos) && pos.short_quantity == num_trades);
+    assert(tracker.get_trade_history(1).size() == num_trades);
+    bool recorded = tracker.record_trade(MAX_SYMBOLS, price_from_dollars(1.00), 1, OrderSide::BUY, 1, 1);
+    assert(!recorded);
+    (void)recorded;
+
+    std::cout << "Position tracker concurrent read test passed!" << std::endl;
+}
+
+void test_position_shards()
+{
+    std::cout << "Testing sharded fill accumulation..." << std::endl;
+
+    {
+        PositionTracker tracker;
+        PositionShard &shard = tracker.create_shard();
+        tracker.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+        shard.record_trade(1, price_from_dollars(11.00), 30, OrderSide::SELL, 2, 2);
+        shard.record_trade(2, price_from_dollars(20.00), 40, OrderSide::SELL, 3, 3);
+
+        // Pending fills show up in merged reads only
+        Position pos;
+        assert(tracker.get_position(1, pos) && pos.long_quantity == 100);
+        assert(!tracker.get_position(2, pos));
+        assert(tracker.get_merged_position(1, pos) && pos.long_quantity == 70 && pos.avg_long_price == price_from_dollars(10.00));
+        assert(tracker.get_merged_position(2, pos) && pos.short_quantity == 40);
+        assert(shard.pending() == 2);
+
+        size_t consolidated = tracker.consolidate();
+        assert(consolidated == 2);
+        (void)consolidated;
+        assert(shard.pending() == 0);
+        assert(tracker.get_position(1, pos) && pos.long_quantity == 70);
+        assert(pos.realized_pnl == price_from_dollars(1.00) * 30);
+        assert(tracker.get_merged_position(2, pos) && pos.short_quantity == 40 && pos.avg_short_price == price_from_dollars(20.00));
+    }
+
+    // Several writers, background consolidation, and a reader that would
+    // see the merged quantity dip if a fill were ever counted twice
+    {
+        constexpr int num_writers = 4;
+        constexpr Quantity fills_per_writer = 20000; // More than one ring, so writers also drain themselves
+        PositionTracker tracker;
+        std::vector<PositionShard *> shards;
+        for (int i = 0; i < num_writers; ++i)
+        {
+            shards.push_back(&tracker.create_shard());
+        }
+        tracker.start_consolidation(std::chrono::microseconds(200));
+
+        std::atomic<int> running{num_writers};
+        std::vector<std::thread> writers;
+        for (int w = 0; w < num_writers; ++w)
+        {
+            writers.emplace_back([&, w]()
+                                 {
+                for (Quantity i = 0; i < fills_per_writer; ++i)
+                {
+                    shards[w]->record_trade(1, price_from_dollars(10.00), 1, OrderSide::BUY, i, i);
+                    shards[w]->record_trade(2 + w, price_from_dollars(5.00), 2, (i & 1) ? OrderSide::SELL : OrderSide::BUY, i, i);
+                }
+                running.fetch_sub(1); });
+        }
+
+        Quantity last = 0;
+        while (running.load() > 0)
+        {
+            Position pos;
+            if (tracker.get_merged_position(1, pos))
+            {
+                assert(pos.long_quantity >= last && pos.short_quantity == 0);
+                last = pos.long_quantity;
+            }
+        }
+        for (auto &writer : writers)
+        {
+            writer.join();
+        }
+
+        Position pos;
+        assert(tracker.get_merged_position(1, pos) && pos.long_quantity == num_writers * fills_per_writer);
+        tracker.stop_consolidation();
+        assert(tracker.get_position(1, pos) && pos.long_quantity == num_writers * fills_per_writer);
+        for (int w = 0; w < num_writers; ++w)
+        {
+            assert(shards[w]->pending() == 0);
+            assert(tracker.get_position(static_cast<SymbolId>(2 + w), pos) && pos.is_flat());
+        }
+    }
+
+    std::cout << "Position shard test passed!" << std::endl;
+}
+
+void test_position_tracker_snapshots()
+{
+    PositionTracker tracker;
+    tracker.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+    tracker.record_trade(2, price_from_dollars(20.00), 200, OrderSide::SELL, 2, 2);
+
+    const SymbolId symbols[] = {2, 3, 1};
+    Position out[3];
+    assert(tracker.get_positions(symbols, 3, out) == 2);
+    assert(out[0].short_quantity == 200);
+    assert(out[1].symbol == 3 && out[1].is_flat());
+    assert(out[2].long_quantity == 100);
+
+    // First poll sees everything; later polls only what changed in between
+    std::vector<Position> changed;
+    uint64_t version = tracker.get_positions_changed_since(0, changed);
+    assert(changed.size() == 2);
+
+    version = tracker.get_positions_changed_since(version, changed);
+    assert(changed.empty());
+
+    tracker.record_trade(2, price_from_dollars(20.00), 50, OrderSide::BUY, 3, 3);
+    tracker.update_unrealized_pnl(3, price_from_dollars(30.00), 3);
+    version = tracker.get_positions_changed_since(version, changed);
+    assert(changed.size() == 1 && changed[0].symbol == 2 && changed[0].short_quantity == 150);
+
+    std::cout << "Position tracker snapshot test passed!" << std::endl;
+}
+
+void test_trade_journal()
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "mm_test_trade_journal";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // Tiny segments so the ring rotates and evicts: 3 slots keep 2 readable
+    TradeJournal::Config config;
+    config.directory = dir.string();
+    config.records_per_segment = 8;
+    config.segments = 3;
+
+    {
+        PositionTracker tracker(PositionLimits(), config);
+        for (OrderId i = 0; i < 100; ++i)
+        {
+            tracker.record_trade(static_cast<SymbolId>(i % 2 + 1), price_from_dollars(10.00), 1, OrderSide::BUY, i, i);
+        }
+
+        // Only the writer's segment and the one before it are readable
+        // (records 88..99), so history falls back to the ring
+        std::vector<Trade> history = tracker.get_trade_history(1);
+        assert(history.size() == RECENT_TRADES_PER_SYMBOL);
+        assert(history.back().order_id == 98);
+        assert(history.front().order_id == 98 - 2 * (RECENT_TRADES_PER_SYMBOL - 1));
+
+        std::vector<Trade> all = tracker.get_all_trade_history();
+        assert(all.size() == 12 && all.front().order_id == 88 && all.back().order_id == 99);
+
+        tracker.clear_trade_history();
+        assert(tracker.get_trade_history(1).empty());
+        assert(tracker.get_all_trade_history().empty());
+    }
+
+    // Every segment stays on disk after leaving the ring
+    auto count_segment_files = [&]()
+    {
+        size_t files = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
+        {
+            files += entry.path().extension() == ".log";
+        }
+        return files;
+    };
+    size_t segment_files = count_segment_files();
+    assert(segment_files >= 13);
+
+    // A restart numbers its segments after the previous run's and leaves them intact
+    {
+        PositionTracker restarted(PositionLimits(), config);
+        for (OrderId i = 0; i < 10; ++i)
+        {
+            restarted.record_trade(1, price_from_dollars(11.00), 1, OrderSide::BUY, 1000 + i, 1000 + i);
+        }
+    }
+    assert(count_segment_files() >= segment_files + 2);
+    Trade first_trade;
+    {
+        std::ifstream file(dir / "trades-0000000000.log", std::ios::binary);
+        file.read(reinterpret_cast<char *>(&first_trade), sizeof(first_trade));
+    }
+    assert(first_trade.order_id == 0 && first_trade.price == price_from_dollars(10.00));
+    (void)segment_files;
+    std::filesystem::remove_all(dir);
+
+    // With a roomy journal, history older than the ring is served from it
+    PositionTracker tracker;
+    for (OrderId i = 0; i < 100; ++i)
+    {
+        tracker.record_trade(1, price_from_dollars(10.00), 1, OrderSide::BUY, i, i);
+    }
+    assert(tracker.get_trade_history(1).size() == 100);
+
+    std::cout << "Trade journal test passed!" << std::endl;
+}
+
+void test_trade_sequence_pages()
+{
+    PositionTracker tracker;
+
+    // Timestamps deliberately out of order: history follows record order
+    for (OrderId i = 0; i < 50; ++i)
+    {
+        tracker.record_trade(static_cast<SymbolId>(i % 3 + 1), price_from_dollars(10.00), 1, OrderSide::BUY, i, 1000 - i);
+    }
+    assert(tracker.get_next_trade_sequence() == 50);
+
+    std::vector<Trade> all = tracker.get_all_trade_history();
+    assert(all.size() == 50);
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        assert(all[i].sequence == i && all[i].order_id == i);
+    }
+
+    std::vector<Trade> symbol_history = tracker.get_trade_history(2);
+    for (size_t i = 1; i < symbol_history.size(); ++i)
+    {
+        assert(symbol_history[i].sequence > symbol_history[i - 1].sequence);
+    }
+
+    std::vector<Trade> paged;
+    Trade page[7];
+    uint64_t next = 0;
+    while (size_t n = tracker.get_trade_history_page(next, page, 7))
+    {
+        paged.insert(paged.end(), page, page + n);
+        next = page[n - 1].sequence + 1;
+    }
+    assert(paged.size() == all.size());
+    for (size_t i = 0; i < paged.size(); ++i)
+    {
+        assert(paged[i].sequence == all[i].sequence);
+    }
+
+    std::cout << "Trade sequence paging test passed!" << std::endl;
+}
+
+void test_position_aggregates()
+{
+    PositionLimits limits;
+    limits.max_daily_loss = price_from_dollars(1000.00);
+    limits.max_drawdown = price_from_dollars(1000.00);
+    PositionTracker tracker(limits);
+
+    tracker.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+    tracker.record_trade(2, price_from_dollars(20.00), 50, OrderSide::SELL, 2, 2);
+    assert(tracker.get_net_exposure() == price_from_dollars(10.00) * 100 - price_from_dollars(20.00) * 50);
+    assert(tracker.get_gross_exposure() == price_from_dollars(10.00) * 100 + price_from_dollars(20.00) * 50);
+
+    // Marking moves unrealized P&L and exposure by the delta only
+    tracker.update_unrealized_pnl(1, price_from_dollars(9.00), 3);
+    assert(tracker.get_total_unrealized_pnl() == -price_from_dollars(1.00) * 100);
+    assert(tracker.get_gross_exposure() == price_from_dollars(9.00) * 100 + price_from_dollars(20.00) * 50);
+    assert(tracker.check_risk_limits());
+
+    tracker.update_unrealized_pnl(1, price_from_dollars(-1.00), 4);
+    assert(!tracker.check_risk_limits());
+
+    // Totals stay equal to the per-position sums under concurrent writers
+    std::thread a([&]()
+                  { for (OrderId i = 0; i < 5000; ++i) tracker.record_trade(3, price_from_dollars(5.00) + i % 7, 3, (i & 1) ? OrderSide::SELL : OrderSide::BUY, i, i); });
+    std::thread b([&]()
+                  { for (OrderId i = 0; i < 5000; ++i) tracker.record_trade(4, price_from_dollars(8.00) - i % 5, 2, (i % 3) ? OrderSide::SELL : OrderSide::BUY, i, i); });
+    a.join();
+    b.join();
+
+    PnL realized = 0;
+    PnL unrealized = 0;
+    for (const auto &[symbol, position] : tracker.get_all_positions())
+    {
+        realized += position.realized_pnl;
+        unrealized += position.unrealized_pnl;
+    }
+    assert(tracker.get_total_realized_pnl() == realized);
+    assert(tracker.get_total_unrealized_pnl() == unrealized);
+
+    tracker.reset();
+    assert(tracker.get_total_pnl() == 0 && tracker.get_gross_exposure() == 0);
+
+    std::cout << "Position aggregates test passed!" << std::endl;
+}
+
+void test_pre_trade_risk_gate()
+{
+    RiskGateLimits limits;
+    limits.max_long_position = 1000;
+    limits.max_short_position = 1000;
+    limits.max_pending_quantity = 1500;
+    limits.max_order_notional = price_from_dollars(100000.00);
+    limits.max_price_deviation = price_from_dollars(1.00);
+    limits.max_orders_per_window = 3;
+    limits.rate_window = 1000;
+    PreTradeRiskGate gate(limits);
+
+    const Price px = price_from_dollars(50.00);
+    gate.update_bbo(1, price_from_dollars(49.99), price_from_dollars(50.01));
+
+    RiskCheck result = gate.check(1, px, 800, OrderSide::BUY, 0);
+    assert(result == RiskCheck::PASSED);
+    assert(gate.get_state(1).pending_buy == 800);
+
+    // Resting 800 plus 300 more would exceed the long limit if all filled
+    result = gate.check(1, px, 300, OrderSide::BUY, 1);
+    assert(result == RiskCheck::POSITION_LIMIT);
+    result = gate.check(1, px, 800, OrderSide::SELL, 2);
+    assert(result == RiskCheck::PENDING_LIMIT);
+    result = gate.check(1, price_from_dollars(52.00), 10, OrderSide::SELL, 3);
+    assert(result == RiskCheck::PRICE_BAND);
+    result = gate.check(1, px, 2500, OrderSide::SELL, 4);
+    assert(result == RiskCheck::POSITION_LIMIT);
+    result = gate.check(2, price_from_dollars(5000.00), 100, OrderSide::SELL, 5);
+    assert(result == RiskCheck::NOTIONAL_LIMIT);
+    result = gate.check(MAX_SYMBOLS, px, 1, OrderSide::BUY, 6);
+    assert(result == RiskCheck::INVALID_SYMBOL);
+
+    // Fills move pending into position; cancels release pending
+    gate.on_fill(1, OrderSide::BUY, 300);
+    assert(gate.get_state(1).position == 300 && gate.get_state(1).pending_buy == 500);
+    gate.on_cancel(1, OrderSide::BUY, 800);
+    assert(gate.get_state(1).pending_buy == 0);
+
+    // Rate: two more orders fit in the first window, then a new window opens
+    result = gate.check(1, px, 10, OrderSide::SELL, 10);
+    assert(result == RiskCheck::PASSED);
+    result = gate.check(1, px, 10, OrderSide::SELL, 20);
+    assert(result == RiskCheck::PASSED);
+    result = gate.check(1, px, 10, OrderSide::SELL, 30);
+    assert(result == RiskCheck::ORDER_RATE);
+    result = gate.check(1, px, 10, OrderSide::SELL, 1000);
+    assert(result == RiskCheck::PASSED);
+
+    assert(gate.get_stats().checks == 11 && gate.get_stats().rejected == 7);
+    (void)result;
+
+    std::cout << "Pre-trade risk gate test passed!" << std::endl;
+}
+
+void test_portfolio_var()
+{
+    std::cout << "Testing incremental portfolio VaR..." << std::endl;
+
+    PortfolioVaRConfig config;
+    config.capacity = 40;
+    PortfolioVaR var(config);
+    std::vector<Price> bids(MAX_SYMBOLS, 0), asks(MAX_SYMBOLS, 0);
+
+    // Symbols 1 and 2 always move together; 3 moves against them
+    for (int step = 0; step < 50; ++step)
+    {
+        Price move = (step % 3 == 0 ? 2 : -1) * 100;
+        for (SymbolId symbol : {1, 2, 3})
+        {
+            Price mid = price_from_dollars(50.00) + (symbol == 3 ? -move : move) * (step % 7);
+            bids[symbol] = mid - 1;
+            asks[symbol] = mid + 1;
+            var.add_symbol(symbol);
+        }
+        var.observe(bids.data(), asks.data());
+    }
+    assert(var.covariance(1, 1) > 0 && var.covariance(1, 2) == var.covariance(1, 1));
+    assert(var.covariance(1, 3) < 0);
+
+    // A long in 1 is hedged by a short in 2 and doubled by a long in 2
+    var.on_fill(1, OrderSide::BUY, 100);
+    PnL single = var.value_at_risk();
+    assert(single > 0);
+    assert(var.value_at_risk_after(2, -100) == 0);
+    assert(std::llabs(var.value_at_risk_after(2, 100) - 2 * single) <= 1);
+    var.on_fill(2, OrderSide::SELL, 100);
+    assert(var.value_at_risk() == 0);
+    var.set_position(2, 100);
+    assert(std::llabs(var.value_at_risk() - 2 * single) <= 1 && var.get_position(2) == 100);
+
+    // Fills and observations interleaved: incremental variance matches q'Cq
+    std::mt19937 gen(11);
+    for (SymbolId symbol = 1; symbol <= 40; ++symbol)
+    {
+        bids[symbol] = price_from_dollars(20.00 + symbol);
+        asks[symbol] = bids[symbol] + 2;
+    }
+    for (int round = 0; round < 200; ++round)
+    {
+        for (SymbolId symbol = 1; symbol <= 40; ++symbol)
+        {
+            Price move = static_cast<Price>(gen() % 41) - 20;
+            bids[symbol] += move;
+            asks[symbol] += move;
+        }
+        var.observe(bids.data(), asks.data());
+        for (int fill = 0; fill < 10; ++fill)
+        {
+            SymbolId symbol = static_cast<SymbolId>(1 + gen() % 40);
+            Quantity quantity = 1 + gen() % 50;
+            OrderSide side = (gen() & 1) ? OrderSide::BUY : OrderSide::SELL;
+            int64_t delta = side == OrderSide::BUY ? quantity : -static_cast<int64_t>(quantity);
+            PnL predicted = var.value_at_risk_after(symbol, delta);
+            var.on_fill(symbol, side, quantity);
+            assert(var.value_at_risk() == predicted);
+        }
+
+        double expected = 0;
+        for (SymbolId a = 1; a <= 40; ++a)
+        {
+            for (SymbolId b = 1; b <= 40; ++b)
+            {
+                expected += static_cast<double>(var.get_position(a)) * var.covariance(a, b) * static_cast<double>(var.get_position(b));
+            }
+        }
+        assert(std::abs(var.variance() - expected) <= 1e-9 * std::max(expected, 1.0));
+        assert(std::abs(var.full_variance() - expected) <= 1e-9 * std::max(expected, 1.0));
+    }
+
+    // The universe is bounded by capacity
+    bool added = var.add_symbol(41);
+    assert(var.symbol_count() == 40 && !added);
+    (void)added;
+    assert(var.get_stats().fills == 2000 + 2 && var.get_stats().observations == 250);
+
+    std::cout << "Portfolio VaR test passed!" << std::endl;
+}
+
+void test_mark_to_market()
+{
+    std::cout << "Testing vectorized mark-to-market..." << std::endl;
+
+    PositionLimits limits;
+    limits.max_drawdown = price_from_dollars(1000000.0);
+    PositionTracker scalar(limits);
+    PositionTracker vectorized(limits);
+    PositionTracker live(limits); // Marked from atomic arrays, as OrderBookManager keeps them
+
+    // 37 symbols so the pass covers full vectors and a scalar tail
+    constexpr SymbolId num_symbols = 37;
+    std::vector<Price> bids(MAX_SYMBOLS, 0);
+    std::vector<Price> asks(MAX_SYMBOLS, 0);
+    for (SymbolId symbol = 0; symbol < num_symbols; ++symbol)
+    {
+        for (PositionTracker *tracker : {&scalar, &vectorized, &live})
+        {
+            tracker->record_trade(symbol, price_from_dollars(50.0) + symbol, 100 + symbol, OrderSide::BUY, 1, 1);
+            if (symbol % 3 == 0)
+            {
+                tracker->record_trade(symbol, price_from_dollars(51.0), 300, OrderSide::SELL, 2, 2);
+            }
+        }
+        // Every fifth symbol has a one-sided book and keeps its last mark
+        if (symbol % 5 != 4)
+        {
+            bids[symbol] = price_from_dollars(49.0) + 7 * symbol;
+            asks[symbol] = bids[symbol] + 2 + symbol % 2;
+            scalar.update_unrealized_pnl(symbol, (bids[symbol] + asks[symbol]) / 2, 3);
+        }
+        else
+        {
+            bids[symbol] = price_from_dollars(49.0);
+        }
+    }
+
+    size_t updated = vectorized.mark_to_market(bids.data(), asks.data(), 3);
+    assert(updated == num_symbols - num_symbols / 5);
+    std::unique_ptr<std::atomic<Price>[]> live_bids = std::make_unique<std::atomic<Price>[]>(MAX_SYMBOLS);
+    std::unique_ptr<std::atomic<Price>[]> live_asks = std::make_unique<std::atomic<Price>[]>(MAX_SYMBOLS);
+    for (SymbolId symbol = 0; symbol < num_symbols; ++symbol)
+    {
+        live_bids[symbol].store(bids[symbol], std::memory_order_relaxed);
+        live_asks[symbol].store(asks[symbol], std::memory_order_relaxed);
+    }
+    updated = live.mark_to_market(live_bids.get(), live_asks.get(), 3);
+    assert(updated == num_symbols - num_symbols / 5);
+    assert(live.get_total_unrealized_pnl() == vectorized.get_total_unrealized_pnl());
+    for (SymbolId symbol = 0; symbol < num_symbols; ++symbol)
+    {
+        Position a, b;
+        assert(scalar.get_position(symbol, a) && vectorized.get_position(symbol, b));
+        assert(a.unrealized_pnl == b.unrealized_pnl);
+    }
+    assert(scalar.get_total_unrealized_pnl() == vectorized.get_total_unrealized_pnl());
+    assert(scalar.get_gross_exposure() == vectorized.get_gross_exposure());
+    assert(scalar.get_net_exposure() == vectorized.get_net_exposure());
+
+    // Unchanged marks write nothing; a moved mark rewrites just that symbol
+    updated = vectorized.mark_to_market(bids.data(), asks.data(), 4);
+    assert(updated == 0);
+    bids[10] -= 100;
+    asks[10] -= 100;
+    updated = vectorized.mark_to_market(bids.data(), asks.data(), 5);
+    assert(updated == 1);
+    (void)updated;
+    Position pos;
+    assert(vectorized.get_position(10, pos) && pos.last_update == 5);
+
+    std::cout << "Mark-to-market test passed!" << std::endl;
+}
+
+void test_equity_curve()
+{
+    std::cout << "Testing equity curve and drawdown..." << std::endl;
+
+    constexpr Timestamp second = 1000000000ull;
+    EquityCurve::Config config;
+    config.second_buckets = 4;
+    config.minute_buckets = 2;
+    EquityCurve curve(config);
+
+    // Peak 300 at t=1s, trough -200 at t=2.5s, partial recovery
+    curve.sample(100, 1 * second);
+    curve.sample(300, 1 * second + 500);
+    curve.sample(-200, 2 * second + second / 2);
+    curve.sample(50, 3 * second);
+    DrawdownStats stats = curve.get_drawdown();
+    assert(stats.equity == 50);
+    assert(stats.peak == 300 && stats.peak_time == 1 * second + 500);
+    assert(stats.drawdown == 250);
+    assert(stats.max_drawdown == 500 && stats.max_drawdown_time == 2 * second + second / 2);
+    assert(stats.samples == 4);
+
+    EquityBucket buckets[8];
+    assert(curve.copy_seconds(buckets, 8) == 3);
+    assert(buckets[0].start == 1 * second && buckets[0].open == 100 && buckets[0].high == 300 && buckets[0].close == 300);
+    assert(buckets[0].samples == 2 && buckets[0].max_drawdown == 0);
+    assert(buckets[1].low == -200 && buckets[1].max_drawdown == 500);
+    assert(curve.copy_minutes(buckets, 8) == 1);
+    assert(buckets[0].start == 0 && buckets[0].high == 300 && buckets[0].low == -200 && buckets[0].close == 50);
+
+    // Idle seconds get no bucket; the ring keeps the newest four
+    curve.sample(400, 10 * second);
+    curve.sample(350, 61 * second);
+    assert(curve.copy_seconds(buckets, 8) == 4);
+    assert(buckets[0].start == 2 * second && buckets[3].start == 61 * second);
+    assert(curve.copy_seconds(buckets, 2) == 2 && buckets[0].start == 10 * second);
+    assert(curve.copy_minutes(buckets, 8) == 2 && buckets[1].start == 60 * second);
+    assert(curve.get_drawdown().peak == 400 && curve.get_drawdown().max_drawdown == 500);
+
+    // A book that starts losing is in drawdown from the flat start
+    curve.reset();
+    assert(curve.copy_seconds(buckets, 8) == 0);
+    curve.sample(-75, 5 * second);
+    assert(curve.get_drawdown().peak == 0 && curve.get_drawdown().drawdown == 75);
+
+    // The tracker samples on every mark and checks drawdown from the peak
+    PositionLimits limits;
+    limits.max_daily_loss = price_from_dollars(1000.00);
+    limits.max_drawdown = price_from_dollars(300.00);
+    PositionTracker tracker(limits);
+    tracker.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+    tracker.update_unrealized_pnl(1, price_from_dollars(15.00), 2);
+    tracker.sample_equity(2);
+    assert(tracker.get_drawdown().peak == price_from_dollars(500.00));
+    assert(tracker.check_risk_limits());
+
+    // Still $100 up overall, but $400 off the peak
+    tracker.update_all_unrealized_pnl({{1, price_from_dollars(11.00)}}, 3 * second);
+    stats = tracker.get_drawdown();
+    assert(stats.equity == price_from_dollars(100.00) && stats.drawdown == price_from_dollars(400.00));
+    assert(!tracker.check_risk_limits());
+    assert(tracker.get_equity_curve().copy_seconds(buckets, 8) == 2);
+
+    tracker.reset();
+    assert(tracker.get_drawdown().samples == 0 && tracker.check_risk_limits());
+
+    std::cout << "Equity curve test passed!" << std::endl;
+}
+
+void test_mmap_position_tracker()
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "mm_test_positions.dat";
+    std::filesystem::remove(path);
+
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        tracker.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+        tracker.record_trade(2, price_from_dollars(20.00), 200, OrderSide::SELL, 2, 2);
+        tracker.record_trade(3, price_from_dollars(30.00), 300, OrderSide::BUY, 3, 3);
+
+        // Only slots written since the last flush are copied
+        size_t flushed = tracker.flush();
+        assert(flushed == 3);
+        flushed = tracker.flush();
+        assert(flushed == 0);
+        tracker.record_trade(2, price_from_dollars(20.00), 50, OrderSide::BUY, 4, 4);
+        flushed = tracker.flush();
+        assert(flushed == 1);
+        (void)flushed;
+    }
+
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        Position pos;
+        assert(tracker.get_position(2, pos) && pos.short_quantity == 150 && pos.long_quantity == 0);
+        assert(tracker.get_position(3, pos) && pos.long_quantity == 300);
+        assert(tracker.get_stats().total_symbols == 3);
+    }
+
+    // Background thread persists without explicit flushes; slots sit at SymbolId offsets
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(2));
+        tracker.record_trade(7, price_from_dollars(70.00), 700, OrderSide::BUY, 5, 5);
+
+        PositionFileView view(path.string());
+        Position on_disk;
+        for (int attempt = 0; attempt < 500 && on_disk.long_quantity != 700; ++attempt)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            view.get_position(7, on_disk);
+        }
+        assert(on_disk.symbol == 7 && on_disk.long_quantity == 700);
+    }
+
+    // Files from the old packed layout are rewritten into slots on load
+    std::filesystem::remove(path);
+    {
+        Position packed[2];
+        packed[0].symbol = 5;
+        packed[0].long_quantity = 55;
+        packed[1].symbol = 9;
+        packed[1].short_quantity = 99;
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(packed), sizeof(packed));
+    }
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        Position pos;
+        assert(tracker.get_position(5, pos) && pos.long_quantity == 55);
+        assert(tracker.get_position(9, pos) && pos.short_quantity == 99);
+        assert(!tracker.get_position(0, pos));
+    }
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        assert(tracker.get_stats().total_symbols == 2);
+    }
+    std::filesystem::remove(path);
+
+    std::cout << "Memory-mapped position tracker test passed!" << std::endl;
+}
+
+void test_position_file_format()
+{
+    std::cout << "Testing versioned position file format..." << std::endl;
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "mm_test_position_format.dat";
+    std::filesystem::remove(path);
+
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        tracker.record_trade(4, price_from_dollars(40.00), 400, OrderSide::BUY, 1, 1);
+        tracker.record_trade(9999, price_from_dollars(99.00), 99, OrderSide::SELL, 2, 2);
+    }
+    assert(std::filesystem::file_size(path) == POSITION_FILE_HEADER_SIZE + MAX_SYMBOLS * sizeof(PositionRecord));
+
+    // The view reads records in place and needs no tracker
+    {
+        PositionFileView view(path.string());
+        assert(view.record_count() == MAX_SYMBOLS);
+        Position pos;
+        assert(view.get_position(4, pos) && pos.long_quantity == 400 && pos.avg_long_price == price_from_dollars(40.00));
+        assert(view.get_position(9999, pos) && pos.short_quantity == 99);
+        assert(!view.get_position(5, pos) && view.record(5) == nullptr);
+    }
+
+    auto patch = [&](size_t offset, const void *bytes, size_t length)
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(length));
+    };
+    auto rejected = [&]()
+    {
+        try
+        {
+            MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        }
+        catch (const std::runtime_error &)
+        {
+            return true;
+        }
+        return false;
+    };
+
+    // A flipped bit in a record fails its checksum
+    size_t record_offset = POSITION_FILE_HEADER_SIZE + 4 * sizeof(PositionRecord);
+    PositionRecord record;
+    {
+        std::ifstream file(path, std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(record_offset));
+        file.read(reinterpret_cast<char *>(&record), sizeof(record));
+    }
+    PositionRecord corrupt = record;
+    corrupt.long_quantity ^= 1;
+    patch(record_offset, &corrupt, sizeof(corrupt));
+    assert(rejected());
+    patch(record_offset, &record, sizeof(record));
+    assert(!rejected());
+
+    // A newer schema is refused rather than misread, even with a valid header checksum
+    PositionFileHeader header = make_position_file_header(MAX_SYMBOLS);
+    header.version = POSITION_FILE_VERSION + 1;
+    header.crc = crc32c(&header, offsetof(PositionFileHeader, crc));
+    patch(0, &header, sizeof(header));
+    assert(rejected());
+
+    header = make_position_file_header(MAX_SYMBOLS);
+    header.byte_order = __builtin_bswap32(POSITION_FILE_BYTE_ORDER);
+    header.crc = crc32c(&header, offsetof(PositionFileHeader, crc));
+    patch(0, &header, sizeof(header));
+    assert(rejected());
+
+    header = make_position_file_header(MAX_SYMBOLS);
+    patch(0, &header, sizeof(header));
+    {
+        MMapPositionTracker tracker(path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        Position pos;
+        assert(tracker.get_position(4, pos) && pos.long_quantity == 400);
+
+        // Restored positions get their lot on first use
+        Lot lots[4];
+        assert(tracker.get_open_lots(4, lots, 4) == 1 && lots[0].quantity == 400 && lots[0].price == price_from_dollars(40.00));
+        tracker.record_trade(4, price_from_dollars(41.00), 100, OrderSide::SELL, 3, 3);
+        assert(tracker.get_position(4, pos) && pos.long_quantity == 300 && pos.realized_pnl == price_from_dollars(1.00) * 100);
+        assert(tracker.get_open_lots(4, lots, 4) == 1 && lots[0].quantity == 300);
+    }
+
+    // Anything that is neither a position file nor a bare Position array is refused
+    std::filesystem::remove(path);
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not positions";
+    }
+    assert(rejected());
+    std::filesystem::remove(path);
+
+    std::cout << "Position file format test passed!" << std::endl;
+}
+
+void test_shared_position_view()
+{
+    std::cout << "Testing shared-memory position view..." << std::endl;
+
+    std::string name = "/mm_test_positions_" + std::to_string(getpid());
+    PositionTracker tracker;
+    tracker.record_trade(3, price_from_dollars(30.00), 300, OrderSide::BUY, 1, 1);
+    tracker.record_trade(8, price_from_dollars(80.00), 80, OrderSide::SELL, 2, 2);
+
+    {
+        SharedPositionPublisher publisher(tracker, name, std::chrono::microseconds(0));
+        SharedPositionReader reader(name);
+        assert(reader.publisher_pid() == getpid());
+
+        Position pos;
+        assert(reader.get_position(3, pos) && pos.long_quantity == 300 && pos.avg_long_price == price_from_dollars(30.00));
+        assert(reader.get_position(8, pos) && pos.short_quantity == 80);
+        assert(!reader.get_position(4, pos));
+
+        SharedTotals totals;
+        assert(reader.get_totals(totals) && totals.trades == 2 && totals.active_symbols == 2);
+        assert(totals.gross_exposure == tracker.get_gross_exposure());
+
+        // Only changed positions are copied; an idle cycle leaves the version alone
+        uint64_t version = reader.version();
+        size_t published = publisher.publish();
+        assert(published == 0 && reader.version() == version);
+        tracker.record_trade(3, price_from_dollars(31.00), 100, OrderSide::SELL, 3, 3);
+        published = publisher.publish();
+        assert(published == 1 && reader.version() > version);
+        (void)published;
+        assert(reader.get_position(3, pos) && pos.long_quantity == 200 && pos.realized_pnl == price_from_dollars(1.00) * 100);
+        assert(reader.get_totals(totals) && totals.realized_pnl == price_from_dollars(1.00) * 100);
+
+        // reset() drops symbols without reporting them; the publisher notices
+        tracker.reset();
+        tracker.record_trade(5, price_from_dollars(5.00), 5, OrderSide::BUY, 4, 4);
+        publisher.publish();
+        std::vector<Position> positions;
+        assert(reader.get_positions(positions) == 1 && positions[0].symbol == 5);
+    }
+
+    // Background publishing while a writer trades: every copy is one whole write
+    {
+        SharedPositionPublisher publisher(tracker, name, std::chrono::microseconds(100));
+        SharedPositionReader reader(name);
+        std::atomic<bool> done{false};
+        std::thread writer([&]()
+                           {
+            for (OrderId i = 0; i < 20000; ++i)
+            {
+                tracker.record_trade(6, price_from_dollars(60.00), 1, OrderSide::BUY, i, i);
+            }
+            done.store(true); });
+
+        Quantity last = 0;
+        while (!done.load())
+        {
+            Position pos;
+            if (reader.get_position(6, pos))
+            {
+                assert(pos.symbol == 6 && pos.avg_long_price == price_from_dollars(60.00));
+                assert(pos.long_quantity >= last);
+                last = pos.long_quantity;
+            }
+        }
+        writer.join();
+        publisher.publish();
+        Position pos;
+        assert(reader.get_position(6, pos) && pos.long_quantity == 20000);
+    }
+
+    // The segment goes away with the publisher
+    bool missing = false;
+    try
+    {
+        SharedPositionReader reader(name);
+    }
+    catch (const std::runtime_error &)
+    {
+        missing = true;
+    }
+    assert(missing);
+
+    std::cout << "Shared-memory position view test passed!" << std::endl;
+}
+
+void test_fill_wal_recovery()
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::filesystem::path wal_path = dir / "mm_test_fills.wal";
+    std::filesystem::path snapshot_path = dir / "mm_test_wal_positions.dat";
+    std::filesystem::path stale_path = dir / "mm_test_wal_positions_stale.dat";
+    std::filesystem::remove(wal_path);
+    std::filesystem::remove(snapshot_path);
+    std::filesystem::remove(stale_path);
+
+    FillWal::Config config;
+    config.group_commit_window = std::chrono::microseconds(0);
+
+    Position expected[4];
+    {
+        FillWal wal(wal_path.string(), config);
+        MMapPositionTracker tracker(snapshot_path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        tracker.attach_wal(&wal);
+
+        tracker.record_trade(1, price_from_dollars(10.00), 100, OrderSide::BUY, 1, 1);
+        tracker.record_trade(2, price_from_dollars(20.00), 200, OrderSide::SELL, 2, 2);
+        tracker.flush();
+        std::filesystem::copy_file(snapshot_path, stale_path);
+
+        // These fills are only in the journal as far as the stale snapshot knows
+        tracker.record_trade(1, price_from_dollars(11.00), 50, OrderSide::BUY, 3, 3);
+        tracker.record_trade(2, price_from_dollars(19.00), 200, OrderSide::BUY, 4, 4);
+        tracker.record_trade(3, price_from_dollars(30.00), 30, OrderSide::SELL, 5, 5);
+        wal.wait_durable(5);
+        assert(wal.durable_sequence() == 5);
+
+        for (SymbolId symbol = 1; symbol <= 3; ++symbol)
+        {
+            assert(tracker.get_position(symbol, expected[symbol]));
+        }
+        assert(expected[3].fill_sequence == 5);
+    }
+
+    // A crash mid-write leaves a torn record behind
+    {
+        std::ofstream file(wal_path, std::ios::binary | std::ios::app);
+        file.write("torn fill record....", 20);
+    }
+
+    {
+        FillWal wal(wal_path.string(), config);
+        assert(wal.recovered_sequence() == 5);
+        assert(wal.get_stats().truncated_bytes == 20);
+
+        MMapPositionTracker tracker(stale_path.string(), PositionLimits(), std::chrono::milliseconds(0));
+        size_t replayed = tracker.recover(wal);
+        assert(replayed == 3);
+        replayed = tracker.recover(wal);
+        assert(replayed == 0);
+        (void)replayed;
+        for (SymbolId symbol = 1; symbol <= 3; ++symbol)
+        {
+            Position pos;
+            assert(tracker.get_position(symbol, pos));
+            assert(pos.long_quantity == expected[symbol].long_quantity);
+            assert(pos.short_quantity == expected[symbol].short_quantity);
+            assert(pos.realized_pnl == expected[symbol].realized_pnl);
+            assert(pos.fill_sequence == expected[symbol].fill_sequence);
+        }
+
+        // New fills continue the sequence
+        tracker.attach_wal(&wal);
+        tracker.record_trade(3, price_from_dollars(31.00), 10, OrderSide::BUY, 6, 6);
+        wal.wait_durable(6);
+        Position pos;
+        assert(tracker.get_position(3, pos) && pos.fill_sequence == 6);
+    }
+
+    // With no snapshot at all the whole journal is replayed
+    {
+        FillWal wal(wal_path.string(), config);
+        PositionTracker tracker;
+        size_t replayed = tracker.recover(wal);
+        assert(replayed == 6);
+        (void)replayed;
+        Position pos;
+        assert(tracker.get_position(3, pos) && pos.short_quantity == 20 && pos.long_quantity == 0);
+    }
+
+    std::filesystem::remove(wal_path);
+    std::filesystem::remove(snapshot_path);
+    std::filesystem::remove(stale_path);
+
+    std::cout << "Fill write-ahead journal recovery test passed!" << std::endl;
+}
+
 int main()
 {
     try
     {
         test_position_tracker_basic();
         test_position_tracker_pnl();
+        test_lot_matching();
+        test_position_tracker_concurrent_reads();
+        test_position_tracker_snapshots();
+        test_position_shards();
+        test_trade_journal();
+        test_trade_sequence_pages();
+        test_position_aggregates();
+        test_pre_trade_risk_gate();
+        test_portfolio_var();
+        test_mark_to_market();
+        test_equity_curve();
+        test_mmap_position_tracker();
+        test_position_file_format();
+        test_shared_position_view();
+        test_fill_wal_recovery();
         std::cout << "All position tracker tests passed!" << std::endl;
         return 0;
     }
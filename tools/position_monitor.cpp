@@ -0,0 +1,114 @@
+#include "position_shm.hpp"
+#include "position_tracker.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace mm;
+
+namespace
+{
+    void usage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--name /segment] [--watch milliseconds] [--all]" << std::endl
+                  << "  Print positions and P&L published by a running engine." << std::endl
+                  << "  --watch  reprint whenever the segment changes, polling at this period" << std::endl
+                  << "  --all    include flat positions" << std::endl;
+    }
+
+    void print_snapshot(const SharedPositionReader &reader, std::vector<Position> &positions, bool show_flat)
+    {
+        SharedTotals totals{};
+        reader.get_totals(totals);
+        uint64_t now_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                    std::chrono::system_clock::now().time_since_epoch())
+                                                    .count());
+        double age_ms = static_cast<double>(now_ns - reader.heartbeat_ns()) / 1e6;
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "publisher pid " << reader.publisher_pid() << ", version " << reader.version()
+                  << ", heartbeat " << age_ms << " ms ago" << std::endl
+                  << "P&L " << price_to_dollars(totals.total_pnl)
+                  << " (realized " << price_to_dollars(totals.realized_pnl)
+                  << ", unrealized " << price_to_dollars(totals.unrealized_pnl) << ")"
+                  << "  drawdown " << price_to_dollars(totals.drawdown)
+                  << " (max " << price_to_dollars(totals.max_drawdown) << ")" << std::endl
+                  << "exposure gross " << price_to_dollars(totals.gross_exposure)
+                  << " net " << price_to_dollars(totals.net_exposure)
+                  << "  trades " << totals.trades << "  symbols " << totals.active_symbols << std::endl;
+
+        reader.get_positions(positions);
+        std::cout << std::setw(8) << "symbol" << std::setw(12) << "net" << std::setw(14) << "avg price"
+                  << std::setw(16) << "realized" << std::setw(16) << "unrealized" << std::endl;
+        for (const Position &position : positions)
+        {
+            if (position.is_flat() && !show_flat)
+            {
+                continue;
+            }
+            Price average = position.is_short() ? position.avg_short_price : position.avg_long_price;
+            std::cout << std::setw(8) << position.symbol << std::setw(12) << position.get_net_position()
+                      << std::setw(14) << price_to_dollars(average)
+                      << std::setw(16) << price_to_dollars(position.realized_pnl)
+                      << std::setw(16) << price_to_dollars(position.unrealized_pnl) << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string name = DEFAULT_POSITION_SHM_NAME;
+    int watch_ms = 0;
+    bool show_flat = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--watch") == 0 && i + 1 < argc)
+        {
+            watch_ms = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--all") == 0)
+        {
+            show_flat = true;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    try
+    {
+        SharedPositionReader reader(name);
+        std::vector<Position> positions;
+        print_snapshot(reader, positions, show_flat);
+
+        uint64_t seen = reader.version();
+        while (watch_ms > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(watch_ms));
+            uint64_t version = reader.version();
+            if (version != seen)
+            {
+                seen = version;
+                std::cout << std::endl;
+                print_snapshot(reader, positions, show_flat);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}